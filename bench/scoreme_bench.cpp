@@ -0,0 +1,606 @@
+// scoreme_bench: micro- and macro-benchmarks for the roster hot paths.
+//
+//   scoreme_bench [--sizes 1000,100000,1000000] [--iterations 3] [--filter text]
+//                 [--workdir dir] [--out results.json]
+//   scoreme_bench --gate [--baseline perf_baseline.json] [--tolerance 0.25]
+//                 [--memory-tolerance 0.25] [--update-baseline perf_baseline.json]
+//
+// Results are printed as one JSON document (to stdout or --out) with
+// throughput, latency percentiles and peak RSS per benchmark; progress goes
+// to stderr. Table rendering and workbook messages are sent to /dev/null
+// while they are being measured.
+//
+// --gate runs a fixed workload over the ExcelUtils, GradeUtil and Admin entry
+// points and compares it with a stored baseline (the perf_gate CTest test).
+// Throughput (of the fastest of several passes) is scaled by a CPU calibration
+// loop so a baseline recorded on one machine stays usable on another; the exit
+// code is 1 on a regression or when a gated metric is missing from the baseline.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Admin.hpp"
+#include "CredentialIndex.hpp"
+#include "ExcelUtil.hpp"
+#include "GradeUtil.hpp"
+#include "JsonUtil.hpp"
+#include "MemoryStats.hpp"
+#include "MenuUtils.hpp"
+#include "SampleDataGenerator.hpp"
+#include "ScoreIndex.hpp"
+#include "SearchIndex.hpp"
+#include "Student.hpp"
+#include "StudentView.hpp"
+#include "TableRenderer.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+namespace {
+    struct Options {
+        vector<size_t> sizes = {1000, 100000, 1000000};
+        int iterations = 3;
+        string filter;
+        string workdir = (filesystem::temp_directory_path() / "scoreme_bench").string();
+        string out;
+
+        // Regression gate
+        bool gate = false;
+        string baseline;
+        string updateBaseline;
+        double tolerance = 0.25;          // allowed throughput drop
+        double memoryTolerance = 0.25;    // allowed peak RSS growth
+    };
+
+    const size_t GATE_ROWS = 20000;
+    const int GATE_ITERATIONS = 5;
+    const long GATE_MEMORY_SLACK_KB = 2048;   // RSS noise below this is never a regression
+
+    struct Result {
+        string name;
+        size_t rows = 0;
+        size_t operations = 0;            // timed calls
+        size_t itemsPerOperation = 0;     // rows touched per call, for throughput
+        double totalSeconds = 0.0;
+        vector<double> latenciesMicros;
+        long peakRssKb = 0;
+
+        double rowsPerSecond() const {
+            return totalSeconds > 0 ? static_cast<double>(operations * itemsPerOperation) / totalSeconds : 0.0;
+        }
+
+        // Throughput of the fastest call; the gate uses it because it shrugs off scheduler noise
+        double bestRowsPerSecond() const {
+            auto fastest = min_element(latenciesMicros.begin(), latenciesMicros.end());
+            return fastest != latenciesMicros.end() && *fastest > 0 ? itemsPerOperation * 1e6 / *fastest : 0.0;
+        }
+    };
+
+    // Sends stdout to /dev/null for the lifetime of the object
+    class SilencedStdout {
+    public:
+        SilencedStdout() {
+            cout.flush();
+            fflush(stdout);
+#ifndef _WIN32
+            saved = dup(STDOUT_FILENO);
+            int devNull = open("/dev/null", O_WRONLY);
+            if (devNull >= 0) {
+                dup2(devNull, STDOUT_FILENO);
+                close(devNull);
+            }
+#endif
+        }
+
+        ~SilencedStdout() {
+            cout.flush();
+            fflush(stdout);
+#ifndef _WIN32
+            if (saved >= 0) {
+                dup2(saved, STDOUT_FILENO);
+                close(saved);
+            }
+#endif
+        }
+
+    private:
+        int saved = -1;
+    };
+
+    double percentile(vector<double>& sorted, double fraction) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+        return sorted[min(index, sorted.size() - 1)];
+    }
+
+    class BenchSuite {
+    public:
+        explicit BenchSuite(const Options& options) : options(options) {}
+
+        bool selected(const string& name) const {
+            return options.filter.empty() || name.find(options.filter) != string::npos;
+        }
+
+        // Times `operations` calls of work(i); each call touches itemsPerOperation rows
+        void measure(const string& name, size_t rows, size_t operations, size_t itemsPerOperation,
+                     const function<void(size_t)>& work) {
+            if (!selected(name)) {
+                return;
+            }
+            cerr << "  " << name << " (" << rows << " rows)..." << flush;
+
+            Result result;
+            result.name = name;
+            result.rows = rows;
+            result.operations = operations;
+            result.itemsPerOperation = itemsPerOperation;
+            result.latenciesMicros.reserve(operations);
+
+            MemoryStats::resetPeakResident();
+            auto suiteStart = Clock::now();
+            for (size_t i = 0; i < operations; ++i) {
+                auto start = Clock::now();
+                work(i);
+                chrono::duration<double, micro> elapsed = Clock::now() - start;
+                result.latenciesMicros.push_back(elapsed.count());
+            }
+            result.totalSeconds = chrono::duration<double>(Clock::now() - suiteStart).count();
+            result.peakRssKb = MemoryStats::peakResidentKb();
+
+            cerr << " " << fixed << setprecision(3) << result.totalSeconds << "s" << endl;
+            results.push_back(std::move(result));
+        }
+
+        void runSize(size_t rows) {
+            cerr << "Roster of " << rows << " students" << endl;
+            SampleDataGenerator::Options generatorOptions;
+            generatorOptions.count = rows;
+            generatorOptions.withCredentials = true;
+            vector<Student> students = SampleDataGenerator::generate(generatorOptions);
+            int macroIterations = rows >= 1000000 ? 1 : options.iterations;
+            size_t lookups = 1000;
+
+            // Grading: one timed call per student
+            measure("grading.updateAllGrades", rows, rows, 1, [&](size_t i) {
+                students[i].updateAllGrades();
+            });
+
+            // Workbook I/O
+            filesystem::create_directories(options.workdir);
+            string rosterFile = (filesystem::path(options.workdir) / ("roster_" + to_string(rows) + ".xlsx")).string();
+            string reportFile = (filesystem::path(options.workdir) / ("report_" + to_string(rows) + ".xlsx")).string();
+
+            measure("io.writeExcel", rows, macroIterations, rows, [&](size_t) {
+                SilencedStdout quiet;
+                ExcelUtils::writeExcel(rosterFile, students);
+            });
+            measure("io.writeExcelXlnt", rows, macroIterations, rows, [&](size_t) {
+                SilencedStdout quiet;
+                ExcelUtils::writeExcelWithXlnt(rosterFile, students);
+            });
+            measure("io.readExcelToVector", rows, macroIterations, rows, [&](size_t) {
+                SilencedStdout quiet;
+                vector<Student> loaded = ExcelUtils::readExcelToVector(rosterFile);
+                if (loaded.size() != rows) {
+                    cerr << " (read back " << loaded.size() << " rows)";
+                }
+            });
+            measure("io.exportGradeReport", rows, macroIterations, rows, [&](size_t) {
+                SilencedStdout quiet;
+                ExcelUtils::exportGradeReport(reportFile, students);
+            });
+            filesystem::remove(rosterFile);
+            filesystem::remove(reportFile);
+
+            // Index builds, then the lookups the admin menus run
+            CredentialIndex credentials;
+            SearchIndex search;
+            ScoreIndex scores;
+            measure("lookup.buildIndexes", rows, 1, rows, [&](size_t) {
+                credentials.rebuild(students);
+                search.rebuild(students);
+                scores.rebuild(students);
+            });
+
+            mt19937_64 rng(7);
+            vector<size_t> targets(lookups);
+            for (auto& target : targets) {
+                target = rng() % rows;
+            }
+
+            measure("lookup.linearScanById", rows, lookups, 1, [&](size_t i) {
+                const string& id = students[targets[i]].getStudentId();
+                auto it = find_if(students.begin(), students.end(),
+                                  [&](const Student& s) { return s.getStudentId() == id; });
+                if (it == students.end()) cerr << "!";
+            });
+            measure("lookup.authenticate", rows, lookups, 1, [&](size_t i) {
+                const Student& s = students[targets[i]];
+                if (!credentials.authenticate(students, s.getUsername(), s.getPassword())) cerr << "!";
+            });
+            measure("lookup.searchExactId", rows, lookups, 1, [&](size_t i) {
+                search.search(students[targets[i]].getStudentId(), 10);
+            });
+            measure("lookup.searchFuzzyName", rows, lookups, 1, [&](size_t i) {
+                // Drop one letter from the surname to force the fuzzy path
+                string name = students[targets[i]].getName();
+                name.erase(name.size() - 2, 1);
+                search.search(name, 10);
+            });
+            measure("lookup.scoreRange", rows, lookups, 1, [&](size_t i) {
+                double low = 40.0 + static_cast<double>(i % 50);
+                scores.range(students, ScoreIndex::AVERAGE, low, low + 1.0);
+            });
+            measure("lookup.failing", rows, lookups, 1, [&](size_t) {
+                scores.failing(students);
+            });
+
+            // Rendering: the first page as the menus show it, and the whole roster
+            size_t pageRows = min(rows, MenuUtils::PAGE_SIZE);
+            vector<uint32_t> page(pageRows);
+            for (size_t i = 0; i < pageRows; ++i) {
+                page[i] = static_cast<uint32_t>(i);
+            }
+            measure("render.displayTablePage", rows, 200, pageRows, [&](size_t) {
+                SilencedStdout quiet;
+                MenuUtils::displayTable(StudentView(students, page.data(), page.data() + page.size()));
+            });
+            measure("render.fullRoster", rows, macroIterations, rows, [&](size_t) {
+                SilencedStdout quiet;
+                StudentView all(students);
+                TableRenderer::renderStudentRows(all, 0, all.size(), {});
+            });
+        }
+
+        // The fixed perf_gate workload; keep it stable so baselines stay comparable
+        void runGate() {
+            cerr << "Perf gate: roster of " << GATE_ROWS << " students" << endl;
+            calibrationOpsPerSecond = calibrate();
+
+            SampleDataGenerator::Options generatorOptions;
+            generatorOptions.count = GATE_ROWS;
+            generatorOptions.withCredentials = true;
+            vector<Student> students = SampleDataGenerator::generate(generatorOptions);
+
+            // Whole-roster passes rather than per-row calls, so timer overhead stays out of the numbers
+            measure("grading.updateAllGrades", GATE_ROWS, GATE_ITERATIONS, GATE_ROWS, [&](size_t) {
+                for (auto& student : students) {
+                    student.updateAllGrades();
+                }
+            });
+            measure("grading.gradeUtil", GATE_ROWS, GATE_ITERATIONS, GATE_ROWS, [&](size_t) {
+                for (const auto& student : students) {
+                    double average = GradeUtil::calculateAverage(student.getSubjectScores());
+                    if (GradeUtil::assignLetterGrade(average).empty() || GradeUtil::assignRemark(average).empty()) cerr << "!";
+                }
+            });
+
+            filesystem::create_directories(options.workdir);
+            string rosterFile = (filesystem::path(options.workdir) / "gate_roster.xlsx").string();
+            string csvFile = (filesystem::path(options.workdir) / "gate_roster.csv").string();
+            string reportFile = (filesystem::path(options.workdir) / "gate_report.xlsx").string();
+
+            measure("io.writeCsv", GATE_ROWS, GATE_ITERATIONS, GATE_ROWS, [&](size_t) {
+                ExcelUtils::writeCsv(csvFile, students);
+            });
+            Admin admin;
+            mt19937_64 rng(7);
+            measure("admin.findStudentById", GATE_ROWS, GATE_ITERATIONS, 200, [&](size_t) {
+                for (int lookup = 0; lookup < 200; ++lookup) {
+                    const string& id = students[rng() % GATE_ROWS].getStudentId();
+                    if (!admin.findStudentById(students, id)) cerr << "!";
+                }
+            });
+
+            // Workbook paths last: xlnt's allocations would otherwise inflate the peaks above
+            measure("io.writeExcel", GATE_ROWS, GATE_ITERATIONS, GATE_ROWS, [&](size_t) {
+                SilencedStdout quiet;
+                ExcelUtils::writeExcel(rosterFile, students);
+            });
+            measure("io.readExcelToVector", GATE_ROWS, GATE_ITERATIONS, GATE_ROWS, [&](size_t) {
+                SilencedStdout quiet;
+                ExcelUtils::readExcelToVector(rosterFile);
+            });
+
+            measure("admin.exportData", GATE_ROWS, GATE_ITERATIONS, GATE_ROWS, [&](size_t) {
+                SilencedStdout quiet;
+                admin.exportData(students, reportFile);
+            });
+            measure("admin.importExcelData", GATE_ROWS, GATE_ITERATIONS, GATE_ROWS, [&](size_t) {
+                SilencedStdout quiet;
+                vector<Student> imported;
+                admin.importExcelData(imported, rosterFile);
+            });
+
+            filesystem::remove(rosterFile);
+            filesystem::remove(csvFile);
+            filesystem::remove(reportFile);
+        }
+
+        // Flat JSON: calibration plus throughput and peak RSS per benchmark
+        void writeBaseline(ostream& out) const {
+            out << fixed << setprecision(1);
+            out << "{\n  \"suite\": \"scoreme_perf_gate\",\n"
+                << "  \"rows\": " << GATE_ROWS << ",\n"
+                << "  \"calibration.ops_per_second\": " << calibrationOpsPerSecond;
+            for (const auto& result : results) {
+                out << ",\n  " << JsonUtil::quote(result.name + ".rows_per_second") << ": " << result.bestRowsPerSecond()
+                    << ",\n  " << JsonUtil::quote(result.name + ".peak_rss_kb") << ": " << result.peakRssKb;
+            }
+            out << "\n}\n";
+        }
+
+        // Prints one line per metric and returns the number of regressions
+        int compareWithBaseline(const map<string, string>& baseline, ostream& out) const {
+            auto number = [&](const string& key) {
+                auto it = baseline.find(key);
+                return it == baseline.end() ? -1.0 : stod(it->second);
+            };
+
+            // Scale expected throughput by how fast this machine runs the calibration loop
+            double baselineCalibration = number("calibration.ops_per_second");
+            double speedup = (baselineCalibration > 0 && calibrationOpsPerSecond > 0) ?
+                             calibrationOpsPerSecond / baselineCalibration : 1.0;
+            out << fixed << setprecision(2)
+                << "Machine speed vs baseline: x" << speedup
+                << " (throughput tolerance " << options.tolerance * 100 << "%, memory tolerance "
+                << options.memoryTolerance * 100 << "%)" << endl;
+            out << left << setw(28) << "benchmark" << setw(16) << "metric" << right
+                << setw(14) << "expected" << setw(14) << "actual" << setw(10) << "change" << "  status" << endl;
+
+            int regressions = 0;
+            auto line = [&](const string& name, const string& metric, double expected, double actual, bool regressed) {
+                double change = expected > 0 ? (actual - expected) / expected * 100.0 : 0.0;
+                out << left << setw(28) << name << setw(16) << metric << right << setprecision(0)
+                    << setw(14) << expected << setw(14) << actual << setprecision(1)
+                    << setw(9) << showpos << change << noshowpos << "%  "
+                    << (regressed ? "REGRESSION" : "ok") << endl;
+                regressions += regressed ? 1 : 0;
+            };
+
+            // A metric the baseline lacks is not gated at all, so it fails until the baseline is refreshed
+            auto missing = [&](const string& name, const string& metric) {
+                out << left << setw(28) << name << setw(16) << metric << right
+                    << setw(38) << "not in baseline" << "  MISSING" << endl;
+                ++regressions;
+            };
+
+            for (const auto& result : results) {
+                double throughput = number(result.name + ".rows_per_second");
+                double memory = number(result.name + ".peak_rss_kb");
+                if (throughput < 0) {
+                    missing(result.name, "rows/s");
+                } else {
+                    double expected = throughput * speedup;
+                    line(result.name, "rows/s", expected, result.bestRowsPerSecond(),
+                         result.bestRowsPerSecond() < expected * (1.0 - options.tolerance));
+                }
+                if (memory < 0) {
+                    missing(result.name, "peak RSS KiB");
+                } else {
+                    double actual = static_cast<double>(result.peakRssKb);
+                    line(result.name, "peak RSS KiB", memory, actual,
+                         actual > memory * (1.0 + options.memoryTolerance) && actual - memory > GATE_MEMORY_SLACK_KB);
+                }
+            }
+            return regressions;
+        }
+
+        void writeJson(ostream& out) const {
+            out << fixed << setprecision(3);
+            out << "{\n  \"suite\": \"scoreme_bench\",\n"
+                << "  \"timestamp\": " << chrono::duration_cast<chrono::seconds>(
+                       chrono::system_clock::now().time_since_epoch()).count() << ",\n"
+                << "  \"compiler\": " << JsonUtil::quote(compilerName()) << ",\n"
+#ifdef NDEBUG
+                << "  \"assertions\": false,\n"
+#else
+                << "  \"assertions\": true,\n"
+#endif
+                << "  \"hardware_threads\": " << thread::hardware_concurrency() << ",\n"
+                << "  \"results\": [";
+
+            for (size_t r = 0; r < results.size(); ++r) {
+                Result result = results[r];
+                vector<double>& latencies = result.latenciesMicros;
+                sort(latencies.begin(), latencies.end());
+                double sum = 0.0;
+                for (double latency : latencies) {
+                    sum += latency;
+                }
+
+                out << (r > 0 ? ",\n" : "\n")
+                    << "    {\"name\": " << JsonUtil::quote(result.name)
+                    << ", \"rows\": " << result.rows
+                    << ", \"operations\": " << result.operations
+                    << ", \"total_seconds\": " << result.totalSeconds
+                    << ", \"rows_per_second\": " << result.rowsPerSecond()
+                    << ", \"ops_per_second\": " << (result.totalSeconds > 0 ? result.operations / result.totalSeconds : 0.0)
+                    << ", \"latency_us\": {\"mean\": " << (latencies.empty() ? 0.0 : sum / latencies.size())
+                    << ", \"p50\": " << percentile(latencies, 0.50)
+                    << ", \"p90\": " << percentile(latencies, 0.90)
+                    << ", \"p99\": " << percentile(latencies, 0.99)
+                    << ", \"max\": " << (latencies.empty() ? 0.0 : latencies.back()) << "}"
+                    << ", \"peak_rss_kb\": " << result.peakRssKb << "}";
+            }
+            out << "\n  ]\n}\n";
+        }
+
+    private:
+        const Options& options;
+        vector<Result> results;
+        double calibrationOpsPerSecond = 0.0;
+
+        // Fixed CPU-bound kernel (sort + hash), best of three runs
+        static double calibrate() {
+            const size_t count = 200000;
+            double best = 0.0;
+            for (int run = 0; run < 3; ++run) {
+                mt19937_64 rng(42);
+                vector<uint64_t> values(count);
+                for (auto& value : values) {
+                    value = rng();
+                }
+                auto start = Clock::now();
+                sort(values.begin(), values.end());
+                uint64_t hash = 0;
+                for (uint64_t value : values) {
+                    hash = (hash ^ value) * 0x100000001b3ULL;
+                }
+                double seconds = chrono::duration<double>(Clock::now() - start).count();
+                if (hash == 1) cerr << "!";
+                best = max(best, seconds > 0 ? count / seconds : 0.0);
+            }
+            return best;
+        }
+
+        static string compilerName() {
+#if defined(__clang__)
+            return "clang " __clang_version__;
+#elif defined(__GNUC__)
+            return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+            return "msvc " + to_string(_MSC_VER);
+#else
+            return "unknown";
+#endif
+        }
+    };
+
+    bool parseOptions(int argc, char* argv[], Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            string arg = argv[i];
+            auto value = [&]() -> string {
+                if (i + 1 >= argc) {
+                    throw invalid_argument("missing value for " + arg);
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--sizes") {
+                options.sizes.clear();
+                stringstream list(value());
+                string item;
+                while (getline(list, item, ',')) {
+                    if (!item.empty()) options.sizes.push_back(stoul(item));
+                }
+            }
+            else if (arg == "--iterations") options.iterations = max(1, stoi(value()));
+            else if (arg == "--filter") options.filter = value();
+            else if (arg == "--workdir") options.workdir = value();
+            else if (arg == "--out") options.out = value();
+            else if (arg == "--gate") options.gate = true;
+            else if (arg == "--baseline") options.baseline = value();
+            else if (arg == "--update-baseline") options.updateBaseline = value();
+            else if (arg == "--tolerance") options.tolerance = stod(value());
+            else if (arg == "--memory-tolerance") options.memoryTolerance = stod(value());
+            else {
+                cerr << "Usage: scoreme_bench [--sizes 1000,100000,1000000] [--iterations N]\n"
+                     << "                     [--filter text] [--workdir dir] [--out file.json]\n"
+                     << "       scoreme_bench --gate [--baseline file.json] [--tolerance 0.25]\n"
+                     << "                     [--memory-tolerance 0.25] [--update-baseline file.json]" << endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        if (!parseOptions(argc, argv, options)) {
+            return 2;
+        }
+    }
+    catch (const exception& e) {
+        cerr << e.what() << endl;
+        return 2;
+    }
+
+    MenuUtils::setFastRendering(true);
+    BenchSuite suite(options);
+    try {
+        if (options.gate) {
+            suite.runGate();
+        } else {
+            for (size_t rows : options.sizes) {
+                if (rows > 0) {
+                    suite.runSize(rows);
+                }
+            }
+        }
+    }
+    catch (const exception& e) {
+        cerr << "Benchmark failed: " << e.what() << endl;
+        return 1;
+    }
+
+    if (options.out.empty()) {
+        suite.writeJson(cout);
+    } else {
+        ofstream file(options.out);
+        suite.writeJson(file);
+        cerr << "Results written to " << options.out << endl;
+    }
+    if (!options.gate) {
+        return 0;
+    }
+
+    if (!options.updateBaseline.empty()) {
+        ofstream file(options.updateBaseline);
+        suite.writeBaseline(file);
+        cerr << "Baseline written to " << options.updateBaseline << endl;
+        return 0;
+    }
+    if (options.baseline.empty()) {
+        return 0;
+    }
+
+    map<string, string> baseline;
+    try {
+        ifstream file(options.baseline);
+        if (!file) {
+            throw runtime_error("cannot open " + options.baseline);
+        }
+        stringstream text;
+        text << file.rdbuf();
+        baseline = JsonUtil::parseFlatObject(text.str());
+        if (baseline["rows"] != to_string(GATE_ROWS)) {
+            throw runtime_error("baseline was recorded for " + baseline["rows"] + " rows, the gate runs " +
+                                to_string(GATE_ROWS) + "; refresh it with --update-baseline");
+        }
+    }
+    catch (const exception& e) {
+        cerr << "Baseline error: " << e.what() << endl;
+        return 2;
+    }
+
+    int regressions = suite.compareWithBaseline(baseline, cerr);
+    if (regressions > 0) {
+        cerr << regressions << " metric(s) regressed against or missing from " << options.baseline
+             << " (record new metrics with the perf_baseline target)" << endl;
+        return 1;
+    }
+    cerr << "No regressions against " << options.baseline << endl;
+    return 0;
+}
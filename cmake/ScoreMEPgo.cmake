@@ -0,0 +1,149 @@
+# Drives the ScoreME_Generator_pgo target (run with cmake -P):
+#   1. configure and build an instrumented ScoreME_Generator in PGO_BINARY_DIR
+#   2. run the training workload with it to collect a profile
+#   3. reconfigure the same tree to build with the profile and LTO
+#   4. time the workload with the plain and the PGO builds and report the speedup
+#
+# The instrumented and optimized builds share one binary directory because GCC
+# looks up profile data by object file path.
+#
+# Expected -D variables: SOURCE_DIR PGO_BINARY_DIR GENERATOR CXX_COMPILER CXX_COMPILER_ID
+#   BUILD_TYPE PLAIN_EXECUTABLE TRAINING_ROWS OUTPUT_EXECUTABLE XLNT_SOURCE_DIR TABULATE_SOURCE_DIR
+
+set(PROFILE_DIR "${PGO_BINARY_DIR}/profile")
+set(WORK_DIR "${PGO_BINARY_DIR}/workload")
+
+function(run_checked)
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        string(REPLACE ";" " " command "${ARGN}")
+        message(FATAL_ERROR "PGO step failed (${result}): ${command}")
+    endif()
+endfunction()
+
+function(build_stage stage)
+    message(STATUS "PGO: ${stage} build")
+    run_checked(${CMAKE_COMMAND} -S "${SOURCE_DIR}" -B "${PGO_BINARY_DIR}" -G "${GENERATOR}"
+        -DCMAKE_CXX_COMPILER=${CXX_COMPILER}
+        -DCMAKE_BUILD_TYPE=${BUILD_TYPE}
+        -DSCOREME_PGO=OFF
+        -DSCOREME_PGO_STAGE=${stage}
+        -DSCOREME_PGO_PROFILE_DIR=${PROFILE_DIR}
+        -DSCOREME_BUILD_BENCH=OFF
+        -DFETCHCONTENT_SOURCE_DIR_XLNT=${XLNT_SOURCE_DIR}
+        -DFETCHCONTENT_SOURCE_DIR_TABULATE=${TABULATE_SOURCE_DIR})
+    set(config_args "")
+    if(BUILD_TYPE)
+        set(config_args --config ${BUILD_TYPE})
+    endif()
+    run_checked(${CMAKE_COMMAND} --build "${PGO_BINARY_DIR}" --target ScoreME_Generator ${config_args})
+endfunction()
+
+# Runs one step of the workload and returns its wall time in milliseconds, as
+# reported by the program itself (batch status line or generator summary)
+function(run_step executable out_ms)
+    execute_process(COMMAND "${executable}" ${ARGN}
+        WORKING_DIRECTORY "${WORK_DIR}"
+        RESULT_VARIABLE result OUTPUT_VARIABLE out ERROR_VARIABLE err)
+    if(NOT result EQUAL 0)
+        string(REPLACE ";" " " command "${ARGN}")
+        message(FATAL_ERROR "Workload step failed (${result}): ${command}\n${err}")
+    endif()
+    if(err MATCHES "\"elapsed_ms\":([0-9.]+)")
+        set(${out_ms} ${CMAKE_MATCH_1} PARENT_SCOPE)
+    elseif(out MATCHES "in ([0-9.]+)s; wrote .* in ([0-9.]+)s")
+        set(generated ${CMAKE_MATCH_1})
+        set(wrote ${CMAKE_MATCH_2})
+        # math() has no floats: seconds with two decimals -> milliseconds
+        string(REPLACE "." "" generated "${generated}0")
+        string(REPLACE "." "" wrote "${wrote}0")
+        math(EXPR ms "${generated} + ${wrote}")
+        set(${out_ms} ${ms} PARENT_SCOPE)
+    else()
+        set(${out_ms} 0 PARENT_SCOPE)
+    endif()
+endfunction()
+
+# Generate, import, regrade, report, export and query a synthetic roster
+function(run_workload executable seed out_ms)
+    file(REMOVE_RECURSE "${WORK_DIR}")
+    file(MAKE_DIRECTORY "${WORK_DIR}/data/backups")
+    math(EXPR extra_rows "${TRAINING_ROWS} / 4")
+    set(total 0)
+    foreach(step
+            "--create-sample-data;${TRAINING_ROWS};--seed;${seed};--out;roster.xlsx"
+            "--create-sample-data;${extra_rows};--seed;${seed}7;--out;extra.xlsx"
+            "import;extra.xlsx;--into;roster.xlsx"
+            "merge;roster.xlsx;extra.xlsx;--out;merged.xlsx"
+            "regrade;merged.xlsx"
+            "report;merged.xlsx;--out;report.xlsx"
+            "export;merged.xlsx;--out;merged.csv"
+            "query;where avg < 60 order by avg desc limit 100;merged.xlsx;--format;csv")
+        run_step("${executable}" step_ms ${step})
+        string(REGEX REPLACE "\\..*" "" step_ms "${step_ms}")
+        math(EXPR total "${total} + ${step_ms}")
+    endforeach()
+    set(${out_ms} ${total} PARENT_SCOPE)
+endfunction()
+
+function(best_of_three executable out_ms)
+    set(best "")
+    foreach(run 1 2 3)
+        run_workload("${executable}" 11 ms)
+        if(best STREQUAL "" OR ms LESS best)
+            set(best ${ms})
+        endif()
+    endforeach()
+    set(${out_ms} ${best} PARENT_SCOPE)
+endfunction()
+
+# 1-2: instrumented build and training run
+file(REMOVE_RECURSE "${PROFILE_DIR}")
+file(MAKE_DIRECTORY "${PROFILE_DIR}")
+build_stage(GENERATE)
+set(instrumented "${PGO_BINARY_DIR}/ScoreME_Generator${CMAKE_EXECUTABLE_SUFFIX}")
+if(NOT EXISTS "${instrumented}")
+    file(GLOB_RECURSE instrumented "${PGO_BINARY_DIR}/*/ScoreME_Generator${CMAKE_EXECUTABLE_SUFFIX}")
+endif()
+message(STATUS "PGO: training on ${TRAINING_ROWS} students")
+run_workload("${instrumented}" 1 training_ms)
+
+# Clang writes raw profiles that have to be merged first
+if(CXX_COMPILER_ID MATCHES "Clang")
+    get_filename_component(compiler_dir "${CXX_COMPILER}" DIRECTORY)
+    find_program(LLVM_PROFDATA NAMES llvm-profdata HINTS "${compiler_dir}")
+    if(NOT LLVM_PROFDATA)
+        message(FATAL_ERROR "PGO with Clang needs llvm-profdata")
+    endif()
+    file(GLOB raw_profiles "${PROFILE_DIR}/*.profraw")
+    run_checked("${LLVM_PROFDATA}" merge -output=${PROFILE_DIR}/scoreme.profdata ${raw_profiles})
+endif()
+
+# 3: optimized build
+build_stage(USE)
+set(optimized "${PGO_BINARY_DIR}/ScoreME_Generator${CMAKE_EXECUTABLE_SUFFIX}")
+if(NOT EXISTS "${optimized}")
+    file(GLOB_RECURSE optimized "${PGO_BINARY_DIR}/*/ScoreME_Generator${CMAKE_EXECUTABLE_SUFFIX}")
+endif()
+run_checked(${CMAKE_COMMAND} -E copy "${optimized}" "${OUTPUT_EXECUTABLE}")
+
+# 4: compare with the plain build
+message(STATUS "PGO: timing plain and PGO+LTO builds (best of 3)")
+best_of_three("${PLAIN_EXECUTABLE}" plain_ms)
+best_of_three("${OUTPUT_EXECUTABLE}" pgo_ms)
+if(pgo_ms GREATER 0)
+    math(EXPR speedup_x100 "${plain_ms} * 100 / ${pgo_ms}")
+    math(EXPR whole "${speedup_x100} / 100")
+    math(EXPR fraction "${speedup_x100} % 100")
+    if(fraction LESS 10)
+        set(fraction "0${fraction}")
+    endif()
+    set(speedup "${whole}.${fraction}x")
+else()
+    set(speedup "n/a")
+endif()
+
+set(report "PGO workload (${TRAINING_ROWS} students): plain ${plain_ms} ms, PGO+LTO ${pgo_ms} ms, speedup ${speedup}")
+file(WRITE "${PGO_BINARY_DIR}/pgo_report.txt" "${report}\n")
+message(STATUS "${report}")
+message(STATUS "PGO: optimized binary at ${OUTPUT_EXECUTABLE}")
@@ -1,12 +1,46 @@
 #pragma once
 #include "Person.hpp"
 #include "Student.hpp"
+#include "CredentialIndex.hpp"
+#include "SearchIndex.hpp"
+#include "ScoreIndex.hpp"
+#include "RosterClient.hpp"
+#include "ScoreHistory.hpp"
 #include <vector>
 
 class Admin : public Person {
 private:
     static const std::string DEFAULT_ADMIN_USERNAME;
     static const std::string DEFAULT_ADMIN_PASSWORD;
+    static const std::string ROSTER_FILE;
+
+    // Lookup indexes kept in step with roster edits
+    CredentialIndex* credentialIndex = nullptr;  // Owned by the application
+
+    // Set while a `serve` process holds the roster: reads, exports and field
+    // or score edits go to its copy; changes it has no operation for (adding,
+    // deleting, importing, credentials) are refused so its next save cannot
+    // drop them
+    RosterClient* server = nullptr;              // Owned by the application
+    bool refuseWhileServed() const;
+    void showServerResult(const std::string& query);
+    bool forwardField(const std::string& id, const std::string& field, const std::string& value);
+    bool forwardScores(const std::string& id, const std::vector<double>& scores);
+    SearchIndex searchIndex;
+    ScoreIndex scoreIndex;
+
+    // Index maintenance
+    void syncIndexes(const std::vector<Student>& students);
+    void onStudentAdded(const std::vector<Student>& students, size_t position);
+    void onStudentRemoved(size_t position);
+    void onStudentEdited(const std::vector<Student>& students, size_t position);
+    void onRosterReordered(const std::vector<Student>& students);
+
+    // Score history of ROSTER_FILE, loaded on the first score edit and kept
+    // in memory; each edit appends to it and writes it next to the roster
+    ScoreHistory scoreHistory;
+    bool scoreHistoryLoaded = false;
+    void recordScoreHistory(const Student& student);
 
 public:
     // Constructors
@@ -18,6 +52,10 @@ public:
     void showMenu() override;  // Only ONE declaration of showMenu()
     std::string getRole() const override;
 
+    // Index wiring
+    void attachCredentialIndex(CredentialIndex* index);
+    void attachServer(RosterClient* client);
+
     // Admin-specific methods
     void showMenuWithData(std::vector<Student>& students);
     void manageStudents(std::vector<Student>& students);
@@ -27,7 +65,10 @@ public:
     void deleteStudent(std::vector<Student>& students);
     void searchStudent(const std::vector<Student>& students);
     void showFailingStudents(const std::vector<Student>& students);
+    void findStudentsByScoreRange(const std::vector<Student>& students);
     void sortStudentsByScore(std::vector<Student>& students);
+    void runQuery(const std::vector<Student>& students);
+    void showPerformanceStats(const std::vector<Student>& students);
         
     // Data management methods
     void importExcelData(std::vector<Student>& students, const std::string& filename);
@@ -0,0 +1,63 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+
+class CompiledQuery;
+struct QueryResult;
+
+// Non-interactive entry point: `ScoreME_Generator <subcommand> [args]`.
+// Subcommands never prompt or clear the screen. Each run ends with one JSON
+// status line on stderr (command, status, exit code, student count and
+// per-stage timings) so scripts can parse the outcome.
+class BatchCli {
+public:
+    static bool isSubcommand(const std::string& name);
+    static int run(int argc, char* argv[]);
+    static void printUsage(std::ostream& out);
+
+    // Exit codes
+    static const int EXIT_OK;
+    static const int EXIT_FAILED;
+    static const int EXIT_USAGE;
+
+    // Parsed command line: positional arguments plus --option value pairs
+    struct Arguments {
+        std::string command;
+        std::vector<std::string> positional;
+        std::map<std::string, std::string> options;
+
+        std::string option(const std::string& name, const std::string& fallback) const;
+    };
+
+    // Outcome and timings of one run
+    struct Report {
+        std::string command;
+        std::string error;
+        size_t students = 0;
+        size_t files = 0;
+        std::vector<std::pair<std::string, double>> stages;   // name, milliseconds
+        std::map<std::string, size_t> counts;                  // extra per-command counters
+        double totalMilliseconds = 0.0;
+    };
+
+private:
+    static Arguments parseArguments(int argc, char* argv[]);
+    static void writeStatus(std::ostream& out, const Report& report, int exitCode);
+
+    // Subcommands
+    static int runImport(const Arguments& args, Report& report);
+    static int runMerge(const Arguments& args, Report& report);
+    static int runRegrade(const Arguments& args, Report& report);
+    static int runReport(const Arguments& args, Report& report);
+    static int runExport(const Arguments& args, Report& report);
+    static int runQuery(const Arguments& args, Report& report);
+    static int runBackup(const Arguments& args, Report& report);
+    static int runPartitions(const Arguments& args, Report& report);
+    static int runHistory(const Arguments& args, Report& report);
+
+    // --partition variants
+    static int runImportIntoPartition(const Arguments& args, Report& report);
+    static QueryResult runQueryPartitions(const Arguments& args, const CompiledQuery& query, Report& report);
+};
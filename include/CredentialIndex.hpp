@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "Student.hpp"
+
+// Username-keyed lookup table for student logins.
+// Maps each username to the student's position in the roster vector, so a
+// login is a single hash probe instead of a scan over every student.
+class CredentialIndex {
+public:
+    // Build and maintenance
+    void rebuild(const std::vector<Student>& students);
+    void addStudent(const Student& student, size_t position);
+    void removeStudent(size_t position);
+    void updateUsername(const std::string& oldUsername, const Student& student, size_t position);
+    void updatePassword(const std::string& username, size_t position, const std::string& newPassword);
+
+    // Lookup
+    Student* authenticate(std::vector<Student>& students,
+                          const std::string& username, const std::string& password) const;
+    bool hasUsername(const std::string& username) const;
+    size_t size() const;
+
+    // Compares two strings without exiting early on the first mismatch
+    static bool constantTimeEquals(const std::string& a, const std::string& b);
+
+private:
+    struct Entry {
+        size_t position;
+        std::string password;
+    };
+
+    std::unordered_map<std::string, Entry> entries;
+};
@@ -1,24 +1,36 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <ctime>
 #include "Student.hpp"
 
 // Forward declaration to avoid circular dependency
 namespace xlnt {
     class worksheet;
+    class format;
 }
 
 class ExcelUtils {
 public:
     // Main Excel operations
-    static void writeExcel(const std::string& filename, const std::vector<Student>& students);
+    // fastCompression: larger file, quicker save (used for backups)
+    static bool writeExcel(const std::string& filename, const std::vector<Student>& students,
+                           bool fastCompression = false);
+    // Prints why a read failed and returns whatever rows it got (possibly none)
     static std::vector<Student> readExcelToVector(const std::string& filename);
+    // False with a reason if the file is missing, unreadable or has rows that
+    // could not be read; use this before anything is written back over the file
+    static bool readStudents(const std::string& filename, std::vector<Student>& students, std::string& error);
     static void readExcel(const std::string& filename);
     
+    // Same workbook through xlnt's cell model; slower, kept as a reference for benchmarks
+    static bool writeExcelWithXlnt(const std::string& filename, const std::vector<Student>& students);
+    
     // Enhanced Excel operations
-    static void writeExcelWithTimestamp(const std::string& baseFilename, const std::vector<Student>& students);
-    static void createBackup(const std::string& sourceFilename, const std::vector<Student>& students);
-    static void exportGradeReport(const std::string& filename, const std::vector<Student>& students);
+    static bool writeExcelWithTimestamp(const std::string& baseFilename, const std::vector<Student>& students);
+    static bool createBackup(const std::string& sourceFilename, const std::vector<Student>& students);
+    static bool exportGradeReport(const std::string& filename, const std::vector<Student>& students);
+    static bool writeCsv(const std::string& filename, const std::vector<Student>& students);
     
     // Import operations
     static bool importStudentData(const std::string& filename, std::vector<Student>& students);
@@ -27,6 +39,10 @@ public:
     // Utility methods
     static std::string generateTimestampFilename(const std::string& baseFilename);
     static std::string getCurrentTimestamp();
+    // Excel serial date-time (days since 1899-12-30) of a local time
+    static double toExcelDateTime(std::time_t time);
+    // ...and back, to the nearest second
+    static std::time_t fromExcelDateTime(double serial);
     static bool fileExists(const std::string& filename);
     
     // Excel column headers
@@ -35,6 +51,8 @@ public:
 private:
     // Helper methods for Excel formatting
     static void formatExcelHeader(xlnt::worksheet& ws);
-    static void writeStudentToExcel(xlnt::worksheet& ws, const Student& student, int row);
+    static xlnt::format createTimestampFormat(xlnt::worksheet& ws);
+    static void writeStudentToExcel(xlnt::worksheet& ws, const Student& student, int row,
+                                    const xlnt::format& timestampFormat);
     static Student readStudentFromExcel(xlnt::worksheet& ws, int row);
 };
\ No newline at end of file
@@ -14,6 +14,11 @@ public:
     static bool isValidScore(double score);
     static bool isPassingGrade(double average);
     
+    // Letter grade ordering (F = 0 up to A = 5) and score boundaries
+    static int gradeRank(const std::string& grade);
+    static double getGradeLowerBound(const std::string& grade);
+    static double getGradeUpperBound(const std::string& grade);
+    
     // Subject names
     static std::vector<std::string> getSubjectNames();
     
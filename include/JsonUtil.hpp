@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <map>
+#include <vector>
+
+// Minimal JSON helpers for the line-oriented status and socket protocols.
+// Requests are flat objects (string, number, boolean and null values);
+// parse() also reads the nested server responses the thin client needs.
+class JsonUtil {
+public:
+    struct Value {
+        enum Type { NUL, SCALAR, ARRAY, OBJECT };
+        Type type = NUL;
+        std::string text;                  // Scalars as their text ("42", "true", unescaped strings)
+        std::vector<Value> items;          // Array elements, or object member values
+        std::vector<std::string> keys;     // Object member names, parallel to items
+
+        // Object member; throws std::runtime_error when absent
+        const Value& at(const std::string& key) const;
+        bool has(const std::string& key) const;
+    };
+
+    static std::string escape(const std::string& text);
+    static std::string quote(const std::string& text);
+
+    // Values come back as their text ("42", "true", unescaped strings); throws on malformed input
+    static std::map<std::string, std::string> parseFlatObject(const std::string& text);
+
+    // Any JSON document; throws on malformed input
+    static Value parse(const std::string& text);
+};
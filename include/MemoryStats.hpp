@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "Student.hpp"
+
+// Where the memory goes.
+//
+// The per-student breakdown is measured from the objects themselves and is
+// always available. Live/peak bytes per subsystem need the build option
+// SCOREME_TRACK_MEMORY, which replaces global operator new/delete: every
+// allocation is charged to the tag of the innermost MemoryStats::Scope on
+// its thread (OTHER outside any scope) and credited back when freed.
+//
+// SCOREME_MEMORY_REPORT=1 prints the report to stderr at exit.
+class MemoryStats {
+public:
+    enum Tag : uint8_t {
+        OTHER = 0,
+        ROSTER,      // student records
+        IMPORT,      // staging copies while importing/merging
+        WORKBOOK,    // xlnt workbooks being loaded, built or saved
+        RENDER,      // tables and screen buffers
+        INDEX,       // lookup indexes
+        TAG_COUNT
+    };
+
+    // Charges allocations on this thread to a tag until destroyed
+    class Scope {
+    public:
+        explicit Scope(Tag tag);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Tag previous;
+    };
+
+    struct TagStats {
+        const char* name;
+        int64_t liveBytes;
+        int64_t peakBytes;
+        uint64_t allocations;
+    };
+
+    // Heap and inline bytes of one student, by part
+    struct StudentBreakdown {
+        size_t object = 0;           // sizeof(Student)
+        size_t loginStrings = 0;     // username, password, name
+        size_t profileStrings = 0;   // id, gender, date of birth, email
+        size_t gradeStrings = 0;     // letter grade, remark
+        size_t scores = 0;           // score vector storage
+        size_t total() const { return object + loginStrings + profileStrings + gradeStrings + scores; }
+    };
+
+    static const char* tagName(Tag tag);
+    static bool isTracking();   // built with SCOREME_TRACK_MEMORY
+    static std::vector<TagStats> tagStats();
+
+    static StudentBreakdown measureStudent(const Student& student);
+    static StudentBreakdown measureRoster(const std::vector<Student>& students);   // summed
+
+    // Process resident set size, in KiB (0 when unknown)
+    static long residentKb();
+    static long peakResidentKb();
+    static void resetPeakResident();   // Linux only
+
+    static void printReport(std::ostream& out, const std::vector<Student>* roster);
+
+    // SCOREME_MEMORY_REPORT; prints once even if called from several exit paths
+    static void printReportFromEnvironment(const std::vector<Student>* roster);
+
+    // Used by the allocation hooks
+    static Tag currentTag();
+    static void recordAllocation(Tag tag, size_t bytes);
+    static void recordDeallocation(Tag tag, size_t bytes);
+
+private:
+    static std::atomic<bool> reported;
+};
@@ -2,6 +2,9 @@
 #include <vector>
 #include <string>
 #include "Student.hpp"
+#include "StudentView.hpp"
+#include "QueryEngine.hpp"
+#include "Metrics.hpp"
 
 // Forward declaration for tabulate Color
 namespace tabulate {
@@ -12,13 +15,19 @@ class MenuUtils {
 public:
     // Display methods
     static void displayTable(const std::vector<Student>& students);
+    static void displayTable(const StudentView& students);
+    static void displayPagedTable(const StudentView& students);
     static void displayStudentDetails(const Student& student);
     static void displayGradeReport(const std::vector<Student>& students);
     static void displayFailingStudents(const std::vector<Student>& students);
+    static void displayFailingStudents(const StudentView& students);
+    static void displayQueryResult(const QueryResult& result);
+    static void displayPerformanceStats(const std::vector<Metrics::TimerStats>& timers,
+                                        const std::vector<Metrics::CounterStats>& counters);
     
     // Menu display methods
     static void printMenu(const std::vector<std::string>& items);
-    static void printWelcome();
+    static void printWelcome(bool animated = true);
     static void printMainMenu();
     static void printAdminMenu();
     static void printStudentMenu();
@@ -44,6 +53,9 @@ public:
     
     // Utility methods
     static void clearScreen();
+    static void enableAnsiOutput();
+    static void sleepMilliseconds(int milliseconds);
+    static bool isInteractiveTerminal();
     static void pauseScreen();
     static void printSeparator();
     static void printHeader(const std::string& title);
@@ -58,4 +70,19 @@ public:
     static const std::string CYAN;
     static const std::string WHITE;
     static const std::string BOLD;
+    
+    // Rosters longer than this are shown one page at a time
+    static const size_t PAGE_SIZE;
+    
+    // Rendering backend for the student tables
+    static void setFastRendering(bool enabled);
+    static bool isFastRendering();
+    
+private:
+    static bool fastRendering;
+    
+    // Paged table helpers
+    static std::vector<size_t> sampleColumnWidths(const StudentView& students);
+    static void renderStudentRows(const StudentView& students, size_t first, size_t last,
+                                  const std::vector<size_t>& sampledWidths);
 };
\ No newline at end of file
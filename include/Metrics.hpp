@@ -0,0 +1,130 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Trace.hpp"
+
+// Process-wide timers and counters for the slow paths (workbook I/O, grading,
+// admin lookups). Instrumented code uses the macros below; each site looks its
+// metric up once and afterwards only pays for a relaxed atomic check while
+// metrics are switched off at run time (SCOREME_METRICS=0), and for nothing
+// at all when built with SCOREME_DISABLE_METRICS.
+//
+// Set SCOREME_METRICS_FILE to write everything on exit: *.json as JSON,
+// anything else as Prometheus text. While tracing is on (see Trace), each
+// timed scope is also recorded as a trace span.
+class Metrics {
+public:
+    static const size_t BUCKET_COUNT = 8;
+    static const std::array<double, BUCKET_COUNT - 1> BUCKET_BOUNDS;   // seconds; last bucket is +Inf
+
+    class Timer {
+    public:
+        explicit Timer(const std::string& name) : name(name) {}
+        void record(uint64_t nanoseconds);
+
+        const std::string name;
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> totalNanoseconds{0};
+        std::atomic<uint64_t> maxNanoseconds{0};
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+    };
+
+    class Counter {
+    public:
+        explicit Counter(const std::string& name) : name(name) {}
+        void add(uint64_t amount) {
+            if (Metrics::isEnabled()) {
+                value.fetch_add(amount, std::memory_order_relaxed);
+            }
+        }
+
+        const std::string name;
+        std::atomic<uint64_t> value{0};
+    };
+
+    // Records the lifetime of a scope into a timer (and the trace, when tracing)
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Timer& timer)
+            : timer(timer), timing(Metrics::isEnabled()), tracing(Trace::isEnabled()) {
+            if (timing || tracing) {
+                start = std::chrono::steady_clock::now();
+            }
+        }
+        ~ScopedTimer() {
+            if (!timing && !tracing) {
+                return;
+            }
+            auto end = std::chrono::steady_clock::now();
+            if (timing) {
+                timer.record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+            }
+            if (tracing) {
+                Trace::record(timer.name, start, end);
+            }
+        }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Timer& timer;
+        bool timing;
+        bool tracing;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    // Plain copies for display
+    struct TimerStats {
+        std::string name;
+        uint64_t count;
+        double totalSeconds;
+        double maxSeconds;
+    };
+    struct CounterStats {
+        std::string name;
+        uint64_t value;
+    };
+
+    // Registry; returned references stay valid for the life of the process
+    static Timer& timer(const std::string& name);
+    static Counter& counter(const std::string& name);
+
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool on);
+    static void reset();
+
+    static std::vector<TimerStats> timerStats();
+    static std::vector<CounterStats> counterStats();
+
+    // Exporters
+    static void writePrometheus(std::ostream& out);
+    static void writeJson(std::ostream& out);
+    static bool writeFile(const std::string& filename);   // format by extension
+    static void writeFileFromEnvironment();               // SCOREME_METRICS_FILE, if set
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+#ifdef SCOREME_DISABLE_METRICS
+#define SCOREME_TIME_SCOPE(name) ((void)0)
+#define SCOREME_COUNT(name, amount) ((void)0)
+#else
+#define SCOREME_METRICS_CONCAT_INNER(a, b) a##b
+#define SCOREME_METRICS_CONCAT(a, b) SCOREME_METRICS_CONCAT_INNER(a, b)
+// Times the rest of the enclosing scope
+#define SCOREME_TIME_SCOPE(name)                                                                   \
+    static Metrics::Timer& SCOREME_METRICS_CONCAT(scoremeTimer, __LINE__) = Metrics::timer(name);  \
+    Metrics::ScopedTimer SCOREME_METRICS_CONCAT(scoremeScope, __LINE__)(SCOREME_METRICS_CONCAT(scoremeTimer, __LINE__))
+#define SCOREME_COUNT(name, amount)                                                                \
+    do {                                                                                           \
+        static Metrics::Counter& scoremeCounter = Metrics::counter(name);                          \
+        scoremeCounter.add(amount);                                                                \
+    } while (0)
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+#include "Student.hpp"
+
+// The roster split into named partitions (a cohort, term or school each),
+// one workbook per partition next to a manifest:
+//
+//   data/partitions/manifest.jsonl    one JSON object per partition
+//   data/partitions/<name>.xlsx
+//
+// The manifest records each partition's student count and ID range, so a
+// caller can pick partitions without opening them and only loads those.
+class PartitionStore {
+public:
+    struct Partition {
+        std::string name;
+        size_t students = 0;
+        std::string firstId;    // Smallest and largest student ID, for pruning lookups
+        std::string lastId;
+    };
+
+    // Reads the manifest if there is one; throws std::runtime_error if it is malformed
+    explicit PartitionStore(const std::string& directory = DEFAULT_DIRECTORY);
+
+    bool empty() const { return entries.empty(); }
+    const std::vector<Partition>& partitions() const { return entries; }
+    bool contains(const std::string& name) const;
+
+    // "all" or a comma-separated list; throws std::runtime_error on unknown names
+    std::vector<std::string> select(const std::string& list) const;
+
+    // Partitions whose ID range overlaps [firstId, lastId] (pass the same ID
+    // twice for a single lookup), in manifest order
+    std::vector<std::string> partitionsForIds(const std::string& firstId, const std::string& lastId) const;
+
+    // The named partitions joined in the order given, read in parallel
+    std::vector<Student> load(const std::vector<std::string>& names) const;
+
+    // Reads the named partitions on worker threads and hands each roster to
+    // `visit` on the thread that read it, so only a few are in memory at once.
+    // `visit` must be safe to call concurrently; the first exception is rethrown.
+    // Throws std::runtime_error if a partition cannot be read or its student
+    // count differs from the manifest, so callers never save back a partial roster.
+    void scan(const std::vector<std::string>& names,
+              const std::function<void(const Partition&, std::vector<Student>&)>& visit) const;
+
+    // Writes one partition (creating it if new) and then the manifest
+    bool save(const std::string& name, const std::vector<Student>& students);
+
+    std::string pathFor(const std::string& name) const;
+
+    static bool isValidName(const std::string& name);
+
+    static const char* const DEFAULT_DIRECTORY;
+    static const char* const MANIFEST_FILE;
+
+private:
+    std::string directory;
+    std::vector<Partition> entries;
+
+    const Partition& find(const std::string& name) const;
+    bool writeManifest() const;
+};
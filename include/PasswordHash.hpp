@@ -0,0 +1,25 @@
+#pragma once
+#include <string>
+
+// Salted, iterated SHA-256 for passwords that are written to disk.
+// Stored form: $sha256$<iterations>$<salt hex>$<digest hex>
+//
+// Passwords typed in the admin menu stay plain in memory until the next
+// roster cache save hashes them; verify() accepts either form.
+class PasswordHash {
+public:
+    static std::string hash(const std::string& password, unsigned iterations = ITERATIONS);
+    static bool verify(const std::string& password, const std::string& stored);
+    static bool isHash(const std::string& stored);
+
+    // Raw 32-byte digest
+    static std::string sha256(const std::string& data);
+
+    static const unsigned ITERATIONS;
+    // Generated fixtures: hashed so loading never sees plain text, but cheap
+    // enough to write millions of rows
+    static const unsigned FIXTURE_ITERATIONS;
+
+private:
+    static std::string derive(const std::string& password, const std::string& salt, unsigned iterations);
+};
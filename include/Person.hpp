@@ -14,9 +14,9 @@ public:
     virtual ~Person() = default;
     
     // Getters
-    std::string getUsername() const;
-    std::string getPassword() const;
-    std::string getName() const;
+    const std::string& getUsername() const;
+    const std::string& getPassword() const;
+    const std::string& getName() const;
     
     // Setters
     void setUsername(const std::string& username);
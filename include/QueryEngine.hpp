@@ -0,0 +1,67 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "Student.hpp"
+#include "RosterPages.hpp"
+
+// Rows produced by running a query, already projected to the selected columns
+struct QueryResult {
+    std::vector<std::string> columns;
+    std::vector<std::vector<std::string>> rows;
+    std::vector<uint32_t> positions;   // Roster position of every row
+    size_t matched = 0;                // Rows that passed the filter, before limit
+};
+
+// A query parsed and resolved once, ready to run against any roster.
+//
+// Grammar (keywords are case-insensitive, clauses may come in any order):
+//   [where <condition>] [order by <column> [asc|desc], ...] [limit <n>] [select <column>, ... | *]
+//   condition := <column> <op> <value> | not <condition> | <condition> and|or <condition> | ( <condition> )
+//   op        := = != < <= > >= contains
+//
+// Numeric columns: age, avg, gpa, grade and every subject (e.g. physics, computer_science).
+// Letter grades compare by rank, so "grade >= 'C'" means C or better.
+class CompiledQuery {
+public:
+    struct Node;
+    struct SortKey {
+        int column;
+        bool descending;
+    };
+
+    CompiledQuery();
+    ~CompiledQuery();
+    CompiledQuery(CompiledQuery&&) noexcept;
+    CompiledQuery& operator=(CompiledQuery&&) noexcept;
+
+    std::unique_ptr<Node> filter;
+    std::vector<SortKey> orderBy;
+    std::vector<int> projection;
+    size_t limit;
+    std::string text;
+};
+
+class QueryEngine {
+public:
+    // Parse a query; throws std::runtime_error describing the first problem
+    static CompiledQuery compile(const std::string& text);
+
+    // Filter, order, limit and project the roster
+    static QueryResult execute(const CompiledQuery& query, const std::vector<Student>& students);
+    static QueryResult execute(const CompiledQuery& query, const RosterPages& students);
+    static QueryResult run(const std::string& text, const std::vector<Student>& students);
+
+    // Multi-key ordering of the roster as a permutation of positions, e.g. "grade desc, avg desc, name".
+    // A non-zero topK keeps only the first topK positions.
+    static std::vector<CompiledQuery::SortKey> parseSortKeys(const std::string& spec);
+    static std::vector<uint32_t> sortedPositions(const std::vector<Student>& students,
+                                                 const std::vector<CompiledQuery::SortKey>& keys,
+                                                 size_t topK = 0);
+
+    // Column catalogue
+    static std::vector<std::string> getColumnNames();
+    static int columnForName(const std::string& name);   // -1 when unknown
+    static bool isNumericColumn(int column);
+};
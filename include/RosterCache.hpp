@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Student.hpp"
+
+// Compact binary copy of the roster, including login credentials. Passwords
+// are stored as salted hashes (PasswordHash) and the file is readable by its
+// owner only.
+// Loading it skips xlsx parsing entirely; it is only trusted while it is at
+// least as new as the workbook it was made from.
+class RosterCache {
+public:
+    static bool save(const std::string& filename, const std::vector<Student>& students);
+    static bool load(const std::string& filename, std::vector<Student>& students);
+    static bool isFresh(const std::string& cacheFilename, const std::string& sourceFilename);
+
+    // The workbook has no credential columns: copy usernames/passwords over by student ID
+    static void restoreCredentials(std::vector<Student>& students, const std::vector<Student>& cached);
+
+    // data/students.xlsx -> data/students.cache
+    static std::string cachePathFor(const std::string& sourceFilename);
+
+private:
+    static const char MAGIC[4];
+    static const uint32_t VERSION;
+};
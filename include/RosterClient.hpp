@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include "QueryEngine.hpp"
+
+// Thin client for RosterServer: sends one JSON request line per call and
+// returns the server's response line.
+class RosterClient {
+public:
+    explicit RosterClient(const std::string& socketPath);
+    ~RosterClient();
+
+    RosterClient(const RosterClient&) = delete;
+    RosterClient& operator=(const RosterClient&) = delete;
+
+    bool connect();
+    bool isConnected() const;
+    std::string request(const std::string& line);   // throws runtime_error on I/O failure
+
+    // Typed calls for the menus; throw runtime_error with the server's message when it refuses
+    QueryResult query(const std::string& text);
+    QueryResult search(const std::string& text, size_t limit);   // Columns: id, name, score
+    std::string report(const std::string& output);               // Returns the file written
+    std::string rosterFile();                                    // Absolute path of the served workbook
+    void setScore(const std::string& id, const std::string& subject, double score);
+    void setField(const std::string& id, const std::string& field, const std::string& value);
+
+    // Turns `op key=value ...` into a request object; search/query take the rest of the line as text.
+    // Throws invalid_argument for malformed input
+    static std::string buildRequest(const std::string& commandLine);
+
+    // `client [op key=value ...]`; without an op, reads commands from stdin
+    static int run(int argc, char* argv[]);
+
+private:
+    std::string socketPath;
+    int fd = -1;
+    std::string pending;   // bytes received past the last newline
+};
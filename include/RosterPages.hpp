@@ -0,0 +1,33 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "Student.hpp"
+
+// The roster as fixed-size pages that roster versions share. Copying a
+// RosterPages copies only the page pointers; the first write to a page
+// through mutableAt() gives this copy its own page, so an edit costs one
+// page rather than the whole roster.
+class RosterPages {
+public:
+    RosterPages() = default;
+    explicit RosterPages(std::vector<Student> students);
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const Student& operator[](size_t position) const {
+        return (*pages[position / PAGE_SIZE])[position % PAGE_SIZE];
+    }
+
+    // Writable student; copies its page first if another version shares it.
+    // Only for the single writer building an unpublished version.
+    Student& mutableAt(size_t position);
+
+    // Contiguous copy, for writers that take a whole roster vector
+    std::vector<Student> toVector() const;
+
+    static const size_t PAGE_SIZE;
+
+private:
+    std::vector<std::shared_ptr<std::vector<Student>>> pages;
+    size_t count = 0;
+};
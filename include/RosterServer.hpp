@@ -0,0 +1,90 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include "Student.hpp"
+#include "RosterStore.hpp"
+
+// Long-running daemon that keeps one roster in memory and serves it over a
+// Unix domain socket. Protocol: one JSON object per line in each direction.
+//
+//   {"op":"ping"}                                   -> {"ok":true,"students":N,"roster":"/abs/path.xlsx"}
+//   {"op":"get","id":"STU001"}                      -> {"ok":true,"student":{...}}
+//   {"op":"search","text":"jon","limit":10}         -> {"ok":true,"results":[...]}
+//   {"op":"query","text":"where avg < 50"}          -> {"ok":true,"columns":[...],"rows":[[...]]}
+//   {"op":"set_score","id":..,"subject":..,"score":..}
+//   {"op":"set_field","id":..,"field":"name|age|gender|dob|email","value":..}
+//   {"op":"report","out":"grade_report.xlsx"}       (written to the roster's directory)
+//   {"op":"memory"}                                 -> {"ok":true,"report":"<text>"}
+//   {"op":"metrics"}                                -> {"ok":true,"metrics":{"timers":..,"counters":..}}
+//   {"op":"save"} / {"op":"shutdown"}
+//
+// Errors come back as {"ok":false,"error":"..."}. Every request reads from a
+// RosterStore snapshot, so lookups, queries, reports and saves never wait
+// for edits (or block them); edits are applied one at a time.
+class RosterServer {
+public:
+    RosterServer(const std::string& rosterFile, const std::string& socketPath);
+    ~RosterServer();
+
+    RosterServer(const RosterServer&) = delete;
+    RosterServer& operator=(const RosterServer&) = delete;
+
+    bool start();            // load the roster and bind the socket
+    void serve();            // blocks until shutdown or SIGINT/SIGTERM
+    void stop();
+
+    // One request line in, one response line out (no trailing newline)
+    std::string handleRequest(const std::string& line);
+
+    size_t size() const;
+
+    // SCOREME_SOCKET or data/scoreme.sock
+    static std::string defaultSocketPath();
+
+    // `serve [workbook] [--socket path]`
+    static int run(int argc, char* argv[]);
+
+    static const size_t MAX_LINE_LENGTH;
+
+private:
+    struct Connection {
+        std::thread worker;
+        std::shared_ptr<std::atomic<bool>> finished;
+    };
+
+    std::string rosterFile;
+    std::string socketPath;
+    int listenFd = -1;
+    std::atomic<bool> running{false};
+
+    RosterStore store;
+    std::mutex saveMutex;                    // one writer of the files at a time
+    std::atomic<uint64_t> savedVersion{0};   // last version written to disk
+
+    std::mutex connectionsMutex;
+    std::vector<Connection> connections;
+
+    void handleConnection(int clientFd, std::shared_ptr<std::atomic<bool>> finished);
+    void reapConnections(bool all);
+    bool saveRoster(std::string& error);
+
+    // Operations
+    std::string opPing() const;
+    std::string opGet(const std::map<std::string, std::string>& request) const;
+    std::string opSearch(const std::map<std::string, std::string>& request) const;
+    std::string opQuery(const std::map<std::string, std::string>& request) const;
+    std::string opSetScore(const std::map<std::string, std::string>& request);
+    std::string opSetField(const std::map<std::string, std::string>& request);
+    std::string opReport(const std::map<std::string, std::string>& request);
+    std::string opSave();
+
+    static std::string studentToJson(const Student& student);
+    static std::string errorResponse(const std::string& message);
+    static const std::string& requireField(const std::map<std::string, std::string>& request,
+                                           const std::string& name);
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Student.hpp"
+#include "SearchIndex.hpp"
+#include "RosterPages.hpp"
+
+// Copy-on-write roster versions. Readers grab the current version and keep
+// an immutable, consistent view for as long as they hold it, without
+// blocking or being blocked by edits. Writers are serialized: each edit
+// copies the latest version, changes the copy and publishes it atomically.
+//
+// Versions share structure, so an edit copies one roster page and a small
+// search delta rather than the roster and its index.
+class RosterStore {
+public:
+    // Students whose searchable text changed since the full index was built
+    struct SearchDelta {
+        SearchIndex index;                  // Positions here are slots in `positions`
+        std::vector<size_t> positions;      // Slot -> roster position
+        std::unordered_set<size_t> edited;  // Roster positions the full index has stale
+    };
+
+    struct Version {
+        RosterPages students;
+        std::shared_ptr<const SearchIndex> searchIndex;   // full index, shared until a fold
+        std::shared_ptr<const SearchDelta> searchDelta;   // null when the full index is current
+        std::shared_ptr<const std::unordered_map<std::string, size_t>> positionById;   // first student per ID
+        uint64_t number = 0;
+
+        // Roster position of a student ID, -1 when absent
+        long find(const std::string& id) const;
+
+        // Ranked like SearchIndex::search over the current student text
+        std::vector<SearchResult> search(const std::string& text, size_t limit) const;
+
+        // Call after changing a student's name or email
+        void reindex(size_t position);
+    };
+
+    // Edited students kept in the delta before it is folded into a new full index
+    static const size_t SEARCH_DELTA_LIMIT;
+
+    using Snapshot = std::shared_ptr<const Version>;
+
+    explicit RosterStore(std::vector<Student> students = {});
+
+    Snapshot snapshot() const;
+    uint64_t versionNumber() const;
+
+    // Replaces the whole roster; returns the new version number
+    uint64_t replace(std::vector<Student> students);
+
+    // Runs `edit` on a private copy of the latest version and publishes it when
+    // it returns true. Nothing is published if it returns false or throws.
+    bool update(const std::function<bool(Version&)>& edit);
+
+private:
+    Snapshot current;                 // accessed only through std::atomic_load/atomic_store
+    std::mutex writerMutex;
+    std::atomic<uint64_t> latestNumber{0};
+
+    void publish(std::shared_ptr<Version> next);
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <ctime>
+#include "Student.hpp"
+
+// Seeded synthetic rosters for load testing.
+// Student i depends only on (seed, i), so the output is identical whatever
+// the thread count. IDs and emails are unique; roughly failureRate of the
+// students end up with a failing (F) average.
+class SampleDataGenerator {
+public:
+    struct Options {
+        size_t count = 1000;
+        uint64_t seed = 42;
+        double failureRate = 0.10;
+        size_t threads = 0;                  // 0 = one per core
+        bool withCredentials = false;        // username/password for every student
+        unsigned passwordIterations = 0;     // > 0 stores each password pre-hashed with this many rounds
+        std::time_t timestamp = 1735689600;  // fixed "last updated" (2025-01-01) for reproducible files
+    };
+
+    static std::vector<Student> generate(const Options& options);
+    static Student generateStudent(size_t index, const Options& options);
+
+    // `--create-sample-data N [--out file] [--format xlsx|csv|bin] [--seed S]
+    //  [--failure-rate R] [--threads T]`
+    static int run(int argc, char* argv[]);
+
+    // Rosters smaller than this are generated on the calling thread
+    static const size_t PARALLEL_THRESHOLD;
+};
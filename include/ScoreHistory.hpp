@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Student.hpp"
+
+// Every score a student has had: one time series per subject plus one for
+// the average. A point is added only when a value changes, so recording the
+// whole roster once a term costs little when few scores moved.
+//
+// Series stay encoded in memory and on disk. Points are grouped in blocks
+// of BLOCK_POINTS; a block header holds its first point in full and the
+// rest follow as varint time deltas and zigzag varint score deltas (scores
+// in hundredths). Range reads binary-search the headers and decode only the
+// blocks they cover.
+class ScoreHistory {
+public:
+    struct Point {
+        std::time_t time;
+        double score;
+    };
+
+    // How one series moved over a period
+    struct Change {
+        std::string studentId;
+        double from;    // Score in force at the start of the period (or the first one after it)
+        double to;      // Score in force at the end
+        double delta() const { return to - from; }
+    };
+
+    // False if there is no history file yet; throws std::runtime_error if it
+    // is unreadable, so a damaged history is never silently replaced
+    bool load(const std::string& filename);
+    bool save(const std::string& filename) const;
+
+    // Adds a point to every series of the student whose value differs from
+    // its latest point; returns the number of points added. Time never goes
+    // back: throws std::invalid_argument (adding nothing) if `time` is before
+    // the latest point of a series that would change.
+    size_t record(const Student& student, std::time_t time);
+    size_t record(const std::vector<Student>& students, std::time_t time);
+
+    // Points of one series with from <= time <= to, oldest first
+    std::vector<Point> range(const std::string& studentId, int series, std::time_t from, std::time_t to) const;
+
+    // Students by how much a series rose from `from` to `to`, largest rise
+    // first (ties by student ID); students with no score by `to` are skipped
+    std::vector<Change> mostImproved(int series, std::time_t from, std::time_t to, size_t limit) const;
+
+    bool contains(const std::string& studentId) const;
+    size_t studentCount() const { return ids.size(); }
+    size_t pointCount() const;
+    size_t encodedBytes() const;
+
+    // Series numbers: the average, then each subject in GradeUtil order
+    static const int AVERAGE;
+    static int seriesCount();
+    static int seriesForName(const std::string& name);   // -1 when unknown
+    static std::string seriesName(int series);
+
+    // data/students.xlsx -> data/students.history
+    static std::string historyPathFor(const std::string& sourceFilename);
+
+    static const uint32_t BLOCK_POINTS;
+
+private:
+    static const char MAGIC[4];
+    static const uint32_t VERSION;
+
+    struct Block {
+        int64_t firstTime;
+        int32_t firstScore;     // Hundredths
+        uint32_t count;         // Points, including the first
+        uint32_t offset;        // Where the block's deltas start in Series::bytes
+    };
+
+    struct Series {
+        std::vector<Block> blocks;
+        std::string bytes;
+        int64_t lastTime = 0;
+        int32_t lastScore = 0;
+        uint32_t points = 0;
+
+        void append(int64_t time, int32_t score);
+        bool valueAt(int64_t time, int32_t& score) const;
+        template <typename Visit>
+        void decodeFrom(size_t block, Visit visit) const;
+    };
+
+    std::vector<std::string> ids;
+    std::vector<Series> series;     // seriesCount() per student, in `ids` order
+    std::unordered_map<std::string, size_t> indexById;
+
+    static std::vector<int32_t> valuesOf(const Student& student);
+    void checkOrder(const Student& student, int64_t time) const;
+    size_t append(const Student& student, int64_t time);
+};
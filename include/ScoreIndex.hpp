@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Student.hpp"
+#include "StudentView.hpp"
+
+// Sorted secondary indexes on average, GPA, letter grade and every subject score.
+// Range and threshold queries are binary searches that return a StudentView
+// borrowing the matching slice of the index, so no student is copied.
+class ScoreIndex {
+public:
+    // Indexed columns; subject i lives at FIRST_SUBJECT + i
+    static const int AVERAGE;
+    static const int GPA;
+    static const int GRADE;
+    static const int FIRST_SUBJECT;
+
+    // Build and maintenance
+    void rebuild(const std::vector<Student>& students);
+    void addStudent(const Student& student, size_t position);
+    void removeStudent(size_t position);
+    void updateStudent(const Student& student, size_t position);
+
+    // Queries, ascending by key. Ranges are half-open: low <= key < high
+    StudentView range(const std::vector<Student>& students, int column, double low, double high) const;
+    StudentView below(const std::vector<Student>& students, int column, double threshold) const;
+    StudentView atLeast(const std::vector<Student>& students, int column, double threshold) const;
+    StudentView failing(const std::vector<Student>& students) const;
+    StudentView gradeOrWorse(const std::vector<Student>& students, int column, const std::string& grade) const;
+
+    // Column helpers
+    static int columnCount();
+    static int columnForName(const std::string& name);   // -1 when unknown
+    static std::vector<std::string> getColumnNames();
+    static double keyFor(const Student& student, int column);
+    size_t size() const;
+
+private:
+    // One sorted column: keys ascending, ties broken by roster position
+    struct SortedColumn {
+        std::vector<double> keys;
+        std::vector<uint32_t> positions;
+
+        void insert(double key, uint32_t position);
+        void erase(double key, uint32_t position);
+        void shiftFrom(uint32_t position, int delta);
+    };
+
+    std::vector<SortedColumn> columns;
+    std::vector<std::vector<double>> keysAtPosition;
+
+    static std::vector<double> extractKeys(const Student& student);
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <cstdint>
+#include "Student.hpp"
+
+// A ranked hit returned by SearchIndex::search
+struct SearchResult {
+    size_t position;   // Index into the roster vector
+    int score;         // Higher is better
+    int distance;      // Edit distance for fuzzy hits, 0 otherwise
+};
+
+// Inverted index over student names, IDs and emails.
+// Whole terms are kept in an ordered dictionary for exact and prefix lookups,
+// and every term is also split into boundary-padded trigrams for substring
+// and fuzzy (edit-distance bounded) lookups.
+class SearchIndex {
+public:
+    // Build and maintenance
+    void rebuild(const std::vector<Student>& students);
+    void addStudent(const Student& student, size_t position);
+    void removeStudent(size_t position);
+    void updateStudent(const Student& student, size_t position);
+
+    // Queries
+    std::vector<SearchResult> search(const std::string& query, size_t limit = 10) const;
+    size_t size() const;
+
+    // Text helpers
+    static std::string normalize(const std::string& text);
+    static int boundedEditDistance(const std::string& a, const std::string& b, int maxDistance);
+    static bool fuzzyMatches(const std::string& query, const std::string& text);
+
+    // Ranking scores
+    static const int EXACT_SCORE;
+    static const int PREFIX_SCORE;
+    static const int SUBSTRING_SCORE;
+    static const int FUZZY_SCORE;
+
+private:
+    struct Document {
+        size_t position;
+        std::vector<std::string> terms;
+        std::vector<uint32_t> trigrams;
+        bool alive;
+    };
+
+    std::vector<Document> documents;
+    std::vector<uint32_t> documentAtPosition;
+    std::map<std::string, std::vector<uint32_t>> termPostings;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> trigramPostings;
+
+    // Helper methods
+    static std::vector<std::string> extractTerms(const Student& student);
+    static std::vector<uint32_t> extractTrigrams(const std::vector<std::string>& terms, bool padded);
+    static int maxDistanceFor(const std::string& query);
+    void indexDocument(uint32_t docId);
+    void unindexDocument(uint32_t docId);
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <cstdint>
+
+// Sorting of roster positions rather than Student objects.
+// Full sorts are stable; large inputs are sorted in chunks on several threads
+// and merged. A non-zero topK switches to a partial sort that keeps only the
+// first topK positions, with ties kept in roster order.
+class SortUtil {
+public:
+    template <typename Compare>
+    static void sortIndices(std::vector<uint32_t>& indices, Compare before, size_t topK = 0) {
+        if (topK > 0 && topK < indices.size()) {
+            auto stableBefore = [&before](uint32_t a, uint32_t b) {
+                if (before(a, b)) return true;
+                if (before(b, a)) return false;
+                return a < b;
+            };
+            std::partial_sort(indices.begin(), indices.begin() + topK, indices.end(), stableBefore);
+            indices.resize(topK);
+            return;
+        }
+
+        size_t count = indices.size();
+        size_t workers = workerCount();
+        if (count < PARALLEL_THRESHOLD || workers < 2) {
+            std::stable_sort(indices.begin(), indices.end(), before);
+            return;
+        }
+
+        // Sort equal-sized runs in parallel
+        size_t runLength = (count + workers - 1) / workers;
+        std::vector<std::thread> threads;
+        for (size_t start = 0; start < count; start += runLength) {
+            size_t end = std::min(start + runLength, count);
+            threads.emplace_back([&indices, &before, start, end]() {
+                std::stable_sort(indices.begin() + start, indices.begin() + end, before);
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        // Merge neighbouring runs pairwise, each level in parallel
+        for (size_t width = runLength; width < count; width *= 2) {
+            threads.clear();
+            for (size_t start = 0; start + width < count; start += 2 * width) {
+                size_t middle = start + width;
+                size_t end = std::min(start + 2 * width, count);
+                threads.emplace_back([&indices, &before, start, middle, end]() {
+                    std::inplace_merge(indices.begin() + start, indices.begin() + middle,
+                                       indices.begin() + end, before);
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+    }
+
+    static size_t workerCount();
+
+    // Inputs smaller than this are sorted on the calling thread
+    static const size_t PARALLEL_THRESHOLD;
+};
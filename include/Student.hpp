@@ -31,16 +31,16 @@ public:
             const std::string& email, const std::vector<double>& scores);
 
     // Getters
-    std::string getStudentId() const;
+    const std::string& getStudentId() const;
     int getAge() const;
-    std::string getGender() const;
-    std::string getDateOfBirth() const;
-    std::string getEmail() const;
-    std::vector<double> getSubjectScores() const;
+    const std::string& getGender() const;
+    const std::string& getDateOfBirth() const;
+    const std::string& getEmail() const;
+    const std::vector<double>& getSubjectScores() const;
     double getAverageScore() const;
-    std::string getLetterGrade() const;
+    const std::string& getLetterGrade() const;
     double getGpa() const;
-    std::string getRemark() const;
+    const std::string& getRemark() const;
     std::time_t getLastUpdated() const;
 
     // Setters
@@ -50,6 +50,7 @@ public:
     void setDateOfBirth(const std::string& dob);
     void setEmail(const std::string& email);
     void setSubjectScores(const std::vector<double>& scores);
+    void setLastUpdated(std::time_t timestamp);
 
     // Calculation methods
     void calculateAverageScore();
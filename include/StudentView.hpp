@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <iterator>
+#include "Student.hpp"
+
+// Non-owning, read-only window onto the roster.
+// A view is either the whole roster in storage order or a list of roster
+// positions (borrowed from an index, or held by the view for sort/query
+// results). Views borrowed from an index are invalidated when that index
+// or the roster changes.
+class StudentView {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Student;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Student*;
+        using reference = const Student&;
+
+        iterator(const StudentView* view, size_t index) : view(view), index(index) {}
+        reference operator*() const { return (*view)[index]; }
+        pointer operator->() const { return &(*view)[index]; }
+        iterator& operator++() { ++index; return *this; }
+        iterator operator++(int) { iterator copy = *this; ++index; return copy; }
+        iterator& operator+=(difference_type n) { index += n; return *this; }
+        iterator operator+(difference_type n) const { return iterator(view, index + n); }
+        difference_type operator-(const iterator& other) const {
+            return static_cast<difference_type>(index) - static_cast<difference_type>(other.index);
+        }
+        bool operator==(const iterator& other) const { return index == other.index; }
+        bool operator!=(const iterator& other) const { return index != other.index; }
+
+    private:
+        const StudentView* view;
+        size_t index;
+    };
+
+    // Whole roster in storage order
+    explicit StudentView(const std::vector<Student>& students)
+        : roster(&students), first(nullptr), last(nullptr), wholeRoster(true) {}
+
+    // Borrowed slice of positions, typically from an index
+    StudentView(const std::vector<Student>& students, const uint32_t* first, const uint32_t* last)
+        : roster(&students), first(first), last(last), wholeRoster(false) {}
+
+    // Positions produced by a sort or query, kept alive by the view
+    StudentView(const std::vector<Student>& students, std::vector<uint32_t> positions)
+        : roster(&students), wholeRoster(false),
+          ownedPositions(std::make_shared<const std::vector<uint32_t>>(std::move(positions))) {
+        first = ownedPositions->data();
+        last = first + ownedPositions->size();
+    }
+
+    size_t size() const { return isWholeRoster() ? roster->size() : static_cast<size_t>(last - first); }
+    bool empty() const { return size() == 0; }
+
+    const Student& operator[](size_t i) const { return (*roster)[positionAt(i)]; }
+    size_t positionAt(size_t i) const { return isWholeRoster() ? i : first[i]; }
+
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, size()); }
+
+    const std::vector<Student>& getRoster() const { return *roster; }
+
+private:
+    const std::vector<Student>* roster;
+    const uint32_t* first;
+    const uint32_t* last;
+    bool wholeRoster;
+    std::shared_ptr<const std::vector<uint32_t>> ownedPositions;
+
+    bool isWholeRoster() const { return wholeRoster; }
+};
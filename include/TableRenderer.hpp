@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include "Student.hpp"
+#include "StudentView.hpp"
+
+// Forward declaration for tabulate Color
+namespace tabulate {
+    enum class Color;
+}
+
+// Lightweight replacement for tabulate on the hot display paths.
+// Column widths are measured up front, numbers are formatted with to_chars,
+// rows are appended to one reusable buffer and the whole table goes out in a
+// single write. The layout matches tabulate's default borders and padding.
+class TableRenderer {
+public:
+    // Color and weight applied to a whole row
+    struct RowStyle {
+        const char* color;
+        bool bold;
+    };
+
+    // Student list (rows first..last of the view), widened to at least minWidths
+    static void renderStudentRows(const StudentView& students, size_t first, size_t last,
+                                  const std::vector<size_t>& minWidths);
+
+    // Two-column tables such as the detail card and the grade summary; row 0 is the header
+    static void renderTwoColumn(const std::vector<std::pair<std::string, std::string>>& rows,
+                                const std::vector<RowStyle>& styles);
+    static void renderStudentDetails(const Student& student);
+
+    // Precomputed escape sequence for a tabulate color
+    static const char* colorCode(tabulate::Color color);
+
+    static const RowStyle PLAIN;
+
+private:
+    static std::string& buffer();
+    static void flush(std::string& out);
+    static size_t displayWidth(std::string_view text);
+    static void appendBorder(std::string& out, const size_t* widths, size_t columns);
+    static void appendRow(std::string& out, const std::string_view* cells, const size_t* widths,
+                          size_t columns, RowStyle style);
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <string>
+
+// Opt-in Chrome/Perfetto trace recording. While enabled, every metrics scope
+// (SCOREME_TIME_SCOPE) and batch stage is recorded as a complete event with
+// its thread, so overlapping and stalled stages show up in a trace viewer
+// (chrome://tracing or ui.perfetto.dev). Events are buffered per thread and
+// only written out at the end.
+//
+// Set SCOREME_TRACE=path/to/trace.json to trace a whole run.
+class Trace {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    static void start();
+    static void stop();
+    static bool writeFile(const std::string& filename);
+
+    static void startFromEnvironment();    // SCOREME_TRACE, if set
+    static void finishFromEnvironment();   // writes the file started above
+
+    // One finished span on the calling thread; the category is the name up to the first '_'
+    static void record(const std::string& name, TimePoint begin, TimePoint end);
+
+    // Label for the calling thread in the viewer
+    static void setThreadName(const std::string& name);
+
+private:
+    static std::atomic<bool> enabled;
+};
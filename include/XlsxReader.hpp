@@ -0,0 +1,22 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Student.hpp"
+
+// Reads roster workbooks without building xlnt's DOM: the active sheet and
+// the shared strings table are inflated in chunks and pulled through a
+// forward-only XML parser, and each row becomes a Student directly.
+//
+// Only the plain layout is handled (one value per cell, text where the
+// roster has text and numbers where it has numbers, consecutive rows).
+// Anything else returns false with a reason so the caller can fall back to
+// xlnt, which copes with the full format.
+class XlsxReader {
+public:
+    static bool readRoster(const std::string& filename, std::vector<Student>& students, std::string& reason);
+
+    // Row 1 as text, one entry per ExcelUtils::getExcelHeaders() column
+    // (empty where the cell is blank or numeric); the rest of the sheet is
+    // not read
+    static bool readHeaders(const std::string& filename, std::vector<std::string>& headers, std::string& reason);
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Student.hpp"
+
+class ZipWriter;
+
+// Writes the roster workbook (ExcelUtils::getExcelHeaders() columns, bold
+// header row, numeric scores, "Last Updated" as a date-time cell) by emitting
+// the worksheet XML directly instead of building xlnt's cell and style model.
+// The package is the minimal OOXML set: content types, relationships,
+// workbook, three cell styles, shared strings and one sheet.
+class XlsxWriter {
+public:
+    // Throws std::runtime_error on I/O errors. The workbook is written to
+    // filename + ".tmp" and renamed into place, so a failed write leaves the
+    // previous file untouched.
+    // fastCompression trades file size for save time (backups).
+    static void writeRoster(const std::string& filename, const std::vector<Student>& students,
+                            bool fastCompression = false);
+
+    // The grade report: a title merged over A1:H1 and one summary line per
+    // row from A3, then a blank row and the roster table
+    static void writeReport(const std::string& filename, const std::string& title,
+                            const std::vector<std::string>& summary, const std::vector<Student>& students);
+
+    static const char* const SHEET_NAME;
+    static const char* const REPORT_SHEET_NAME;
+
+private:
+    static void writeWorkbook(const std::string& filename, const char* sheetName, const std::string& title,
+                              const std::vector<std::string>& summary, const std::vector<Student>& students,
+                              int level);
+    // Also writes the shared strings table the sheet refers to
+    static void writeSheet(ZipWriter& zip, const std::string& title, const std::vector<std::string>& summary,
+                           const std::vector<Student>& students);
+};
@@ -0,0 +1,134 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <cstdint>
+
+// Minimal zip container for the xlsx writer: deflated entries, no zip64,
+// no encryption. Entries are streamed, so a large worksheet never has to be
+// held in memory as one string. Each entry is cut into BLOCK_SIZE blocks
+// that are deflated on a pool of worker threads and stitched back into a
+// single deflate stream.
+class ZipWriter {
+public:
+    // Throws std::runtime_error if the file cannot be created. threads = 0
+    // starts one deflate worker per core; 1 deflates on the calling thread.
+    explicit ZipWriter(const std::string& filename, int level = DEFAULT_LEVEL, unsigned threads = 0);
+    ~ZipWriter();
+
+    ZipWriter(const ZipWriter&) = delete;
+    ZipWriter& operator=(const ZipWriter&) = delete;
+
+    // One-shot entry
+    void addFile(const std::string& name, const std::string& data);
+
+    // Streamed entry: beginFile, any number of write calls, endFile
+    void beginFile(const std::string& name);
+    void write(const char* data, size_t size);
+    void write(const std::string& data) { write(data.data(), data.size()); }
+    void endFile();
+
+    // Writes the central directory; throws std::runtime_error on I/O errors
+    void close();
+
+    // zlib's default level 6; FAST_LEVEL (1) is for backups, where the
+    // file is about a third larger but deflate runs three times faster
+    static const int DEFAULT_LEVEL;
+    static const int FAST_LEVEL;
+
+    static const size_t BLOCK_SIZE;
+
+private:
+    struct Entry {
+        std::string name;
+        uint32_t crc = 0;
+        uint32_t compressedSize = 0;
+        uint32_t uncompressedSize = 0;
+        uint32_t localHeaderOffset = 0;
+    };
+    struct Deflater;
+    class BlockDeflater;
+    class Compressor;
+
+    std::ofstream file;
+    std::string filename;
+    int level;
+    unsigned workers;
+    std::vector<Entry> entries;
+    std::unique_ptr<Deflater> deflater;   // Set between beginFile and endFile
+    std::unique_ptr<BlockDeflater> serialDeflater;
+    std::unique_ptr<Compressor> compressor;   // Started by the first block that needs it
+    uint16_t dosTime = 0;
+    uint16_t dosDate = 0;
+    bool closed = false;
+
+    void submitBlock(bool last);
+    void writeBlock();
+    uint32_t position();
+};
+
+// Reads the zip files ZipWriter (or Excel, LibreOffice, xlnt) produces:
+// stored or deflated entries, no zip64, no encryption. The file is mapped
+// read-only (read into a buffer on Windows): the central directory is parsed
+// in place and entries are inflated straight from the mapping, in chunks or
+// whole, so only the parts a caller opens are ever touched.
+//
+// A mapped file must not be rewritten in place (a truncated page faults the
+// reader). Every workbook writer here builds a temp file and renames it over
+// the old one, which leaves an open mapping on the old contents.
+class ZipReader {
+public:
+    // Pull-style reader over one entry; the CRC is checked when the end is reached
+    class EntryReader {
+    public:
+        ~EntryReader();
+        EntryReader(const EntryReader&) = delete;
+        EntryReader& operator=(const EntryReader&) = delete;
+
+        // Returns the number of bytes copied, 0 at the end of the entry
+        size_t read(char* buffer, size_t size);
+
+    private:
+        friend class ZipReader;
+        struct Inflater;
+
+        EntryReader(const ZipReader& archive, const std::string& name);
+        std::string name;
+        std::unique_ptr<Inflater> inflater;
+    };
+
+    // Throws std::runtime_error if the file is missing or not a zip
+    explicit ZipReader(const std::string& filename);
+    ~ZipReader();
+
+    ZipReader(const ZipReader&) = delete;
+    ZipReader& operator=(const ZipReader&) = delete;
+
+    bool contains(const std::string& name) const;
+    // Readers point into the mapping and must not outlive the ZipReader
+    std::unique_ptr<EntryReader> open(const std::string& name) const;
+    std::string readFile(const std::string& name) const;
+
+private:
+    struct Entry {
+        uint16_t method = 0;
+        uint32_t crc = 0;
+        uint32_t compressedSize = 0;
+        uint32_t uncompressedSize = 0;
+        uint32_t localHeaderOffset = 0;
+    };
+
+    std::string filename;
+    const char* data = nullptr;     // The mapped file
+    size_t size = 0;
+#ifdef _WIN32
+    std::string buffer;             // Windows reads the file here instead of mapping it
+#endif
+    std::vector<std::pair<std::string, Entry>> entries;
+
+    void readDirectory();
+    void unmap();
+    const Entry& entry(const std::string& name) const;
+    const char* entryData(const Entry& entry) const;
+};
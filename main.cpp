@@ -2,52 +2,123 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <cstdlib>
+#include <stdexcept>
 #include "Student.hpp"
 #include "Admin.hpp"
 #include "Person.hpp"
 #include "ExcelUtil.hpp"
 #include "MenuUtils.hpp"
+#include "CredentialIndex.hpp"
+#include "RosterCache.hpp"
+#include "BatchCli.hpp"
+#include "RosterServer.hpp"
+#include "RosterClient.hpp"
+#include "SampleDataGenerator.hpp"
+#include "Metrics.hpp"
+#include "Trace.hpp"
+#include "MemoryStats.hpp"
 
 using namespace std;
 
 class ScoreMEApp {
 private:
     vector<Student> registeredStudents;
+    CredentialIndex credentialIndex;
     Admin admin;
+    RosterClient rosterServer{RosterServer::defaultSocketPath()};
+    bool rosterLoaded = false;
+    bool showSplash;
     
 public:
-    ScoreMEApp() {
-        // Initialize with sample student data for login testing
-        initializeStudentAccounts();
+    explicit ScoreMEApp(bool showSplash = true) : showSplash(showSplash) {
+        // The roster is loaded on first login, so the main menu comes up immediately
+        admin.attachCredentialIndex(&credentialIndex);
+    }
+    
+    void ensureRosterLoaded() {
+        if (rosterLoaded) {
+            return;
+        }
+        rosterLoaded = true;
+        loadRoster();
+        credentialIndex.rebuild(registeredStudents);
+        
+        // A running `serve` owns the roster; the local copy is kept for logins only
+        if (rosterServer.connect()) {
+            admin.attachServer(&rosterServer);
+            MenuUtils::printInfo("Using the ScoreME server on " + RosterServer::defaultSocketPath() +
+                                 "; menu edits are sent to it.");
+        }
+    }
+    
+    void loadRoster() {
+        const string studentsFile = "data/students.xlsx";
+        const string cacheFile = RosterCache::cachePathFor(studentsFile);
+        
+        // Cache at least as new as the workbook: no xlsx parsing at all
+        if (RosterCache::isFresh(cacheFile, studentsFile) && RosterCache::load(cacheFile, registeredStudents)) {
+            return;
+        }
+        
+        // Workbook only: load it and carry login credentials over from an older cache
+        if (ExcelUtils::fileExists(studentsFile)) {
+            // Refuse to run on a roster that failed to read: the next save would overwrite the workbook
+            string error;
+            if (!ExcelUtils::readStudents(studentsFile, registeredStudents, error)) {
+                throw runtime_error("cannot load the roster, " + error +
+                                    ". Restore it from data/backups before starting again.");
+            }
+            
+            vector<Student> cached;
+            if (RosterCache::load(cacheFile, cached)) {
+                RosterCache::restoreCredentials(registeredStudents, cached);
+            }
+            applyDemoCredentials();
+            RosterCache::save(cacheFile, registeredStudents);
+            return;
+        }
         
-        // Create sample Excel files with data
+        // First run: nothing on disk yet
+        initializeStudentAccounts();
         createSampleExcelFiles();
+        RosterCache::save(cacheFile, registeredStudents);
     }
     
     void initializeStudentAccounts() {
         // Create some student accounts with login credentials
         registeredStudents = Student::createSampleData();
+        applyDemoCredentials();
+    }
+    
+    // Set login credentials for the first few sample students for testing
+    void applyDemoCredentials() {
+        const vector<vector<string>> demoAccounts = {
+            {"STU001", "john.smith", "pass123"},
+            {"STU002", "emily.johnson", "pass456"},
+            {"STU003", "michael.brown", "pass789"}
+        };
         
-        // Set login credentials for first few students for testing
-        if (registeredStudents.size() >= 3) {
-            registeredStudents[0].setUsername("john.smith");
-            registeredStudents[0].setPassword("pass123");
-            
-            registeredStudents[1].setUsername("emily.johnson");
-            registeredStudents[1].setPassword("pass456");
-            
-            registeredStudents[2].setUsername("michael.brown");
-            registeredStudents[2].setPassword("pass789");
+        for (const auto& account : demoAccounts) {
+            for (auto& student : registeredStudents) {
+                if (student.getStudentId() == account[0] && student.getUsername().empty()) {
+                    student.setUsername(account[1]);
+                    student.setPassword(account[2]);
+                    break;
+                }
+            }
         }
     }
     
     void createSampleExcelFiles() {
         try {
             // Create sample Excel files with student data
-            ExcelUtils::writeExcel("data/students.xlsx", registeredStudents);
-            ExcelUtils::writeExcel("data/persons.xlsx", registeredStudents);
-            
-            cout << "Sample Excel files created successfully!" << endl;
+            if (ExcelUtils::writeExcel("data/students.xlsx", registeredStudents) &&
+                ExcelUtils::writeExcel("data/persons.xlsx", registeredStudents)) {
+                cout << "Sample Excel files created successfully!" << endl;
+            } else {
+                cerr << "Error creating sample Excel files in data/" << endl;
+            }
         }
         catch (const exception& e) {
             cerr << "Error creating sample Excel files: " << e.what() << endl;
@@ -55,7 +126,7 @@ public:
     }
     
     void run() {
-        MenuUtils::printWelcome();
+        MenuUtils::printWelcome(showSplash);
         
         int choice;
         do {
@@ -80,11 +151,18 @@ public:
             }
             
         } while (choice != 3);
+        
+        // Keep the cache (with any new credentials) in step for the next start
+        if (rosterLoaded) {
+            RosterCache::save(RosterCache::cachePathFor("data/students.xlsx"), registeredStudents);
+            MemoryStats::printReportFromEnvironment(&registeredStudents);
+        }
     }
     
 private:
     void handleAdminLogin() {
         MenuUtils::clearScreen();
+        ensureRosterLoaded();
         
         if (admin.login()) {
             // FIXED: Use showMenuWithData() method instead of showMenu()
@@ -97,18 +175,13 @@ private:
     void handleStudentLogin() {
         MenuUtils::clearScreen();
         MenuUtils::printHeader("STUDENT LOGIN");
+        ensureRosterLoaded();
         
         string username = MenuUtils::getStringInput("Username: ");
         string password = MenuUtils::getHiddenInput("Password: ");
         
-        // Find student with matching credentials
-        Student* loggedInStudent = nullptr;
-        for (auto& student : registeredStudents) {
-            if (student.validateCredentials(username, password)) {
-                loggedInStudent = &student;
-                break;
-            }
-        }
+        // Single keyed probe into the login index
+        Student* loggedInStudent = credentialIndex.authenticate(registeredStudents, username, password);
         
         if (loggedInStudent) {
             MenuUtils::printSuccess("Login successful! Welcome, " + loggedInStudent->getName() + "!");
@@ -124,25 +197,58 @@ private:
 void createSampleDataFiles() {
     try {
         auto students = Student::createSampleData();
-        ExcelUtils::writeExcel("data/students.xlsx", students);
-        ExcelUtils::writeExcel("data/persons.xlsx", students);
-        cout << "Sample Excel files created successfully in data/ directory!" << endl;
+        if (ExcelUtils::writeExcel("data/students.xlsx", students) &&
+            ExcelUtils::writeExcel("data/persons.xlsx", students)) {
+            cout << "Sample Excel files created successfully in data/ directory!" << endl;
+        } else {
+            cerr << "Error creating sample files in data/" << endl;
+        }
     }
     catch (const exception& e) {
         cerr << "Error creating sample files: " << e.what() << endl;
     }
 }
 
-int main(int argc, char* argv[]) {
-    
+int runApplication(int argc, char* argv[]) {
     try {
         // Check if we're being called to create sample data
         if (argc > 1 && string(argv[1]) == "--create-sample-data") {
+            // With a count: seeded synthetic roster of that size
+            if (argc > 2) {
+                return SampleDataGenerator::run(argc, argv);
+            }
             createSampleDataFiles();
             return 0;
         }
         
-        ScoreMEApp app;
+        // Headless subcommands for scripted pipelines (--query kept as an alias of query)
+        if (argc > 1 && string(argv[1]) == "--query") {
+            argv[1] = const_cast<char*>("query");
+        }
+        if (argc > 1 && BatchCli::isSubcommand(argv[1])) {
+            return BatchCli::run(argc, argv);
+        }
+        // Resident server and its thin client
+        if (argc > 1 && string(argv[1]) == "serve") {
+            return RosterServer::run(argc, argv);
+        }
+        if (argc > 1 && string(argv[1]) == "client") {
+            return RosterClient::run(argc, argv);
+        }
+        if (argc > 1 && (string(argv[1]) == "--help" || string(argv[1]) == "-h")) {
+            BatchCli::printUsage(cout);
+            return 0;
+        }
+        
+        // Skip the intro animation with --no-splash, SCOREME_NO_SPLASH or when output is not a terminal
+        bool showSplash = MenuUtils::isInteractiveTerminal() && !getenv("SCOREME_NO_SPLASH");
+        for (int i = 1; i < argc; ++i) {
+            if (string(argv[i]) == "--no-splash") {
+                showSplash = false;
+            }
+        }
+        
+        ScoreMEApp app(showSplash);
         app.run();
     } catch (const exception& e) {
         MenuUtils::printError("An error occurred: " + string(e.what()));
@@ -150,4 +256,15 @@ int main(int argc, char* argv[]) {
     }
     
     return 0;
-}
\ No newline at end of file
+}
+
+int main(int argc, char* argv[]) {
+    Trace::startFromEnvironment();
+    int status = runApplication(argc, argv);
+    
+    // SCOREME_METRICS_FILE / SCOREME_TRACE / SCOREME_MEMORY_REPORT describe this run
+    Metrics::writeFileFromEnvironment();
+    Trace::finishFromEnvironment();
+    MemoryStats::printReportFromEnvironment(nullptr);
+    return status;
+}
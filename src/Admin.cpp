@@ -2,13 +2,22 @@
 #include "MenuUtils.hpp"
 #include "ExcelUtil.hpp"
 #include "GradeUtil.hpp"
+#include "QueryEngine.hpp"
+#include "StudentView.hpp"
+#include "Metrics.hpp"
+#include "MemoryStats.hpp"
 #include <iostream>
 #include <algorithm>
 #include <fstream>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <sstream>
 
 // Static member definitions
 const std::string Admin::DEFAULT_ADMIN_USERNAME = "admin";
 const std::string Admin::DEFAULT_ADMIN_PASSWORD = "admin123";
+const std::string Admin::ROSTER_FILE = "data/students.xlsx";
 
 // Constructors
 Admin::Admin() : Person(DEFAULT_ADMIN_USERNAME, DEFAULT_ADMIN_PASSWORD, "Administrator") {}
@@ -78,18 +87,19 @@ void Admin::showMenu() {
 
 void Admin::showMenuWithData(std::vector<Student>& students) {
     int choice;
+    syncIndexes(students);
     
     do {
         MenuUtils::clearScreen();
         MenuUtils::printAdminMenu();
-        choice = MenuUtils::getMenuChoice(6);
+        choice = MenuUtils::getMenuChoice(8);
         
         switch (choice) {
             case 1:
                 manageStudents(students);
                 break;
             case 2:
-                importExcelData(students, "data/students.xlsx");
+                importExcelData(students, ROSTER_FILE);
                 MenuUtils::pauseScreen();
                 break;
             case 3:
@@ -101,25 +111,91 @@ void Admin::showMenuWithData(std::vector<Student>& students) {
                 MenuUtils::pauseScreen();
                 break;
             case 5:
+                runQuery(students);
+                MenuUtils::pauseScreen();
+                break;
+            case 6:
+                showPerformanceStats(students);
+                MenuUtils::pauseScreen();
+                break;
+            case 7:
                 MenuUtils::printInfo("Signing out from admin dashboard...");
                 return;
-            case 6:
+            case 8:
                 MenuUtils::printInfo("Returning to main menu...");
                 return;
         }
         
-        if (choice != 5 && choice != 6) {
+        if (choice != 7 && choice != 8) {
             if (!MenuUtils::askContinue()) {
                 break;
             }
         }
-    } while (choice != 5 && choice != 6);
+    } while (choice != 7 && choice != 8);
 }
 
 std::string Admin::getRole() const {
     return "Administrator";
 }
 
+void Admin::attachCredentialIndex(CredentialIndex* index) {
+    credentialIndex = index;
+}
+
+void Admin::attachServer(RosterClient* client) {
+    server = client;
+}
+
+bool Admin::refuseWhileServed() const {
+    if (!server) {
+        return false;
+    }
+    MenuUtils::printWarning("A ScoreME server holds the roster and cannot make this change; "
+                            "stop it first (`ScoreME_Generator client shutdown`).");
+    return true;
+}
+
+// While served, an edit goes to the server first; false (after saying why) if it refused
+bool Admin::forwardField(const std::string& id, const std::string& field, const std::string& value) {
+    if (!server) {
+        return true;
+    }
+    try {
+        server->setField(id, field, value);
+        return true;
+    }
+    catch (const std::exception& e) {
+        MenuUtils::printError("Server error: " + std::string(e.what()));
+        return false;
+    }
+}
+
+bool Admin::forwardScores(const std::string& id, const std::vector<double>& scores) {
+    if (!server) {
+        return true;
+    }
+    std::vector<std::string> subjects = GradeUtil::getSubjectNames();
+    try {
+        for (size_t i = 0; i < subjects.size() && i < scores.size(); ++i) {
+            server->setScore(id, subjects[i], scores[i]);
+        }
+        return true;
+    }
+    catch (const std::exception& e) {
+        MenuUtils::printError("Server error: " + std::string(e.what()));
+        return false;
+    }
+}
+
+void Admin::showServerResult(const std::string& query) {
+    try {
+        MenuUtils::displayQueryResult(server->query(query));
+    }
+    catch (const std::exception& e) {
+        MenuUtils::printError("Server error: " + std::string(e.what()));
+    }
+}
+
 // Admin-specific methods
 void Admin::manageStudents(std::vector<Student>& students) {
     int choice;
@@ -135,11 +211,12 @@ void Admin::manageStudents(std::vector<Student>& students) {
             "Search Student",
             "Show Failing Students",
             "Sort Students by Score",
+            "Find Students by Score Range",
             "Back to Admin Dashboard"
         };
         
         MenuUtils::printMenu(studentMenu);
-        choice = MenuUtils::getMenuChoice(8);
+        choice = MenuUtils::getMenuChoice(9);
         
         switch (choice) {
             case 1:
@@ -164,17 +241,24 @@ void Admin::manageStudents(std::vector<Student>& students) {
                 sortStudentsByScore(students);
                 break;
             case 8:
+                findStudentsByScoreRange(students);
+                break;
+            case 9:
                 return;
         }
         
-        if (choice != 8) {
+        if (choice != 9) {
             MenuUtils::pauseScreen();
         }
-    } while (choice != 8);
+    } while (choice != 9);
 }
 
 void Admin::viewAllStudents(const std::vector<Student>& students) {
     MenuUtils::printHeader("ALL STUDENTS");
+    if (server) {
+        showServerResult("");
+        return;
+    }
     if (students.empty()) {
         MenuUtils::printWarning("No students found!");
         return;
@@ -184,6 +268,9 @@ void Admin::viewAllStudents(const std::vector<Student>& students) {
 
 void Admin::addNewStudent(std::vector<Student>& students) {
     MenuUtils::printHeader("ADD NEW STUDENT");
+    if (refuseWhileServed()) {
+        return;
+    }
     
     std::string studentId = MenuUtils::getStringInput("Student ID: ");
     if (!isValidStudentId(studentId, students)) {
@@ -199,6 +286,10 @@ void Admin::addNewStudent(std::vector<Student>& students) {
     
     // ADD THESE LINES FOR LOGIN CREDENTIALS
     std::string username = MenuUtils::getStringInput("Username for login: ");
+    if (credentialIndex && credentialIndex->hasUsername(username)) {
+        MenuUtils::printError("Username is already taken!");
+        return;
+    }
     std::string password = MenuUtils::getStringInput("Password for login: ");
     
     int age = MenuUtils::getIntInput("Age: ");
@@ -220,17 +311,22 @@ void Admin::addNewStudent(std::vector<Student>& students) {
     
     // CREATE STUDENT WITH LOGIN CREDENTIALS
     students.emplace_back(username, password, studentId, name, age, gender, dob, email, scores);
+    onStudentAdded(students, students.size() - 1);
     MenuUtils::printSuccess("Student added successfully!");
     MenuUtils::printInfo("Login credentials - Username: " + username + ", Password: " + password);
     
     // Save updated data to Excel
     try {
-        ExcelUtils::writeExcel("data/students.xlsx", students);
-        MenuUtils::printInfo("Data saved to Excel file.");
+        if (ExcelUtils::writeExcel(ROSTER_FILE, students)) {
+            MenuUtils::printInfo("Data saved to Excel file.");
+        } else {
+            MenuUtils::printError("Student added but failed to save to " + ROSTER_FILE);
+        }
     }
     catch (const std::exception& e) {
-        MenuUtils::printWarning("Student added but failed to save to Excel: " + std::string(e.what()));
+        MenuUtils::printError("Student added but failed to save to Excel: " + std::string(e.what()));
     }
+    recordScoreHistory(students.back());
 }
 
 void Admin::editStudentInfo(std::vector<Student>& students) {
@@ -243,6 +339,7 @@ void Admin::editStudentInfo(std::vector<Student>& students) {
         MenuUtils::printError("Student not found!");
         return;
     }
+    size_t position = static_cast<size_t>(student - students.data());
     
     MenuUtils::printInfo("Current student info:");
     MenuUtils::displayStudentDetails(*student);
@@ -254,35 +351,52 @@ void Admin::editStudentInfo(std::vector<Student>& students) {
         "Edit Date of Birth",
         "Edit Email",
         "Edit Scores",
+        "Edit Username",
+        "Edit Password",
         "Cancel"
     };
     
     MenuUtils::printMenu(editMenu);
-    int choice = MenuUtils::getMenuChoice(7);
+    int choice = MenuUtils::getMenuChoice(9);
     
     switch (choice) {
         case 1: {
             std::string newName = MenuUtils::getStringInput("New name: ");
+            if (!forwardField(searchId, "name", newName)) {
+                return;
+            }
             student->setName(newName);
             break;
         }
         case 2: {
             int newAge = MenuUtils::getIntInput("New age: ");
+            if (!forwardField(searchId, "age", std::to_string(newAge))) {
+                return;
+            }
             student->setAge(newAge);
             break;
         }
         case 3: {
             std::string newGender = MenuUtils::getStringInput("New gender: ");
+            if (!forwardField(searchId, "gender", newGender)) {
+                return;
+            }
             student->setGender(newGender);
             break;
         }
         case 4: {
             std::string newDob = MenuUtils::getStringInput("New date of birth (YYYY-MM-DD): ");
+            if (!forwardField(searchId, "dob", newDob)) {
+                return;
+            }
             student->setDateOfBirth(newDob);
             break;
         }
         case 5: {
             std::string newEmail = MenuUtils::getStringInput("New email: ");
+            if (!forwardField(searchId, "email", newEmail)) {
+                return;
+            }
             student->setEmail(newEmail);
             break;
         }
@@ -297,29 +411,75 @@ void Admin::editStudentInfo(std::vector<Student>& students) {
                     i--; // Retry current subject
                 }
             }
+            if (!forwardScores(searchId, newScores)) {
+                return;
+            }
             student->setSubjectScores(newScores);
             break;
         }
-        case 7:
+        case 7: {
+            if (refuseWhileServed()) {
+                return;
+            }
+            std::string oldUsername = student->getUsername();
+            std::string newUsername = MenuUtils::getStringInput("New username: ");
+            if (newUsername != oldUsername && credentialIndex && credentialIndex->hasUsername(newUsername)) {
+                MenuUtils::printError("Username is already taken!");
+                return;
+            }
+            student->setUsername(newUsername);
+            
+            if (credentialIndex) {
+                credentialIndex->updateUsername(oldUsername, *student, position);
+            }
+            break;
+        }
+        case 8: {
+            if (refuseWhileServed()) {
+                return;
+            }
+            std::string newPassword = MenuUtils::getStringInput("New password: ");
+            student->setPassword(newPassword);
+            if (credentialIndex) {
+                credentialIndex->updatePassword(student->getUsername(), position, newPassword);
+            }
+            break;
+        }
+        case 9:
             return;
     }
     
-    if (choice != 7) {
+    if (choice != 9) {
+        onStudentEdited(students, position);
         MenuUtils::printSuccess("Student information updated successfully!");
         
-        // Save updated data to Excel
-        try {
-            ExcelUtils::writeExcel("data/students.xlsx", students);
-            MenuUtils::printInfo("Data saved to Excel file.");
+        if (server) {
+            // The server owns the workbook; its next save writes the edit
+            MenuUtils::printInfo("Edit sent to the ScoreME server.");
+        } else {
+            // Save updated data to Excel
+            try {
+                if (ExcelUtils::writeExcel(ROSTER_FILE, students)) {
+                    MenuUtils::printInfo("Data saved to Excel file.");
+                } else {
+                    MenuUtils::printError("Student updated but failed to save to " + ROSTER_FILE);
+                }
+            }
+            catch (const std::exception& e) {
+                MenuUtils::printError("Student updated but failed to save to Excel: " + std::string(e.what()));
+            }
         }
-        catch (const std::exception& e) {
-            MenuUtils::printWarning("Student updated but failed to save to Excel: " + std::string(e.what()));
+        if (choice == 6) {
+            recordScoreHistory(*student);
         }
     }
 }
 
 void Admin::deleteStudent(std::vector<Student>& students) {
     MenuUtils::printHeader("DELETE STUDENT");
+    if (refuseWhileServed()) {
+        return;
+    }
     
     std::string searchId = MenuUtils::getStringInput("Enter Student ID to delete: ");
     auto it = std::find_if(students.begin(), students.end(),
@@ -331,16 +491,21 @@ void Admin::deleteStudent(std::vector<Student>& students) {
         
         std::string confirm = MenuUtils::getStringInput("Are you sure you want to delete this student? (yes/no): ");
         if (confirm == "yes" || confirm == "y" || confirm == "Y") {
+            size_t position = static_cast<size_t>(it - students.begin());
             students.erase(it);
+            onStudentRemoved(position);
             MenuUtils::printSuccess("Student deleted successfully!");
             
             // Save updated data to Excel
             try {
-                ExcelUtils::writeExcel("data/students.xlsx", students);
-                MenuUtils::printInfo("Data saved to Excel file.");
+                if (ExcelUtils::writeExcel(ROSTER_FILE, students)) {
+                    MenuUtils::printInfo("Data saved to Excel file.");
+                } else {
+                    MenuUtils::printError("Student deleted but failed to save to " + ROSTER_FILE);
+                }
             }
             catch (const std::exception& e) {
-                MenuUtils::printWarning("Student deleted but failed to save to Excel: " + std::string(e.what()));
+                MenuUtils::printError("Student deleted but failed to save to Excel: " + std::string(e.what()));
             }
         } else {
             MenuUtils::printInfo("Deletion cancelled.");
@@ -353,32 +518,68 @@ void Admin::deleteStudent(std::vector<Student>& students) {
 void Admin::searchStudent(const std::vector<Student>& students) {
     MenuUtils::printHeader("SEARCH STUDENT");
     
-    std::string searchTerm = MenuUtils::getStringInput("Enter Student ID or Name: ");
-    bool found = false;
+    std::string searchTerm = MenuUtils::getStringInput("Enter Student ID, Name or Email (partial or misspelled is fine): ");
     
-    for (const auto& student : students) {
-        if (student.getStudentId() == searchTerm || student.getName() == searchTerm) {
-            MenuUtils::displayStudentDetails(student);
-            found = true;
-            break;
+    if (server) {
+        try {
+            QueryResult hits = server->search(searchTerm, 10);
+            if (hits.rows.empty()) {
+                MenuUtils::printError("Student not found!");
+            } else {
+                MenuUtils::displayQueryResult(hits);
+            }
+        }
+        catch (const std::exception& e) {
+            MenuUtils::printError("Server error: " + std::string(e.what()));
         }
+        return;
+    }
+    
+    std::vector<SearchResult> results;
+    {
+        SCOREME_TIME_SCOPE("admin_search");
+        syncIndexes(students);
+        results = searchIndex.search(searchTerm, 10);
     }
     
-    if (!found) {
+    if (results.empty()) {
         MenuUtils::printError("Student not found!");
+        return;
+    }
+    
+    // A single exact hit goes straight to the detail view
+    bool singleExact = results[0].score == SearchIndex::EXACT_SCORE &&
+                       (results.size() == 1 || results[1].score < SearchIndex::EXACT_SCORE);
+    if (singleExact) {
+        MenuUtils::displayStudentDetails(students[results[0].position]);
+        return;
     }
+    
+    std::vector<Student> matches;
+    matches.reserve(results.size());
+    for (const auto& result : results) {
+        matches.push_back(students[result.position]);
+    }
+    
+    MenuUtils::printInfo("Top " + std::to_string(matches.size()) + " matches:");
+    MenuUtils::displayTable(matches);
+    MenuUtils::displayStudentDetails(matches.front());
 }
 
 void Admin::showFailingStudents(const std::vector<Student>& students) {
     MenuUtils::printHeader("FAILING STUDENTS");
-    
-    std::vector<Student> failingStudents;
-    for (const auto& student : students) {
-        if (!student.hasPassingGrade()) {
-            failingStudents.push_back(student);
-        }
+    if (server) {
+        std::ostringstream query;
+        query << "where avg < " << GradeUtil::PASSING_THRESHOLD << " order by avg";
+        showServerResult(query.str());
+        return;
     }
     
+    // Straight from the average index, lowest first, without copying records
+    SCOREME_TIME_SCOPE("admin_failing");
+    syncIndexes(students);
+    StudentView failingStudents = scoreIndex.failing(students);
+    
     if (failingStudents.empty()) {
         MenuUtils::printSuccess("No failing students found!");
     } else {
@@ -386,41 +587,237 @@ void Admin::showFailingStudents(const std::vector<Student>& students) {
     }
 }
 
+void Admin::findStudentsByScoreRange(const std::vector<Student>& students) {
+    MenuUtils::printHeader("FIND STUDENTS BY SCORE RANGE");
+    
+    std::vector<std::string> columnNames = ScoreIndex::getColumnNames();
+    MenuUtils::printMenu(columnNames);
+    int column = MenuUtils::getMenuChoice(static_cast<int>(columnNames.size())) - 1;
+    
+    std::vector<std::string> modes = {
+        "Between two values",
+        "Grade or worse"
+    };
+    MenuUtils::printMenu(modes);
+    int mode = MenuUtils::getMenuChoice(2);
+    
+    if (server) {
+        // Same bounds as the local index, as a query over the server's roster
+        std::string name = columnNames[column];
+        std::replace(name.begin(), name.end(), ' ', '_');
+        std::ostringstream query;
+        if (mode == 1) {
+            double low = MenuUtils::getDoubleInput("From (inclusive): ");
+            double high = MenuUtils::getDoubleInput("To (inclusive): ");
+            if (low > high) {
+                std::swap(low, high);
+            }
+            query << "where " << name << " >= " << low << " and " << name << " <= " << high;
+        } else {
+            std::string grade = MenuUtils::getStringInput("Grade (A-F): ");
+            if (grade.empty() || std::string("ABCDEFabcdef").find(grade[0]) == std::string::npos) {
+                MenuUtils::printError("Invalid grade!");
+                return;
+            }
+            grade = std::string(1, static_cast<char>(std::toupper(static_cast<unsigned char>(grade[0]))));
+            if (column == ScoreIndex::GRADE) {
+                query << "where grade <= '" << grade << "'";
+            } else if (column == ScoreIndex::GPA) {
+                query << "where gpa <= " << GradeUtil::calculateGpa(GradeUtil::getGradeLowerBound(grade));
+            } else {
+                query << "where " << name << " < " << GradeUtil::getGradeUpperBound(grade);
+            }
+        }
+        query << " order by " << name;
+        showServerResult(query.str());
+        return;
+    }
+    
+    syncIndexes(students);
+    StudentView matches(students, std::vector<uint32_t>());
+    
+    if (mode == 1) {
+        double low = MenuUtils::getDoubleInput("From (inclusive): ");
+        double high = MenuUtils::getDoubleInput("To (inclusive): ");
+        if (low > high) {
+            std::swap(low, high);
+        }
+        SCOREME_TIME_SCOPE("admin_score_range");
+        matches = scoreIndex.range(students, column, low,
+                                   std::nextafter(high, std::numeric_limits<double>::infinity()));
+    } else {
+        std::string grade = MenuUtils::getStringInput("Grade (A-F): ");
+        if (grade.empty() || std::string("ABCDEFabcdef").find(grade[0]) == std::string::npos) {
+            MenuUtils::printError("Invalid grade!");
+            return;
+        }
+        grade = std::string(1, static_cast<char>(std::toupper(static_cast<unsigned char>(grade[0]))));
+        SCOREME_TIME_SCOPE("admin_score_range");
+        matches = scoreIndex.gradeOrWorse(students, column, grade);
+    }
+    
+    if (matches.empty()) {
+        MenuUtils::printWarning("No students in that range.");
+        return;
+    }
+    
+    MenuUtils::printInfo(std::to_string(matches.size()) + " students found (" + columnNames[column] + ", ascending):");
+    MenuUtils::displayTable(matches);
+}
+
 void Admin::sortStudentsByScore(std::vector<Student>& students) {
     MenuUtils::printHeader("SORT STUDENTS BY SCORE");
     
-    std::string order = MenuUtils::getStringInput("Sort order (asc/desc): ");
+    MenuUtils::printInfo("Sort keys, e.g. 'grade desc, avg desc, name' (empty = avg desc)");
+    std::string spec = MenuUtils::getStringInput("Sort by: ");
+    if (spec.empty()) {
+        spec = "avg desc";
+    }
     
-    if (order == "asc") {
-        std::sort(students.begin(), students.end(),
-            [](const Student& a, const Student& b) {
-                return a.getAverageScore() < b.getAverageScore();
-            });
-    } else {
-        std::sort(students.begin(), students.end(),
-            [](const Student& a, const Student& b) {
-                return a.getAverageScore() > b.getAverageScore();
-            });
+    std::vector<CompiledQuery::SortKey> keys;
+    try {
+        keys = QueryEngine::parseSortKeys(spec);
     }
+    catch (const std::exception& e) {
+        MenuUtils::printError("Invalid sort keys: " + std::string(e.what()));
+        return;
+    }
+    
+    int topK = MenuUtils::getIntInput("Show only the top N students (0 = all): ");
+    if (topK < 0) {
+        topK = 0;
+    }
+    
+    // The server's roster keeps its own order; only show the ranking
+    if (server) {
+        showServerResult("order by " + spec + (topK > 0 ? " limit " + std::to_string(topK) : ""));
+        return;
+    }
+    
+    // Sort a permutation of positions; the roster itself is left alone
+    std::vector<uint32_t> order;
+    {
+        SCOREME_TIME_SCOPE("admin_sort");
+        order = QueryEngine::sortedPositions(students, keys, static_cast<size_t>(topK));
+    }
+    StudentView sorted(students, order);
     
     MenuUtils::printSuccess("Students sorted successfully!");
-    MenuUtils::displayTable(students);
+    MenuUtils::displayTable(sorted);
+    
+    if (topK != 0 && static_cast<size_t>(topK) < students.size()) {
+        return;  // A partial ranking cannot become the stored order
+    }
+    
+    std::string persist = MenuUtils::getStringInput("Save this order to the roster and Excel file? (yes/no): ");
+    if (persist != "yes" && persist != "y" && persist != "Y") {
+        MenuUtils::printInfo("Stored order left unchanged.");
+        return;
+    }
+    
+    std::vector<Student> reordered;
+    reordered.reserve(students.size());
+    for (uint32_t position : order) {
+        reordered.push_back(std::move(students[position]));
+    }
+    students.swap(reordered);
+    {
+        SCOREME_TIME_SCOPE("admin_reindex");
+        onRosterReordered(students);
+    }
     
     // Save sorted data to Excel
     try {
-        ExcelUtils::writeExcel("data/students.xlsx", students);
-        MenuUtils::printInfo("Sorted data saved to Excel file.");
+        if (ExcelUtils::writeExcel(ROSTER_FILE, students)) {
+            MenuUtils::printInfo("Sorted data saved to Excel file.");
+        } else {
+            MenuUtils::printError("Students sorted but failed to save to " + ROSTER_FILE);
+        }
     }
     catch (const std::exception& e) {
-        MenuUtils::printWarning("Students sorted but failed to save to Excel: " + std::string(e.what()));
+        MenuUtils::printError("Students sorted but failed to save to Excel: " + std::string(e.what()));
+    }
+}
+
+void Admin::runQuery(const std::vector<Student>& students) {
+    MenuUtils::printHeader("RUN QUERY");
+    MenuUtils::printInfo("Example: where avg < 50 and Physics > 70 order by gpa desc limit 100 select id,name,avg");
+    
+    std::string text = MenuUtils::getStringInput("Query: ");
+    
+    if (server) {
+        showServerResult(text);
+        return;
+    }
+    
+    try {
+        QueryResult result;
+        {
+            SCOREME_TIME_SCOPE("admin_query");
+            CompiledQuery query = QueryEngine::compile(text);
+            result = QueryEngine::execute(query, students);
+        }
+        MenuUtils::displayQueryResult(result);
+    }
+    catch (const std::exception& e) {
+        MenuUtils::printError("Query error: " + std::string(e.what()));
+    }
+}
+
+void Admin::showPerformanceStats(const std::vector<Student>& students) {
+    MenuUtils::printHeader("PERFORMANCE STATS");
+    MenuUtils::displayPerformanceStats(Metrics::timerStats(), Metrics::counterStats());
+    
+    std::vector<std::string> actions = {
+        "Write metrics file",
+        "Reset counters",
+        Metrics::isEnabled() ? "Turn metrics off" : "Turn metrics on",
+        "Memory report",
+        "Back"
+    };
+    MenuUtils::printMenu(actions);
+    
+    switch (MenuUtils::getMenuChoice(5)) {
+        case 1: {
+            std::string filename = MenuUtils::getStringInput("File (.json for JSON, otherwise Prometheus text): ");
+            if (filename.empty()) {
+                filename = "data/metrics.prom";
+            }
+            if (Metrics::writeFile(filename)) {
+                MenuUtils::printSuccess("Metrics written to " + filename);
+            } else {
+                MenuUtils::printError("Could not write " + filename);
+            }
+            break;
+        }
+        case 2:
+            Metrics::reset();
+            MenuUtils::printSuccess("Metrics reset.");
+            break;
+        case 3:
+            Metrics::setEnabled(!Metrics::isEnabled());
+            MenuUtils::printInfo(std::string("Metrics are now ") + (Metrics::isEnabled() ? "on." : "off."));
+            break;
+        case 4:
+            MemoryStats::printReport(std::cout, &students);
+            break;
     }
 }
 
 // Data management methods
 void Admin::importExcelData(std::vector<Student>& students, const std::string& filename) {
     MenuUtils::printHeader("IMPORT EXCEL DATA");
+    if (refuseWhileServed()) {
+        return;
+    }
+    SCOREME_TIME_SCOPE("admin_import");
     
+    size_t previousCount = students.size();
     if (ExcelUtils::importStudentData(filename, students)) {
+        SCOREME_TIME_SCOPE("admin_import_index");
+        for (size_t i = previousCount; i < students.size(); ++i) {
+            onStudentAdded(students, i);
+        }
         MenuUtils::printSuccess("Data imported successfully from " + filename + "!");
         MenuUtils::printInfo("Total students now: " + std::to_string(students.size()));
     } else {
@@ -430,10 +827,18 @@ void Admin::importExcelData(std::vector<Student>& students, const std::string& f
 
 void Admin::exportData(const std::vector<Student>& students, const std::string& filename) {
     MenuUtils::printHeader("EXPORT DATA");
+    SCOREME_TIME_SCOPE("admin_export");
     
     try {
-        ExcelUtils::exportGradeReport(filename, students);
-        MenuUtils::printSuccess("Grade report exported successfully to " + filename + "!");
+        if (server) {
+            MenuUtils::printSuccess("Grade report exported successfully to " + server->report(filename) + "!");
+            return;
+        }
+        if (ExcelUtils::exportGradeReport(filename, students)) {
+            MenuUtils::printSuccess("Grade report exported successfully to " + filename + "!");
+        } else {
+            MenuUtils::printError("Failed to export data to " + filename);
+        }
     }
     catch (const std::exception& e) {
         MenuUtils::printError("Failed to export data: " + std::string(e.what()));
@@ -442,10 +847,17 @@ void Admin::exportData(const std::vector<Student>& students, const std::string&
 
 void Admin::backupData(const std::vector<Student>& students) {
     MenuUtils::printHeader("BACKUP DATA");
+    if (refuseWhileServed()) {
+        return;
+    }
+    SCOREME_TIME_SCOPE("admin_backup");
     
     try {
-        ExcelUtils::createBackup("students.xlsx", students);
-        MenuUtils::printSuccess("Data backup created successfully!");
+        if (ExcelUtils::createBackup("students.xlsx", students)) {
+            MenuUtils::printSuccess("Data backup created successfully!");
+        } else {
+            MenuUtils::printError("Failed to create backup!");
+        }
     }
     catch (const std::exception& e) {
         MenuUtils::printError("Failed to create backup: " + std::string(e.what()));
@@ -473,4 +885,68 @@ Student* Admin::findStudentByName(std::vector<Student>& students, const std::str
     auto it = std::find_if(students.begin(), students.end(),
         [&name](const Student& s) { return s.getName() == name; });
     return (it != students.end()) ? &(*it) : nullptr;
-}
\ No newline at end of file
+}
+
+// Index maintenance
+void Admin::syncIndexes(const std::vector<Student>& students) {
+    // Full rebuild only when the roster changed outside this admin session
+    if (searchIndex.size() != students.size()) {
+        SCOREME_TIME_SCOPE("index_rebuild_search");
+        searchIndex.rebuild(students);
+    }
+    if (scoreIndex.size() != students.size()) {
+        SCOREME_TIME_SCOPE("index_rebuild_score");
+        scoreIndex.rebuild(students);
+    }
+}
+
+void Admin::onStudentAdded(const std::vector<Student>& students, size_t position) {
+    MemoryStats::Scope memoryScope(MemoryStats::INDEX);
+    if (credentialIndex) {
+        credentialIndex->addStudent(students[position], position);
+    }
+    searchIndex.addStudent(students[position], position);
+    scoreIndex.addStudent(students[position], position);
+}
+
+void Admin::onStudentRemoved(size_t position) {
+    if (credentialIndex) {
+        credentialIndex->removeStudent(position);
+    }
+    searchIndex.removeStudent(position);
+    scoreIndex.removeStudent(position);
+}
+
+void Admin::onStudentEdited(const std::vector<Student>& students, size_t position) {
+    MemoryStats::Scope memoryScope(MemoryStats::INDEX);
+    searchIndex.updateStudent(students[position], position);
+    scoreIndex.updateStudent(students[position], position);
+}
+
+void Admin::onRosterReordered(const std::vector<Student>& students) {
+    if (credentialIndex) {
+        credentialIndex->rebuild(students);
+    }
+    searchIndex.rebuild(students);
+    scoreIndex.rebuild(students);
+}
+
+void Admin::recordScoreHistory(const Student& student) {
+    std::string path = ScoreHistory::historyPathFor(ROSTER_FILE);
+    try {
+        // A damaged file throws here and stays unloaded, so it is never overwritten
+        if (!scoreHistoryLoaded) {
+            scoreHistory.load(path);
+            scoreHistoryLoaded = true;
+        }
+        if (scoreHistory.record(student, student.getLastUpdated()) == 0) {
+            return;
+        }
+        if (!scoreHistory.save(path)) {
+            MenuUtils::printWarning("Scores saved, but " + path + " could not be written.");
+        }
+    }
+    catch (const std::exception& e) {
+        MenuUtils::printWarning("Scores saved, but the score history was not updated: " + std::string(e.what()));
+    }
+}
@@ -0,0 +1,832 @@
+#include "BatchCli.hpp"
+#include "ExcelUtil.hpp"
+#include "JsonUtil.hpp"
+#include "Metrics.hpp"
+#include "Trace.hpp"
+#include "MenuUtils.hpp"
+#include "PartitionStore.hpp"
+#include "QueryEngine.hpp"
+#include "RosterClient.hpp"
+#include "RosterServer.hpp"
+#include "ScoreHistory.hpp"
+#include "Student.hpp"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace std;
+
+const int BatchCli::EXIT_OK = 0;
+const int BatchCli::EXIT_FAILED = 1;
+const int BatchCli::EXIT_USAGE = 2;
+
+namespace {
+    const string DEFAULT_ROSTER = "data/students.xlsx";
+
+    // Adds the elapsed time of a scope to the report as one stage
+    class StageTimer {
+    public:
+        StageTimer(BatchCli::Report& report, const string& name)
+            : report(report), name(name), start(chrono::steady_clock::now()) {}
+
+        ~StageTimer() {
+            auto end = chrono::steady_clock::now();
+            chrono::duration<double, milli> elapsed = end - start;
+            report.stages.emplace_back(name, elapsed.count());
+            if (Trace::isEnabled()) {
+                Trace::record("batch_" + name, start, end);
+            }
+        }
+
+    private:
+        BatchCli::Report& report;
+        string name;
+        chrono::steady_clock::time_point start;
+    };
+
+    string csvField(const string& value, char separator) {
+        if (value.find_first_of(string(1, separator) + "\"\r\n") == string::npos) {
+            return value;
+        }
+        string quoted = "\"";
+        for (char c : value) {
+            if (c == '"') quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    bool endsWith(const string& text, const string& suffix) {
+        return text.size() >= suffix.size() &&
+               text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // Reads a workbook, failing loudly instead of returning an empty roster
+    bool loadRoster(const string& filename, vector<Student>& students, BatchCli::Report& report) {
+        if (!ExcelUtils::fileExists(filename)) {
+            report.error = "file not found: " + filename;
+            return false;
+        }
+        StageTimer timer(report, "read:" + filename);
+        string error;
+        if (!ExcelUtils::readStudents(filename, students, error)) {
+            report.error = "failed to read " + error;
+            return false;
+        }
+        report.files++;
+        return true;
+    }
+
+    bool usesPartitions(const BatchCli::Arguments& args) {
+        return args.options.count("partition") > 0;
+    }
+
+    PartitionStore openPartitions(const BatchCli::Arguments& args) {
+        return PartitionStore(args.option("partition-dir", PartitionStore::DEFAULT_DIRECTORY));
+    }
+
+    // The roster a command works on: the --partition selection if given, else the workbook
+    bool loadInput(const BatchCli::Arguments& args, const string& filename, vector<Student>& students,
+                   BatchCli::Report& report) {
+        if (!usesPartitions(args)) {
+            return loadRoster(filename, students, report);
+        }
+        PartitionStore store = openPartitions(args);
+        vector<string> names = store.select(args.option("partition", ""));
+        StageTimer timer(report, "read:partitions");
+        students = store.load(names);
+        report.files += names.size();
+        report.counts["partitions"] = names.size();
+        return true;
+    }
+
+    // Next to the roster it tracks: data/students.history, or one for all partitions
+    string historyPath(const BatchCli::Arguments& args, const string& filename) {
+        if (usesPartitions(args)) {
+            return args.option("history", args.option("partition-dir", PartitionStore::DEFAULT_DIRECTORY) + "/scores.history");
+        }
+        return args.option("history", ScoreHistory::historyPathFor(filename));
+    }
+
+    // YYYY-MM-DD as local midnight
+    bool parseDate(const string& text, time_t& time) {
+        tm date{};
+        istringstream in(text);
+        in >> get_time(&date, "%Y-%m-%d");
+        if (in.fail()) {
+            return false;
+        }
+        date.tm_isdst = -1;
+        time = mktime(&date);
+        return time != -1;
+    }
+
+    string formatTime(time_t time) {
+        ostringstream out;
+        out << put_time(localtime(&time), "%Y-%m-%d %H:%M:%S");
+        return out.str();
+    }
+
+    string formatScore(double score, bool sign = false) {
+        ostringstream out;
+        out << fixed << setprecision(2) << (sign ? showpos : noshowpos) << score;
+        return out.str();
+    }
+
+    void writeResult(const QueryResult& result, const string& format) {
+        if (format == "table") {
+            MenuUtils::displayQueryResult(result);
+        }
+        else if (format == "json") {
+            cout << "[";
+            for (size_t r = 0; r < result.rows.size(); ++r) {
+                cout << (r > 0 ? ",{" : "{");
+                for (size_t c = 0; c < result.columns.size(); ++c) {
+                    if (c > 0) cout << ",";
+                    cout << "\"" << JsonUtil::escape(result.columns[c]) << "\":\"" << JsonUtil::escape(result.rows[r][c]) << "\"";
+                }
+                cout << "}";
+            }
+            cout << "]\n";
+        }
+        else {
+            char separator = (format == "tsv") ? '\t' : ',';
+            string out;
+            for (size_t c = 0; c < result.columns.size(); ++c) {
+                if (c > 0) out += separator;
+                out += csvField(result.columns[c], separator);
+            }
+            out += '\n';
+            for (const auto& row : result.rows) {
+                for (size_t c = 0; c < row.size(); ++c) {
+                    if (c > 0) out += separator;
+                    out += csvField(row[c], separator);
+                }
+                out += '\n';
+            }
+            cout << out;
+        }
+        cout.flush();
+    }
+
+    bool isOutputFormat(const string& format) {
+        return format == "csv" || format == "tsv" || format == "json" || format == "table";
+    }
+
+    // A live `serve` process owns its workbook: a file written under it is
+    // overwritten by its next save
+    bool isServed(const string& filename) {
+        RosterClient client(RosterServer::defaultSocketPath());
+        if (!client.connect()) {
+            return false;
+        }
+        try {
+            error_code ec;
+            return filesystem::equivalent(client.rosterFile(), filename, ec);
+        }
+        catch (const exception&) {
+            return false;
+        }
+    }
+
+    bool saveRoster(const string& filename, const vector<Student>& students, BatchCli::Report& report) {
+        if (isServed(filename)) {
+            report.error = filename + " is held by a running ScoreME server; stop it first (client shutdown)";
+            return false;
+        }
+        StageTimer timer(report, "write:" + filename);
+        if (!ExcelUtils::writeExcel(filename, students)) {
+            report.error = "failed to write " + filename;
+            return false;
+        }
+        return true;
+    }
+}
+
+// Entry point
+bool BatchCli::isSubcommand(const std::string& name) {
+    return name == "import" || name == "merge" || name == "regrade" || name == "report" ||
+           name == "export" || name == "query" || name == "backup" || name == "partitions" ||
+           name == "history";
+}
+
+int BatchCli::run(int argc, char* argv[]) {
+    Arguments args = parseArguments(argc, argv);
+
+    Report report;
+    report.command = args.command;
+
+    auto start = chrono::steady_clock::now();
+    int exitCode = EXIT_USAGE;
+
+    // --partition stands in for the workbook argument, except for import; query and
+    // history take theirs after the query text or action (trend: and student ID)
+    size_t inputArguments = 0;
+    if (args.command == "query") inputArguments = 1;
+    if (args.command == "history") inputArguments = !args.positional.empty() && args.positional[0] == "trend" ? 2 : 1;
+    bool conflictingInput = usesPartitions(args) && args.command != "import" &&
+                            (args.command == "merge" || args.positional.size() > inputArguments);
+
+    try {
+        if (conflictingInput) report.error = "--partition cannot be combined with a workbook argument for " + args.command;
+        else if (args.command == "import") exitCode = runImport(args, report);
+        else if (args.command == "merge") exitCode = runMerge(args, report);
+        else if (args.command == "regrade") exitCode = runRegrade(args, report);
+        else if (args.command == "report") exitCode = runReport(args, report);
+        else if (args.command == "export") exitCode = runExport(args, report);
+        else if (args.command == "query") exitCode = runQuery(args, report);
+        else if (args.command == "backup") exitCode = runBackup(args, report);
+        else if (args.command == "partitions") exitCode = runPartitions(args, report);
+        else if (args.command == "history") exitCode = runHistory(args, report);
+        else report.error = "unknown command: " + args.command;
+    }
+    catch (const exception& e) {
+        report.error = e.what();
+        exitCode = EXIT_FAILED;
+    }
+
+    if (exitCode == EXIT_USAGE) {
+        printUsage(cerr);
+    }
+
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+    report.totalMilliseconds = elapsed.count();
+    writeStatus(cerr, report, exitCode);
+    return exitCode;
+}
+
+void BatchCli::printUsage(std::ostream& out) {
+    out << "Usage: ScoreME_Generator <command> [arguments]\n"
+        << "  import <file.xlsx>... [--into data/students.xlsx]   append students (new IDs only)\n"
+        << "  merge <file.xlsx>... --out <file.xlsx>              combine files, later files win per ID\n"
+        << "  regrade [file.xlsx]                                 recompute grades and rewrite the file\n"
+        << "  report [file.xlsx] [--out data/grade_report.xlsx]   write the grade report workbook\n"
+        << "  export [file.xlsx] --out <file.xlsx|file.csv>       copy the roster as xlsx or csv\n"
+        << "  query \"<query>\" [file.xlsx] [--format csv|tsv|json|table]\n"
+        << "  backup [file.xlsx]                                  timestamped copy in data/backups\n"
+        << "  partitions                                          list the partitions in the manifest\n"
+        << "  history record [file.xlsx] [--at YYYY-MM-DD]        add the roster's current scores to its history\n"
+        << "  history trend <student-id> [--subject name] [--from date] [--to date]\n"
+        << "  history improved [--subject average] [--from date] [--to date] [--limit 10]\n"
+        << "      history file: --history, else next to the roster (data/students.history);\n"
+        << "      trend and improved take --format csv|tsv|json|table\n"
+        << "  --partition <name,...|all> [--partition-dir data/partitions]\n"
+        << "      import: the partition to import into (created if new); regrade, report, export,\n"
+        << "      query and backup: work on those partitions instead of a workbook\n"
+        << "  --create-sample-data N [--out file] [--format xlsx|csv|bin] [--seed S] [--failure-rate R]\n"
+        << "  serve [file.xlsx] [--socket data/scoreme.sock]      keep the roster in memory and serve it\n"
+        << "  client [--socket path] [op key=value ...]           talk to a running server\n"
+        << "Exit codes: 0 ok, 1 failed, 2 usage. A JSON status line is written to stderr.\n";
+}
+
+std::string BatchCli::Arguments::option(const std::string& name, const std::string& fallback) const {
+    auto it = options.find(name);
+    return it != options.end() ? it->second : fallback;
+}
+
+BatchCli::Arguments BatchCli::parseArguments(int argc, char* argv[]) {
+    Arguments args;
+    if (argc > 1) {
+        args.command = argv[1];
+    }
+
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg.size() > 2 && arg.compare(0, 2, "--") == 0) {
+            string name = arg.substr(2);
+            size_t equals = name.find('=');
+            if (equals != string::npos) {
+                args.options[name.substr(0, equals)] = name.substr(equals + 1);
+            } else if (i + 1 < argc) {
+                args.options[name] = argv[++i];
+            } else {
+                args.options[name] = "";
+            }
+        } else {
+            args.positional.push_back(arg);
+        }
+    }
+
+    return args;
+}
+
+void BatchCli::writeStatus(std::ostream& out, const Report& report, int exitCode) {
+    // Formatted locally so the caller's stream keeps its own flags
+    ostringstream line;
+    line << fixed << setprecision(3);
+    line << "{\"command\":\"" << JsonUtil::escape(report.command) << "\""
+         << ",\"status\":\"" << (exitCode == EXIT_OK ? "ok" : (exitCode == EXIT_USAGE ? "usage" : "failed")) << "\""
+         << ",\"exit_code\":" << exitCode
+         << ",\"students\":" << report.students
+         << ",\"files\":" << report.files
+         << ",\"elapsed_ms\":" << report.totalMilliseconds
+         << ",\"stages\":{";
+    for (size_t i = 0; i < report.stages.size(); ++i) {
+        if (i > 0) line << ",";
+        line << "\"" << JsonUtil::escape(report.stages[i].first) << "\":" << report.stages[i].second;
+    }
+    line << "},\"counts\":{";
+    size_t index = 0;
+    for (const auto& count : report.counts) {
+        if (index++ > 0) line << ",";
+        line << "\"" << JsonUtil::escape(count.first) << "\":" << count.second;
+    }
+    line << "}";
+    if (!report.error.empty()) {
+        line << ",\"error\":\"" << JsonUtil::escape(report.error) << "\"";
+    }
+    out << line.str() << endl;
+}
+
+// Subcommands
+int BatchCli::runImport(const Arguments& args, Report& report) {
+    if (args.positional.empty()) {
+        report.error = "import needs at least one source file";
+        return EXIT_USAGE;
+    }
+
+    if (usesPartitions(args)) {
+        return runImportIntoPartition(args, report);
+    }
+
+    string target = args.option("into", DEFAULT_ROSTER);
+    vector<Student> roster;
+    if (ExcelUtils::fileExists(target) && !loadRoster(target, roster, report)) {
+        return EXIT_FAILED;
+    }
+
+    unordered_map<string, size_t> known;
+    for (size_t i = 0; i < roster.size(); ++i) {
+        known.emplace(roster[i].getStudentId(), i);
+    }
+
+    for (const auto& source : args.positional) {
+        vector<Student> imported;
+        if (!loadRoster(source, imported, report)) {
+            return EXIT_FAILED;
+        }
+        for (auto& student : imported) {
+            if (known.emplace(student.getStudentId(), roster.size()).second) {
+                roster.push_back(std::move(student));
+                report.counts["imported"]++;
+            } else {
+                report.counts["skipped_duplicates"]++;
+            }
+        }
+    }
+
+    report.students = roster.size();
+    return saveRoster(target, roster, report) ? EXIT_OK : EXIT_FAILED;
+}
+
+int BatchCli::runMerge(const Arguments& args, Report& report) {
+    string output = args.option("out", "");
+    if (args.positional.empty() || output.empty()) {
+        report.error = "merge needs source files and --out";
+        return EXIT_USAGE;
+    }
+
+    vector<Student> merged;
+    unordered_map<string, size_t> byId;
+
+    for (const auto& source : args.positional) {
+        vector<Student> students;
+        if (!loadRoster(source, students, report)) {
+            return EXIT_FAILED;
+        }
+        for (auto& student : students) {
+            auto it = byId.find(student.getStudentId());
+            if (it == byId.end()) {
+                byId.emplace(student.getStudentId(), merged.size());
+                merged.push_back(std::move(student));
+            } else {
+                merged[it->second] = std::move(student);
+                report.counts["replaced"]++;
+            }
+        }
+    }
+
+    report.students = merged.size();
+    return saveRoster(output, merged, report) ? EXIT_OK : EXIT_FAILED;
+}
+
+int BatchCli::runRegrade(const Arguments& args, Report& report) {
+    // Partitions are regraded and rewritten one at a time
+    if (usesPartitions(args)) {
+        PartitionStore store = openPartitions(args);
+        for (const auto& name : store.select(args.option("partition", ""))) {
+            vector<Student> students;
+            {
+                StageTimer timer(report, "read:partition:" + name);
+                students = store.load({name});
+                report.files++;
+            }
+            for (auto& student : students) {
+                student.updateAllGrades();
+            }
+            report.students += students.size();
+            StageTimer timer(report, "write:partition:" + name);
+            if (!store.save(name, students)) {
+                report.error = "failed to write partition " + name;
+                return EXIT_FAILED;
+            }
+        }
+        return EXIT_OK;
+    }
+
+    string filename = args.positional.empty() ? DEFAULT_ROSTER : args.positional[0];
+    vector<Student> students;
+    if (!loadRoster(filename, students, report)) {
+        return EXIT_FAILED;
+    }
+
+    {
+        StageTimer timer(report, "regrade");
+        SCOREME_TIME_SCOPE("grading_batch");
+        for (auto& student : students) {
+            student.updateAllGrades();
+        }
+    }
+
+    report.students = students.size();
+    return saveRoster(filename, students, report) ? EXIT_OK : EXIT_FAILED;
+}
+
+int BatchCli::runReport(const Arguments& args, Report& report) {
+    string filename = args.positional.empty() ? DEFAULT_ROSTER : args.positional[0];
+    string output = args.option("out", "data/grade_report.xlsx");
+
+    vector<Student> students;
+    if (!loadInput(args, filename, students, report)) {
+        return EXIT_FAILED;
+    }
+    report.students = students.size();
+
+    StageTimer timer(report, "report:" + output);
+    if (!ExcelUtils::exportGradeReport(output, students)) {
+        report.error = "failed to write " + output;
+        return EXIT_FAILED;
+    }
+    return EXIT_OK;
+}
+
+int BatchCli::runExport(const Arguments& args, Report& report) {
+    string filename = args.positional.empty() ? DEFAULT_ROSTER : args.positional[0];
+    string output = args.option("out", "");
+    if (output.empty()) {
+        report.error = "export needs --out";
+        return EXIT_USAGE;
+    }
+
+    string format = args.option("format", endsWith(output, ".csv") ? "csv" : "xlsx");
+    if (format != "csv" && format != "xlsx") {
+        report.error = "unknown export format: " + format;
+        return EXIT_USAGE;
+    }
+
+    vector<Student> students;
+    if (!loadInput(args, filename, students, report)) {
+        return EXIT_FAILED;
+    }
+    report.students = students.size();
+
+    if (format == "csv") {
+        StageTimer timer(report, "write:" + output);
+        if (!ExcelUtils::writeCsv(output, students)) {
+            report.error = "failed to write " + output;
+            return EXIT_FAILED;
+        }
+        return EXIT_OK;
+    }
+    return saveRoster(output, students, report) ? EXIT_OK : EXIT_FAILED;
+}
+
+int BatchCli::runQuery(const Arguments& args, Report& report) {
+    if (args.positional.empty()) {
+        report.error = "query needs the query text";
+        return EXIT_USAGE;
+    }
+
+    string format = args.option("format", "csv");
+    if (!isOutputFormat(format)) {
+        report.error = "unknown output format: " + format;
+        return EXIT_USAGE;
+    }
+
+    // Compile before touching the file, so a typo fails fast
+    CompiledQuery query;
+    {
+        StageTimer timer(report, "compile");
+        query = QueryEngine::compile(args.positional[0]);
+    }
+
+    QueryResult result;
+    if (usesPartitions(args)) {
+        result = runQueryPartitions(args, query, report);
+    } else {
+        string filename = args.positional.size() > 1 ? args.positional[1] : DEFAULT_ROSTER;
+        vector<Student> students;
+        if (!loadRoster(filename, students, report)) {
+            return EXIT_FAILED;
+        }
+        StageTimer timer(report, "execute");
+        result = QueryEngine::execute(query, students);
+    }
+    report.students = result.rows.size();
+    report.counts["matched"] = result.matched;
+
+    StageTimer timer(report, "output");
+    writeResult(result, format);
+    return EXIT_OK;
+}
+
+int BatchCli::runBackup(const Arguments& args, Report& report) {
+    // One backup workbook per partition
+    if (usesPartitions(args)) {
+        PartitionStore store = openPartitions(args);
+        for (const auto& name : store.select(args.option("partition", ""))) {
+            vector<Student> students;
+            {
+                StageTimer timer(report, "read:partition:" + name);
+                students = store.load({name});
+                report.files++;
+            }
+            report.students += students.size();
+            StageTimer timer(report, "backup:" + name);
+            if (!ExcelUtils::createBackup(name + ".xlsx", students)) {
+                report.error = "failed to write backup of partition " + name;
+                return EXIT_FAILED;
+            }
+        }
+        return EXIT_OK;
+    }
+
+    string filename = args.positional.empty() ? DEFAULT_ROSTER : args.positional[0];
+    vector<Student> students;
+    if (!loadRoster(filename, students, report)) {
+        return EXIT_FAILED;
+    }
+    report.students = students.size();
+
+    size_t slash = filename.find_last_of("/\\");
+    string baseName = (slash == string::npos) ? filename : filename.substr(slash + 1);
+
+    StageTimer timer(report, "backup");
+    if (!ExcelUtils::createBackup(baseName, students)) {
+        report.error = "failed to write backup";
+        return EXIT_FAILED;
+    }
+    return EXIT_OK;
+}
+
+int BatchCli::runPartitions(const Arguments& args, Report& report) {
+    PartitionStore store = openPartitions(args);
+    cout << "partition\tstudents\tfirst_id\tlast_id\n";
+    for (const auto& partition : store.partitions()) {
+        cout << partition.name << '\t' << partition.students << '\t'
+             << partition.firstId << '\t' << partition.lastId << '\n';
+        report.students += partition.students;
+    }
+    report.counts["partitions"] = store.partitions().size();
+    return EXIT_OK;
+}
+
+int BatchCli::runImportIntoPartition(const Arguments& args, Report& report) {
+    string name = args.option("partition", "");
+    if (!PartitionStore::isValidName(name)) {
+        report.error = "import needs one partition name (letters, digits, '-', '_', '.')";
+        return EXIT_USAGE;
+    }
+    PartitionStore store = openPartitions(args);
+
+    vector<Student> incoming;
+    for (const auto& source : args.positional) {
+        vector<Student> imported;
+        if (!loadRoster(source, imported, report)) {
+            return EXIT_FAILED;
+        }
+        move(imported.begin(), imported.end(), back_inserter(incoming));
+    }
+
+    // Only the target and partitions whose ID range overlaps the new IDs can
+    // hold a duplicate; nothing else is read
+    set<string> touched;
+    if (store.contains(name)) {
+        touched.insert(name);
+    }
+    if (!incoming.empty()) {
+        auto range = minmax_element(incoming.begin(), incoming.end(), [](const Student& a, const Student& b) {
+            return a.getStudentId() < b.getStudentId();
+        });
+        for (const auto& other : store.partitionsForIds(range.first->getStudentId(), range.second->getStudentId())) {
+            touched.insert(other);
+        }
+    }
+
+    vector<Student> roster;
+    unordered_set<string> known;
+    {
+        StageTimer timer(report, "read:partitions");
+        mutex knownMutex;
+        store.scan(vector<string>(touched.begin(), touched.end()),
+                   [&](const PartitionStore::Partition& partition, vector<Student>& students) {
+            lock_guard<mutex> lock(knownMutex);
+            for (const auto& student : students) {
+                known.insert(student.getStudentId());
+            }
+            if (partition.name == name) {
+                roster = std::move(students);
+            }
+        });
+        report.files += touched.size();
+        report.counts["partitions_read"] = touched.size();
+    }
+
+    for (auto& student : incoming) {
+        if (known.insert(student.getStudentId()).second) {
+            roster.push_back(std::move(student));
+            report.counts["imported"]++;
+        } else {
+            report.counts["skipped_duplicates"]++;
+        }
+    }
+
+    report.students = roster.size();
+    StageTimer timer(report, "write:partition:" + name);
+    if (!store.save(name, roster)) {
+        report.error = "failed to write partition " + name;
+        return EXIT_FAILED;
+    }
+    return EXIT_OK;
+}
+
+// Each worker reads a partition and keeps only its query result; the
+// survivors are queried once more for the global order, limit and columns.
+// A partition's own top rows always include its share of the global top
+// rows, so the answer matches querying all partitions as one roster.
+QueryResult BatchCli::runQueryPartitions(const Arguments& args, const CompiledQuery& query, Report& report) {
+    PartitionStore store = openPartitions(args);
+    vector<string> names = store.select(args.option("partition", ""));
+
+    vector<vector<Student>> survivors(names.size());
+    vector<size_t> matched(names.size(), 0);
+    {
+        StageTimer timer(report, "scan:partitions");
+        store.scan(names, [&](const PartitionStore::Partition& partition, vector<Student>& students) {
+            size_t slot = static_cast<size_t>(find(names.begin(), names.end(), partition.name) - names.begin());
+            QueryResult partial = QueryEngine::execute(query, students);
+            matched[slot] = partial.matched;
+            sort(partial.positions.begin(), partial.positions.end());
+            for (uint32_t position : partial.positions) {
+                survivors[slot].push_back(std::move(students[position]));
+            }
+        });
+        report.files += names.size();
+        report.counts["partitions"] = names.size();
+    }
+
+    vector<Student> candidates;
+    size_t totalMatched = 0;
+    for (size_t i = 0; i < names.size(); ++i) {
+        move(survivors[i].begin(), survivors[i].end(), back_inserter(candidates));
+        totalMatched += matched[i];
+    }
+
+    StageTimer timer(report, "execute");
+    QueryResult result = QueryEngine::execute(query, candidates);
+    result.matched = totalMatched;
+    return result;
+}
+
+int BatchCli::runHistory(const Arguments& args, Report& report) {
+    string action = args.positional.empty() ? "" : args.positional[0];
+    if (action != "record" && action != "trend" && action != "improved") {
+        report.error = "history needs record, trend or improved";
+        return EXIT_USAGE;
+    }
+
+    string format = args.option("format", "csv");
+    if (!isOutputFormat(format)) {
+        report.error = "unknown output format: " + format;
+        return EXIT_USAGE;
+    }
+
+    time_t from = numeric_limits<time_t>::min();
+    time_t to = numeric_limits<time_t>::max();
+    time_t at = time(nullptr);
+    if ((args.options.count("from") && !parseDate(args.option("from", ""), from)) ||
+        (args.options.count("to") && !parseDate(args.option("to", ""), to)) ||
+        (args.options.count("at") && !parseDate(args.option("at", ""), at))) {
+        report.error = "dates are YYYY-MM-DD";
+        return EXIT_USAGE;
+    }
+    if (args.options.count("to")) {
+        to += 24 * 60 * 60 - 1;   // Through the end of that day
+    }
+
+    int series = ScoreHistory::AVERAGE;
+    if (args.options.count("subject")) {
+        series = ScoreHistory::seriesForName(args.option("subject", ""));
+        if (series < 0) {
+            report.error = "unknown subject: " + args.option("subject", "");
+            return EXIT_USAGE;
+        }
+    }
+
+    string filename = action == "record" && args.positional.size() > 1 ? args.positional[1] : DEFAULT_ROSTER;
+    string path = historyPath(args, filename);
+    ScoreHistory history;
+    {
+        StageTimer timer(report, "read:" + path);
+        if (history.load(path)) {
+            report.files++;
+        }
+    }
+
+    if (action == "record") {
+        vector<Student> students;
+        if (!loadInput(args, filename, students, report)) {
+            return EXIT_FAILED;
+        }
+        {
+            StageTimer timer(report, "record");
+            report.counts["points_added"] = history.record(students, at);
+        }
+        report.students = students.size();
+        report.counts["points"] = history.pointCount();
+        report.counts["encoded_bytes"] = history.encodedBytes();
+        StageTimer timer(report, "write:" + path);
+        if (!history.save(path)) {
+            report.error = "failed to write " + path;
+            return EXIT_FAILED;
+        }
+        return EXIT_OK;
+    }
+
+    QueryResult result;
+    if (action == "trend") {
+        if (args.positional.size() < 2) {
+            report.error = "history trend needs a student ID";
+            return EXIT_USAGE;
+        }
+        const string& studentId = args.positional[1];
+        if (!history.contains(studentId)) {
+            report.error = "no history for " + studentId;
+            return EXIT_FAILED;
+        }
+
+        StageTimer timer(report, "trend");
+        // Every series unless one was asked for, merged oldest first
+        vector<pair<ScoreHistory::Point, int>> points;
+        int first = args.options.count("subject") ? series : 0;
+        int last = args.options.count("subject") ? series + 1 : ScoreHistory::seriesCount();
+        for (int s = first; s < last; ++s) {
+            for (const auto& point : history.range(studentId, s, from, to)) {
+                points.emplace_back(point, s);
+            }
+        }
+        stable_sort(points.begin(), points.end(), [](const auto& a, const auto& b) {
+            return a.first.time < b.first.time;
+        });
+
+        result.columns = {"time", "subject", "score"};
+        for (const auto& point : points) {
+            result.rows.push_back({formatTime(point.first.time), ScoreHistory::seriesName(point.second),
+                                   formatScore(point.first.score)});
+        }
+        report.students = 1;
+    } else {
+        size_t limit = 10;
+        try {
+            limit = stoul(args.option("limit", "10"));
+        }
+        catch (const exception&) {
+            report.error = "--limit needs a number";
+            return EXIT_USAGE;
+        }
+
+        StageTimer timer(report, "improved");
+        result.columns = {"id", "subject", "from", "to", "change"};
+        for (const auto& change : history.mostImproved(series, from, to, limit)) {
+            result.rows.push_back({change.studentId, ScoreHistory::seriesName(series), formatScore(change.from),
+                                   formatScore(change.to), formatScore(change.delta(), true)});
+        }
+        report.students = result.rows.size();
+        report.counts["series_scanned"] = history.studentCount();
+    }
+    result.matched = result.rows.size();
+    report.counts["points"] = history.pointCount();
+
+    StageTimer timer(report, "output");
+    writeResult(result, format);
+    return EXIT_OK;
+}
@@ -0,0 +1,111 @@
+#include "CredentialIndex.hpp"
+#include "MemoryStats.hpp"
+#include "PasswordHash.hpp"
+#include <algorithm>
+
+namespace {
+    // Stands in for the stored password when the username is unknown; hashed
+    // so the rejection costs as much as checking a password loaded from the cache
+    const std::string& dummyCredential() {
+        static const std::string hashed = PasswordHash::hash("scoreme-dummy-password");
+        return hashed;
+    }
+}
+
+// Build and maintenance
+void CredentialIndex::rebuild(const std::vector<Student>& students) {
+    MemoryStats::Scope memoryScope(MemoryStats::INDEX);
+    entries.clear();
+    entries.reserve(students.size());
+
+    for (size_t i = 0; i < students.size(); ++i) {
+        addStudent(students[i], i);
+    }
+}
+
+void CredentialIndex::addStudent(const Student& student, size_t position) {
+    std::string username = student.getUsername();
+    if (username.empty()) {
+        return;  // Students without login credentials cannot sign in
+    }
+
+    // First registration wins, same as the old linear scan
+    entries.emplace(username, Entry{position, student.getPassword()});
+}
+
+void CredentialIndex::removeStudent(size_t position) {
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->second.position == position) {
+            it = entries.erase(it);
+            continue;
+        }
+
+        // Everything after the erased student moves down by one slot
+        if (it->second.position > position) {
+            it->second.position--;
+        }
+        ++it;
+    }
+}
+
+void CredentialIndex::updateUsername(const std::string& oldUsername, const Student& student, size_t position) {
+    auto it = entries.find(oldUsername);
+    if (it != entries.end() && it->second.position == position) {
+        entries.erase(it);
+    }
+    addStudent(student, position);
+}
+
+void CredentialIndex::updatePassword(const std::string& username, size_t position, const std::string& newPassword) {
+    // A later duplicate of the username does not own the entry
+    auto it = entries.find(username);
+    if (it != entries.end() && it->second.position == position) {
+        it->second.password = newPassword;
+    }
+}
+
+// Lookup
+Student* CredentialIndex::authenticate(std::vector<Student>& students,
+                                       const std::string& username, const std::string& password) const {
+    auto it = entries.find(username);
+    if (it == entries.end()) {
+        // Still pay for a password comparison so unknown usernames are not faster
+        // to reject; the volatile store keeps the compiler from dropping it
+        volatile bool matched = PasswordHash::verify(password, dummyCredential());
+        (void)matched;
+        return nullptr;
+    }
+
+    const Entry& entry = it->second;
+    if (!PasswordHash::verify(password, entry.password)) {
+        return nullptr;
+    }
+
+    // Guard against an index that is out of step with the roster
+    if (entry.position >= students.size() || students[entry.position].getUsername() != username) {
+        return nullptr;
+    }
+
+    return &students[entry.position];
+}
+
+bool CredentialIndex::hasUsername(const std::string& username) const {
+    return entries.count(username) > 0;
+}
+
+size_t CredentialIndex::size() const {
+    return entries.size();
+}
+
+bool CredentialIndex::constantTimeEquals(const std::string& a, const std::string& b) {
+    size_t length = std::max(a.size(), b.size());
+    unsigned char diff = (a.size() != b.size()) ? 1 : 0;
+
+    for (size_t i = 0; i < length; ++i) {
+        unsigned char ca = i < a.size() ? static_cast<unsigned char>(a[i]) : 0;
+        unsigned char cb = i < b.size() ? static_cast<unsigned char>(b[i]) : 0;
+        diff |= static_cast<unsigned char>(ca ^ cb);
+    }
+
+    return diff == 0;
+}
@@ -2,58 +2,136 @@
 #include "MenuUtils.hpp"
 #include "GradeUtil.hpp"
 #include "Student.hpp"
+#include "Metrics.hpp"
+#include "MemoryStats.hpp"
+#include "XlsxReader.hpp"
+#include "XlsxWriter.hpp"
 #include <xlnt/xlnt.hpp>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <cmath>
 #include <ctime>
 #include <filesystem>
+#include <charconv>
 
 using namespace std;
 
 // Main Excel operations
-void ExcelUtils::writeExcel(const std::string& filename, const std::vector<Student>& students) {
+bool ExcelUtils::writeExcel(const std::string& filename, const std::vector<Student>& students, bool fastCompression) {
+    SCOREME_TIME_SCOPE("excel_write");
+    MemoryStats::Scope memoryScope(MemoryStats::WORKBOOK);
+    try {
+        // The schema is fixed, so the sheet XML is written directly
+        XlsxWriter::writeRoster(filename, students, fastCompression);
+        SCOREME_COUNT("excel_rows_written", students.size());
+        cout << "Excel file '" << filename << "' created successfully!" << endl;
+        return true;
+    }
+    catch (const exception& e) {
+        cerr << "Error writing Excel file: " << e.what() << endl;
+        return false;
+    }
+}
+
+bool ExcelUtils::writeExcelWithXlnt(const std::string& filename, const std::vector<Student>& students) {
+    SCOREME_TIME_SCOPE("excel_write_xlnt");
+    MemoryStats::Scope memoryScope(MemoryStats::WORKBOOK);
     try {
         xlnt::workbook wb;
         xlnt::worksheet ws = wb.active_sheet();
         ws.title("Student Grades");
+        {
+            SCOREME_TIME_SCOPE("excel_write_build");
+            
+            // Write headers
+            auto headers = getExcelHeaders();
+            for (size_t i = 0; i < headers.size(); ++i) {
+                ws.cell(xlnt::cell_reference(i + 1, 1)).value(headers[i]);
+            }
 
-        // Write headers
-        auto headers = getExcelHeaders();
-        for (size_t i = 0; i < headers.size(); ++i) {
-            ws.cell(xlnt::cell_reference(i + 1, 1)).value(headers[i]);
-        }
-
-        // Format header row
-        formatExcelHeader(ws);
+            // Format header row
+            formatExcelHeader(ws);
 
-        // Write student data
-        for (size_t i = 0; i < students.size(); ++i) {
-            writeStudentToExcel(ws, students[i], i + 2);
+            // Write student data
+            auto timestampFormat = createTimestampFormat(ws);
+            for (size_t i = 0; i < students.size(); ++i) {
+                writeStudentToExcel(ws, students[i], i + 2, timestampFormat);
+            }
         }
+        SCOREME_COUNT("excel_rows_written", students.size());
 
-        wb.save(filename);
+        {
+            // Renamed into place like XlsxWriter output, so a reader's mapping of the old file stays valid
+            SCOREME_TIME_SCOPE("excel_write_save");
+            string tempFilename = filename + ".tmp";
+            error_code ec;
+            try {
+                wb.save(tempFilename);
+                std::filesystem::rename(tempFilename, filename, ec);
+            }
+            catch (...) {
+                std::filesystem::remove(tempFilename, ec);
+                throw;
+            }
+            if (ec) {
+                std::filesystem::remove(tempFilename, ec);
+                throw runtime_error("cannot replace " + filename);
+            }
+        }
         cout << "Excel file '" << filename << "' created successfully!" << endl;
+        return true;
     }
     catch (const exception& e) {
         cerr << "Error writing Excel file: " << e.what() << endl;
+        return false;
     }
 }
 
 std::vector<Student> ExcelUtils::readExcelToVector(const std::string& filename) {
     std::vector<Student> students;
+    string error;
+    if (!readStudents(filename, students, error)) {
+        cerr << "Error reading Excel file: " << error << endl;
+    }
+    return students;
+}
+
+bool ExcelUtils::readStudents(const std::string& filename, std::vector<Student>& students, std::string& error) {
+    SCOREME_TIME_SCOPE("excel_read");
+    students.clear();
     
     try {
         if (!fileExists(filename)) {
-            cerr << "File '" << filename << "' does not exist!" << endl;
-            return students;
+            error = "file '" + filename + "' does not exist";
+            return false;
         }
 
+        // Fixed-schema fast path; workbooks it does not recognise go through xlnt
+        string reason;
+        if (XlsxReader::readRoster(filename, students, reason)) {
+            SCOREME_COUNT("excel_rows_read", students.size());
+            return true;
+        }
+        students.clear();
+        SCOREME_COUNT("excel_read_fallbacks", 1);
+
+        // Unzip and XML parsing both happen inside xlnt's load
         xlnt::workbook wb;
-        wb.load(filename);
+        {
+            SCOREME_TIME_SCOPE("excel_read_load");
+            MemoryStats::Scope workbookMemory(MemoryStats::WORKBOOK);
+            wb.load(filename);
+        }
         xlnt::worksheet ws = wb.active_sheet();
 
+        // Rows become roster records, unless the caller is staging them (e.g. an import)
+        SCOREME_TIME_SCOPE("excel_read_rows");
+        MemoryStats::Scope rowMemory(MemoryStats::currentTag() == MemoryStats::OTHER ?
+                                     MemoryStats::ROSTER : MemoryStats::currentTag());
+        size_t rowErrors = 0;
+
         // Skip header row and read data
         auto rows = ws.rows();
         auto row_iter = rows.begin();
@@ -67,15 +145,22 @@ std::vector<Student> ExcelUtils::readExcelToVector(const std::string& filename)
             }
             catch (const exception& e) {
                 cerr << "Error reading row " << rowNum << ": " << e.what() << endl;
+                rowErrors++;
                 continue;
             }
         }
+        SCOREME_COUNT("excel_rows_read", students.size());
+        SCOREME_COUNT("excel_row_errors", rowErrors);
+        if (rowErrors > 0) {
+            error = to_string(rowErrors) + " rows of '" + filename + "' could not be read";
+            return false;
+        }
+        return true;
     }
     catch (const exception& e) {
-        cerr << "Error reading Excel file: " << e.what() << endl;
+        error = "'" + filename + "': " + e.what();
+        return false;
     }
-
-    return students;
 }
 
 void ExcelUtils::readExcel(const std::string& filename) {
@@ -91,32 +176,31 @@ void ExcelUtils::readExcel(const std::string& filename) {
 }
 
 // Enhanced Excel operations
-void ExcelUtils::writeExcelWithTimestamp(const std::string& baseFilename, const std::vector<Student>& students) {
+bool ExcelUtils::writeExcelWithTimestamp(const std::string& baseFilename, const std::vector<Student>& students) {
     string timestampFilename = generateTimestampFilename(baseFilename);
-    writeExcel(timestampFilename, students);
+    return writeExcel(timestampFilename, students);
 }
 
-void ExcelUtils::createBackup(const std::string& sourceFilename, const std::vector<Student>& students) {
+bool ExcelUtils::createBackup(const std::string& sourceFilename, const std::vector<Student>& students) {
+    SCOREME_TIME_SCOPE("backup");
     // Create backup directory if it doesn't exist
     std::filesystem::create_directories("data/backups");
     
+    // Backups favour save time over file size
     string backupFilename = "data/backups/backup_" + generateTimestampFilename(sourceFilename);
-    writeExcel(backupFilename, students);
+    if (!writeExcel(backupFilename, students, true)) {
+        return false;
+    }
     
     cout << "Backup created: " << backupFilename << endl;
+    return true;
 }
 
-void ExcelUtils::exportGradeReport(const std::string& filename, const std::vector<Student>& students) {
+bool ExcelUtils::exportGradeReport(const std::string& filename, const std::vector<Student>& students) {
+    SCOREME_TIME_SCOPE("report_export");
+    MemoryStats::Scope memoryScope(MemoryStats::WORKBOOK);
     try {
-        xlnt::workbook wb;
-        xlnt::worksheet ws = wb.active_sheet();
-        ws.title("Grade Report");
-
-        // Add report title
-        ws.cell("A1").value("GRADE REPORT - " + getCurrentTimestamp());
-        ws.merge_cells("A1:H1");
-        
-        // Add summary statistics
+        // Summary statistics
         int totalStudents = students.size();
         int passingStudents = 0;
         double totalAverage = 0.0;
@@ -131,46 +215,133 @@ void ExcelUtils::exportGradeReport(const std::string& filename, const std::vecto
         double classAverage = totalStudents > 0 ? totalAverage / totalStudents : 0.0;
         double passRate = totalStudents > 0 ? (static_cast<double>(passingStudents) / totalStudents) * 100.0 : 0.0;
         
-        ws.cell("A3").value("Total Students: " + to_string(totalStudents));
-        ws.cell("A4").value("Passing Students: " + to_string(passingStudents));
-        ws.cell("A5").value("Pass Rate: " + to_string(static_cast<int>(passRate * 100) / 100.0) + "%");
-        ws.cell("A6").value("Class Average: " + to_string(static_cast<int>(classAverage * 100) / 100.0));
-
-        // Write headers starting from row 8
-        auto headers = getExcelHeaders();
-        for (size_t i = 0; i < headers.size(); ++i) {
-            ws.cell(xlnt::cell_reference(i + 1, 8)).value(headers[i]);
-        }
+        vector<string> summary = {
+            "Total Students: " + to_string(totalStudents),
+            "Passing Students: " + to_string(passingStudents),
+            "Pass Rate: " + to_string(static_cast<int>(passRate * 100) / 100.0) + "%",
+            "Class Average: " + to_string(static_cast<int>(classAverage * 100) / 100.0)
+        };
 
-        // Write student data
-        for (size_t i = 0; i < students.size(); ++i) {
-            writeStudentToExcel(ws, students[i], i + 9);
-        }
+        // Title on row 1, summary from row 3, headers on row 8, students from row 9
+        XlsxWriter::writeReport(filename, "GRADE REPORT - " + getCurrentTimestamp(), summary, students);
+        SCOREME_COUNT("report_rows_written", students.size());
 
-        wb.save(filename);
         cout << "Grade report exported to: " << filename << endl;
+        return true;
     }
     catch (const exception& e) {
         cerr << "Error creating grade report: " << e.what() << endl;
+        return false;
+    }
+}
+
+bool ExcelUtils::writeCsv(const std::string& filename, const std::vector<Student>& students) {
+    SCOREME_TIME_SCOPE("csv_write");
+    ofstream file(filename, ios::binary | ios::trunc);
+    if (!file) {
+        cerr << "Error writing CSV file: cannot open '" << filename << "'" << endl;
+        return false;
+    }
+    
+    // Rows are built in one buffer and written out in 1 MiB pieces
+    const size_t flushSize = 1 << 20;
+    string out;
+    out.reserve(flushSize + 4096);
+    
+    // RFC 4180 quoting, only where a field needs it
+    auto writeField = [&out](const string& value) {
+        if (value.find_first_of(",\"\r\n") == string::npos) {
+            out += value;
+            return;
+        }
+        out += '"';
+        for (char c : value) {
+            if (c == '"') out += '"';
+            out += c;
+        }
+        out += '"';
+    };
+    
+    // Same text as `stream << value` (6 significant digits)
+    auto writeNumber = [&out](double value) {
+        char buffer[32];
+        auto result = to_chars(buffer, buffer + sizeof(buffer), value, chars_format::general, 6);
+        out.append(buffer, result.ptr);
+    };
+    
+    auto headers = getExcelHeaders();
+    for (size_t i = 0; i < headers.size(); ++i) {
+        if (i > 0) out += ',';
+        writeField(headers[i]);
+    }
+    out += "\r\n";
+    
+    // Consecutive students usually share a timestamp; format it once
+    time_t lastTimestamp = -1;
+    string formattedTimestamp;
+    
+    for (const auto& student : students) {
+        writeField(student.getStudentId()); out += ',';
+        writeField(student.getName()); out += ',';
+        out += to_string(student.getAge()); out += ',';
+        writeField(student.getGender()); out += ',';
+        writeField(student.getDateOfBirth()); out += ',';
+        writeField(student.getEmail());
+        for (double score : student.getSubjectScores()) {
+            out += ',';
+            writeNumber(score);
+        }
+        out += ',';
+        writeNumber(student.getAverageScore());
+        out += ',';
+        out += student.getLetterGrade();
+        out += ',';
+        writeNumber(student.getGpa());
+        out += ',';
+        out += student.getRemark();
+        out += ',';
+        if (student.getLastUpdated() != lastTimestamp) {
+            lastTimestamp = student.getLastUpdated();
+            formattedTimestamp = student.getFormattedTimestamp();
+        }
+        out += formattedTimestamp;
+        out += "\r\n";
+        
+        if (out.size() >= flushSize) {
+            file.write(out.data(), static_cast<streamsize>(out.size()));
+            out.clear();
+        }
     }
+    
+    file.write(out.data(), static_cast<streamsize>(out.size()));
+    return static_cast<bool>(file);
 }
 
 // Import operations
 bool ExcelUtils::importStudentData(const std::string& filename, std::vector<Student>& students) {
+    SCOREME_TIME_SCOPE("excel_import");
     try {
         if (!fileExists(filename)) {
             cerr << "File '" << filename << "' does not exist!" << endl;
             return false;
         }
 
-        auto importedStudents = readExcelToVector(filename);
+        std::vector<Student> importedStudents;
+        {
+            MemoryStats::Scope stagingMemory(MemoryStats::IMPORT);
+            importedStudents = readExcelToVector(filename);
+        }
         if (importedStudents.empty()) {
             cerr << "No valid student data found in the file." << endl;
             return false;
         }
 
         // Add imported students to existing vector
-        students.insert(students.end(), importedStudents.begin(), importedStudents.end());
+        {
+            SCOREME_TIME_SCOPE("excel_import_append");
+            MemoryStats::Scope rosterMemory(MemoryStats::ROSTER);
+            students.insert(students.end(), importedStudents.begin(), importedStudents.end());
+        }
         
         cout << "Successfully imported " << importedStudents.size() << " students." << endl;
         return true;
@@ -182,17 +353,26 @@ bool ExcelUtils::importStudentData(const std::string& filename, std::vector<Stud
 }
 
 bool ExcelUtils::validateExcelFormat(const std::string& filename) {
+    SCOREME_TIME_SCOPE("excel_validate");
+    MemoryStats::Scope memoryScope(MemoryStats::WORKBOOK);
     try {
         if (!fileExists(filename)) {
             return false;
         }
 
+        // Fast path reads only the header row
+        auto expectedHeaders = getExcelHeaders();
+        vector<string> headers;
+        string reason;
+        if (XlsxReader::readHeaders(filename, headers, reason)) {
+            return headers == expectedHeaders;
+        }
+
         xlnt::workbook wb;
         wb.load(filename);
         xlnt::worksheet ws = wb.active_sheet();
 
         // Check if file has expected headers
-        auto expectedHeaders = getExcelHeaders();
         for (size_t i = 0; i < expectedHeaders.size(); ++i) {
             try {
                 string cellValue = ws.cell(xlnt::cell_reference(i + 1, 1)).to_string();
@@ -239,6 +419,48 @@ std::string ExcelUtils::getCurrentTimestamp() {
     return oss.str();
 }
 
+double ExcelUtils::toExcelDateTime(std::time_t time) {
+    auto tm = *localtime(&time);
+
+    // Days from 1970-01-01 to the civil date (proleptic Gregorian)
+    long year = tm.tm_year + 1900 - (tm.tm_mon < 2);
+    long era = (year >= 0 ? year : year - 399) / 400;
+    long yearOfEra = year - era * 400;
+    long month = tm.tm_mon + 1;
+    long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + tm.tm_mday - 1;
+    long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    long days = era * 146097 + dayOfEra - 719468;
+
+    // Excel counts from 1899-12-30, 25569 days before the Unix epoch
+    long seconds = tm.tm_hour * 3600L + tm.tm_min * 60L + tm.tm_sec;
+    return static_cast<double>(days + 25569) + seconds / 86400.0;
+}
+
+std::time_t ExcelUtils::fromExcelDateTime(double serial) {
+    long totalSeconds = lround(serial * 86400.0);
+    long days = totalSeconds / 86400 - 25569;
+    long seconds = totalSeconds % 86400;
+
+    // Civil date of a day count from 1970-01-01 (the inverse of the above)
+    days += 719468;
+    long era = (days >= 0 ? days : days - 146096) / 146097;
+    long dayOfEra = days - era * 146097;
+    long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    long shiftedMonth = (5 * dayOfYear + 2) / 153;
+    long month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+
+    tm local{};
+    local.tm_year = static_cast<int>(yearOfEra + era * 400 + (month <= 2) - 1900);
+    local.tm_mon = static_cast<int>(month - 1);
+    local.tm_mday = static_cast<int>(dayOfYear - (153 * shiftedMonth + 2) / 5 + 1);
+    local.tm_hour = static_cast<int>(seconds / 3600);
+    local.tm_min = static_cast<int>(seconds / 60 % 60);
+    local.tm_sec = static_cast<int>(seconds % 60);
+    local.tm_isdst = -1;
+    return mktime(&local);
+}
+
 bool ExcelUtils::fileExists(const std::string& filename) {
     ifstream file(filename);
     return file.good();
@@ -263,14 +485,24 @@ std::vector<std::string> ExcelUtils::getExcelHeaders() {
 
 // Helper methods for Excel formatting
 void ExcelUtils::formatExcelHeader(xlnt::worksheet& ws) {
+    // One bold format shared by the row; cell.font() would clone one per cell
+    auto headerFormat = ws.workbook().create_format();
+    headerFormat.font(xlnt::font().bold(true), true);
+
     auto headers = getExcelHeaders();
     for (size_t i = 0; i < headers.size(); ++i) {
-        auto cell = ws.cell(xlnt::cell_reference(i + 1, 1));
-        cell.font(xlnt::font().bold(true));
+        ws.cell(xlnt::cell_reference(i + 1, 1)).format(headerFormat);
     }
 }
 
-void ExcelUtils::writeStudentToExcel(xlnt::worksheet& ws, const Student& student, int row) {
+xlnt::format ExcelUtils::createTimestampFormat(xlnt::worksheet& ws) {
+    auto timestampFormat = ws.workbook().create_format();
+    timestampFormat.number_format(xlnt::number_format("yyyy-mm-dd hh:mm:ss"), true);
+    return timestampFormat;
+}
+
+void ExcelUtils::writeStudentToExcel(xlnt::worksheet& ws, const Student& student, int row,
+                                     const xlnt::format& timestampFormat) {
     int col = 1;
     
     // Basic information
@@ -282,7 +514,7 @@ void ExcelUtils::writeStudentToExcel(xlnt::worksheet& ws, const Student& student
     ws.cell(xlnt::cell_reference(col++, row)).value(student.getEmail());
     
     // Subject scores
-    auto scores = student.getSubjectScores();
+    const auto& scores = student.getSubjectScores();
     for (const auto& score : scores) {
         ws.cell(xlnt::cell_reference(col++, row)).value(score);
     }
@@ -292,7 +524,11 @@ void ExcelUtils::writeStudentToExcel(xlnt::worksheet& ws, const Student& student
     ws.cell(xlnt::cell_reference(col++, row)).value(student.getLetterGrade());
     ws.cell(xlnt::cell_reference(col++, row)).value(student.getGpa());
     ws.cell(xlnt::cell_reference(col++, row)).value(student.getRemark());
-    ws.cell(xlnt::cell_reference(col++, row)).value(student.getFormattedTimestamp());
+
+    // Numeric date-time, shown as getFormattedTimestamp() would print it
+    auto timestampCell = ws.cell(xlnt::cell_reference(col++, row));
+    timestampCell.value(toExcelDateTime(student.getLastUpdated()));
+    timestampCell.format(timestampFormat);
 }
 
 Student ExcelUtils::readStudentFromExcel(xlnt::worksheet& ws, int row) {
@@ -317,6 +553,13 @@ Student ExcelUtils::readStudentFromExcel(xlnt::worksheet& ws, int row) {
         
         // Create student object
         Student student(studentId, name, age, gender, dateOfBirth, email, scores);
+
+        // Average, grade, GPA and remark are derived; "Last Updated" is kept
+        // when the cell holds a date-time, otherwise the load time stands
+        xlnt::cell timestampCell = ws.cell(xlnt::cell_reference(col + 4, row));
+        if (timestampCell.has_value() && timestampCell.data_type() == xlnt::cell_type::number) {
+            student.setLastUpdated(fromExcelDateTime(timestampCell.value<double>()));
+        }
         return student;
     }
     catch (const exception& e) {
@@ -51,6 +51,34 @@ bool GradeUtil::isPassingGrade(double average) {
     return average >= PASSING_THRESHOLD;  // 50+ is passing
 }
 
+int GradeUtil::gradeRank(const std::string& grade) {
+    if (grade == "A") return 5;
+    else if (grade == "B") return 4;
+    else if (grade == "C") return 3;
+    else if (grade == "D") return 2;
+    else if (grade == "E") return 1;
+    else return 0;  // F or unknown
+}
+
+double GradeUtil::getGradeLowerBound(const std::string& grade) {
+    if (grade == "A") return GRADE_A_THRESHOLD;
+    else if (grade == "B") return GRADE_B_THRESHOLD;
+    else if (grade == "C") return GRADE_C_THRESHOLD;
+    else if (grade == "D") return GRADE_D_THRESHOLD;
+    else if (grade == "E") return GRADE_E_THRESHOLD;
+    else return MIN_SCORE;
+}
+
+// Exclusive upper bound, so [lower, upper) covers exactly one grade
+double GradeUtil::getGradeUpperBound(const std::string& grade) {
+    if (grade == "A") return MAX_SCORE + 1.0;
+    else if (grade == "B") return GRADE_A_THRESHOLD;
+    else if (grade == "C") return GRADE_B_THRESHOLD;
+    else if (grade == "D") return GRADE_C_THRESHOLD;
+    else if (grade == "E") return GRADE_D_THRESHOLD;
+    else return GRADE_E_THRESHOLD;
+}
+
 std::vector<std::string> GradeUtil::getSubjectNames() {
     return {
         "Mathematics",
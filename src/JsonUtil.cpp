@@ -0,0 +1,241 @@
+#include "JsonUtil.hpp"
+#include <cstdio>
+#include <stdexcept>
+
+using namespace std;
+
+std::string JsonUtil::escape(const std::string& text) {
+    string result;
+    result.reserve(text.size() + 2);
+    for (char c : text) {
+        switch (c) {
+            case '"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\r': result += "\\r"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+                    result += buffer;
+                } else {
+                    result += c;
+                }
+        }
+    }
+    return result;
+}
+
+std::string JsonUtil::quote(const std::string& text) {
+    return "\"" + escape(text) + "\"";
+}
+
+namespace {
+    class Parser {
+    public:
+        explicit Parser(const string& text) : text(text) {}
+
+        map<string, string> parseObject() {
+            map<string, string> result;
+            skipSpace();
+            expect('{');
+            skipSpace();
+            if (peek() == '}') {
+                ++pos;
+                return finish(result);
+            }
+            while (true) {
+                skipSpace();
+                string key = parseString();
+                skipSpace();
+                expect(':');
+                skipSpace();
+                result[key] = parseValue();
+                skipSpace();
+                if (peek() == ',') {
+                    ++pos;
+                    continue;
+                }
+                expect('}');
+                return finish(result);
+            }
+        }
+
+        JsonUtil::Value parseDocument() {
+            JsonUtil::Value value = parseTree();
+            skipSpace();
+            if (pos != text.size()) {
+                throw runtime_error("Unexpected text after JSON value");
+            }
+            return value;
+        }
+
+    private:
+        const string& text;
+        size_t pos = 0;
+
+        JsonUtil::Value parseTree() {
+            JsonUtil::Value value;
+            skipSpace();
+            char c = peek();
+            if (c == '[' || c == '{') {
+                bool object = c == '{';
+                value.type = object ? JsonUtil::Value::OBJECT : JsonUtil::Value::ARRAY;
+                ++pos;
+                skipSpace();
+                char close = object ? '}' : ']';
+                if (peek() == close) {
+                    ++pos;
+                    return value;
+                }
+                while (true) {
+                    skipSpace();
+                    if (object) {
+                        value.keys.push_back(parseString());
+                        skipSpace();
+                        expect(':');
+                    }
+                    value.items.push_back(parseTree());
+                    skipSpace();
+                    if (peek() == ',') {
+                        ++pos;
+                        continue;
+                    }
+                    expect(close);
+                    return value;
+                }
+            }
+            if (c == '"') {
+                value.type = JsonUtil::Value::SCALAR;
+                value.text = parseString();
+                return value;
+            }
+            size_t start = pos;
+            while (pos < text.size() && text[pos] != ',' && text[pos] != '}' && text[pos] != ']' &&
+                   text[pos] != ' ' && text[pos] != '\t' && text[pos] != '\r' && text[pos] != '\n') {
+                ++pos;
+            }
+            if (start == pos) {
+                throw runtime_error("Missing JSON value at offset " + to_string(pos));
+            }
+            value.text = text.substr(start, pos - start);
+            value.type = value.text == "null" ? JsonUtil::Value::NUL : JsonUtil::Value::SCALAR;
+            return value;
+        }
+
+        char peek() const { return pos < text.size() ? text[pos] : '\0'; }
+
+        void skipSpace() {
+            while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '\n')) {
+                ++pos;
+            }
+        }
+
+        void expect(char c) {
+            if (peek() != c) {
+                throw runtime_error(string("Expected '") + c + "' at offset " + to_string(pos));
+            }
+            ++pos;
+        }
+
+        map<string, string> finish(map<string, string>& result) {
+            skipSpace();
+            if (pos != text.size()) {
+                throw runtime_error("Unexpected text after JSON object");
+            }
+            return std::move(result);
+        }
+
+        string parseValue() {
+            char c = peek();
+            if (c == '"') {
+                return parseString();
+            }
+            if (c == '{' || c == '[') {
+                throw runtime_error("Nested JSON values are not supported");
+            }
+            size_t start = pos;
+            while (pos < text.size() && text[pos] != ',' && text[pos] != '}' &&
+                   text[pos] != ' ' && text[pos] != '\t' && text[pos] != '\r' && text[pos] != '\n') {
+                ++pos;
+            }
+            if (start == pos) {
+                throw runtime_error("Missing JSON value at offset " + to_string(pos));
+            }
+            return text.substr(start, pos - start);
+        }
+
+        string parseString() {
+            expect('"');
+            string result;
+            while (pos < text.size() && text[pos] != '"') {
+                char c = text[pos++];
+                if (c != '\\') {
+                    result += c;
+                    continue;
+                }
+                if (pos >= text.size()) break;
+                char escaped = text[pos++];
+                switch (escaped) {
+                    case 'n': result += '\n'; break;
+                    case 'r': result += '\r'; break;
+                    case 't': result += '\t'; break;
+                    case 'b': result += '\b'; break;
+                    case 'f': result += '\f'; break;
+                    case 'u': result += parseUnicode(); break;
+                    default: result += escaped; break;
+                }
+            }
+            expect('"');
+            return result;
+        }
+
+        // \uXXXX to UTF-8 (basic multilingual plane only)
+        string parseUnicode() {
+            if (pos + 4 > text.size()) {
+                throw runtime_error("Truncated \\u escape");
+            }
+            unsigned code = stoul(text.substr(pos, 4), nullptr, 16);
+            pos += 4;
+            string out;
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xC0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else {
+                out += static_cast<char>(0xE0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+            return out;
+        }
+    };
+}
+
+std::map<std::string, std::string> JsonUtil::parseFlatObject(const std::string& text) {
+    return Parser(text).parseObject();
+}
+
+JsonUtil::Value JsonUtil::parse(const std::string& text) {
+    return Parser(text).parseDocument();
+}
+
+const JsonUtil::Value& JsonUtil::Value::at(const std::string& key) const {
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (keys[i] == key) {
+            return items[i];
+        }
+    }
+    throw runtime_error("Missing JSON member: " + key);
+}
+
+bool JsonUtil::Value::has(const std::string& key) const {
+    for (const auto& name : keys) {
+        if (name == key) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,283 @@
+#include "MemoryStats.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+std::atomic<bool> MemoryStats::reported{false};
+
+namespace {
+    struct TagCounters {
+        atomic<int64_t> live{0};
+        atomic<int64_t> peak{0};
+        atomic<uint64_t> allocations{0};
+    };
+
+    // Plain arrays with constant initialization: usable before any constructor runs
+    TagCounters counters[MemoryStats::TAG_COUNT];
+    thread_local MemoryStats::Tag activeTag = MemoryStats::OTHER;
+
+    const char* const TAG_NAMES[MemoryStats::TAG_COUNT] = {
+        "other", "roster", "import", "workbook", "render", "index"
+    };
+
+    // Heap bytes behind a string; zero while it fits in the small-string buffer
+    size_t heapBytes(const string& text) {
+        const char* data = text.data();
+        const char* self = reinterpret_cast<const char*>(&text);
+        bool isInline = data >= self && data < self + sizeof(string);
+        return isInline ? 0 : text.capacity() + 1;
+    }
+
+    string formatBytes(double bytes) {
+        const char* units[] = {"B", "KiB", "MiB", "GiB"};
+        int unit = 0;
+        while (bytes >= 1024.0 && unit < 3) {
+            bytes /= 1024.0;
+            ++unit;
+        }
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), unit == 0 ? "%.0f %s" : "%.1f %s", bytes, units[unit]);
+        return buffer;
+    }
+}
+
+MemoryStats::Scope::Scope(Tag tag) : previous(activeTag) {
+    activeTag = tag;
+}
+
+MemoryStats::Scope::~Scope() {
+    activeTag = previous;
+}
+
+const char* MemoryStats::tagName(Tag tag) {
+    return tag < TAG_COUNT ? TAG_NAMES[tag] : "unknown";
+}
+
+bool MemoryStats::isTracking() {
+#ifdef SCOREME_TRACK_MEMORY
+    return true;
+#else
+    return false;
+#endif
+}
+
+MemoryStats::Tag MemoryStats::currentTag() {
+    return activeTag;
+}
+
+void MemoryStats::recordAllocation(Tag tag, size_t bytes) {
+    TagCounters& c = counters[tag];
+    int64_t live = c.live.fetch_add(static_cast<int64_t>(bytes), memory_order_relaxed) + static_cast<int64_t>(bytes);
+    c.allocations.fetch_add(1, memory_order_relaxed);
+    int64_t peak = c.peak.load(memory_order_relaxed);
+    while (live > peak && !c.peak.compare_exchange_weak(peak, live, memory_order_relaxed)) {
+    }
+}
+
+void MemoryStats::recordDeallocation(Tag tag, size_t bytes) {
+    counters[tag].live.fetch_sub(static_cast<int64_t>(bytes), memory_order_relaxed);
+}
+
+std::vector<MemoryStats::TagStats> MemoryStats::tagStats() {
+    vector<TagStats> stats;
+    for (int tag = 0; tag < TAG_COUNT; ++tag) {
+        stats.push_back({TAG_NAMES[tag], counters[tag].live.load(), counters[tag].peak.load(),
+                         counters[tag].allocations.load()});
+    }
+    return stats;
+}
+
+// Structural measurement
+MemoryStats::StudentBreakdown MemoryStats::measureStudent(const Student& student) {
+    StudentBreakdown b;
+    b.object = sizeof(Student);
+    b.loginStrings = heapBytes(student.getUsername()) + heapBytes(student.getPassword()) + heapBytes(student.getName());
+    b.profileStrings = heapBytes(student.getStudentId()) + heapBytes(student.getGender()) +
+                       heapBytes(student.getDateOfBirth()) + heapBytes(student.getEmail());
+    b.gradeStrings = heapBytes(student.getLetterGrade()) + heapBytes(student.getRemark());
+    b.scores = student.getSubjectScores().capacity() * sizeof(double);
+    return b;
+}
+
+MemoryStats::StudentBreakdown MemoryStats::measureRoster(const std::vector<Student>& students) {
+    StudentBreakdown sum;
+    for (const auto& student : students) {
+        StudentBreakdown b = measureStudent(student);
+        sum.object += b.object;
+        sum.loginStrings += b.loginStrings;
+        sum.profileStrings += b.profileStrings;
+        sum.gradeStrings += b.gradeStrings;
+        sum.scores += b.scores;
+    }
+    return sum;
+}
+
+// Process level
+long MemoryStats::residentKb() {
+#ifdef __linux__
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            return stol(line.substr(6));
+        }
+    }
+#endif
+    return 0;
+}
+
+long MemoryStats::peakResidentKb() {
+#ifdef __linux__
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return stol(line.substr(6));
+        }
+    }
+#endif
+#ifndef _WIN32
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+void MemoryStats::resetPeakResident() {
+#ifdef __linux__
+    ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+#endif
+}
+
+void MemoryStats::printReport(std::ostream& out, const std::vector<Student>* roster) {
+    out << "Memory report" << endl;
+
+    if (roster && !roster->empty()) {
+        double count = static_cast<double>(roster->size());
+        StudentBreakdown sum = measureRoster(*roster);
+        size_t slack = (roster->capacity() - roster->size()) * sizeof(Student);
+
+        out << "  Roster: " << roster->size() << " students, " << formatBytes(static_cast<double>(sum.total() + slack))
+            << " (" << formatBytes(static_cast<double>(slack)) << " unused vector capacity)" << endl;
+        out << fixed << setprecision(1)
+            << "  Bytes per student: " << sum.total() / count << endl
+            << "    object          " << setw(8) << sum.object / count << endl
+            << "    login strings   " << setw(8) << sum.loginStrings / count << "   username, password, name" << endl
+            << "    profile strings " << setw(8) << sum.profileStrings / count << "   id, gender, date of birth, email" << endl
+            << "    grade strings   " << setw(8) << sum.gradeStrings / count << "   letter grade, remark" << endl
+            << "    scores          " << setw(8) << sum.scores / count << "   score vector" << endl;
+        out.unsetf(ios::floatfield);
+    }
+
+    if (isTracking()) {
+        out << "  Tracked allocations (live / peak / count):" << endl;
+        for (const auto& tag : tagStats()) {
+            if (tag.allocations == 0) {
+                continue;
+            }
+            out << "    " << left << setw(9) << tag.name << right
+                << setw(12) << formatBytes(static_cast<double>(tag.liveBytes))
+                << setw(12) << formatBytes(static_cast<double>(tag.peakBytes))
+                << setw(12) << tag.allocations << endl;
+        }
+    } else {
+        out << "  Per-subsystem tracking is off (build with -DSCOREME_TRACK_MEMORY=ON)." << endl;
+    }
+
+    long resident = residentKb();
+    if (resident > 0) {
+        out << "  Process RSS: " << formatBytes(resident * 1024.0)
+            << ", peak " << formatBytes(peakResidentKb() * 1024.0) << endl;
+    }
+}
+
+void MemoryStats::printReportFromEnvironment(const std::vector<Student>* roster) {
+    const char* setting = getenv("SCOREME_MEMORY_REPORT");
+    if (!setting || !*setting || string(setting) == "0" || reported.exchange(true)) {
+        return;
+    }
+    printReport(cerr, roster);
+}
+
+// Global allocation hooks
+#ifdef SCOREME_TRACK_MEMORY
+namespace {
+    // Sits directly in front of every tracked block
+    struct alignas(16) BlockHeader {
+        uint64_t size;
+        uint32_t offset;   // from the start of the raw block to the user pointer
+        uint32_t tag;
+    };
+    static_assert(sizeof(BlockHeader) == 16, "header must keep 16-byte alignment");
+
+    void* trackedAllocate(size_t size, size_t alignment, bool nothrow) {
+        size_t offset = alignment > sizeof(BlockHeader) ? alignment : sizeof(BlockHeader);
+        void* raw = nullptr;
+        if (alignment > sizeof(BlockHeader)) {
+            size_t total = (size + offset + alignment - 1) / alignment * alignment;
+            raw = aligned_alloc(alignment, total);
+        } else {
+            raw = malloc(size + offset);
+        }
+        if (!raw) {
+            if (nothrow) return nullptr;
+            throw bad_alloc();
+        }
+
+        char* user = static_cast<char*>(raw) + offset;
+        BlockHeader* header = reinterpret_cast<BlockHeader*>(user) - 1;
+        header->size = size;
+        header->offset = static_cast<uint32_t>(offset);
+        header->tag = MemoryStats::currentTag();
+        MemoryStats::recordAllocation(static_cast<MemoryStats::Tag>(header->tag), size);
+        return user;
+    }
+
+    void trackedFree(void* pointer) {
+        if (!pointer) {
+            return;
+        }
+        BlockHeader* header = static_cast<BlockHeader*>(pointer) - 1;
+        MemoryStats::recordDeallocation(static_cast<MemoryStats::Tag>(header->tag), header->size);
+        free(static_cast<char*>(pointer) - header->offset);
+    }
+}
+
+void* operator new(size_t size) { return trackedAllocate(size, 0, false); }
+void* operator new[](size_t size) { return trackedAllocate(size, 0, false); }
+void* operator new(size_t size, const nothrow_t&) noexcept { return trackedAllocate(size, 0, true); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return trackedAllocate(size, 0, true); }
+void* operator new(size_t size, align_val_t align) { return trackedAllocate(size, static_cast<size_t>(align), false); }
+void* operator new[](size_t size, align_val_t align) { return trackedAllocate(size, static_cast<size_t>(align), false); }
+void* operator new(size_t size, align_val_t align, const nothrow_t&) noexcept { return trackedAllocate(size, static_cast<size_t>(align), true); }
+void* operator new[](size_t size, align_val_t align, const nothrow_t&) noexcept { return trackedAllocate(size, static_cast<size_t>(align), true); }
+
+void operator delete(void* pointer) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer) noexcept { trackedFree(pointer); }
+void operator delete(void* pointer, size_t) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { trackedFree(pointer); }
+void operator delete(void* pointer, const nothrow_t&) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer, const nothrow_t&) noexcept { trackedFree(pointer); }
+void operator delete(void* pointer, align_val_t) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer, align_val_t) noexcept { trackedFree(pointer); }
+void operator delete(void* pointer, size_t, align_val_t) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer, size_t, align_val_t) noexcept { trackedFree(pointer); }
+void operator delete(void* pointer, align_val_t, const nothrow_t&) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer, align_val_t, const nothrow_t&) noexcept { trackedFree(pointer); }
+#endif
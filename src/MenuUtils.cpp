@@ -1,12 +1,20 @@
 #include "MenuUtils.hpp"
 #include "GradeUtil.hpp"
+#include "TableRenderer.hpp"
+#include "MemoryStats.hpp"
 #include <tabulate/table.hpp>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 #include <limits>
+#include <algorithm>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
 #ifdef _WIN32
     #include <windows.h>
     #include <conio.h>
+    #include <io.h>
 #else
     #include <termios.h>
     #include <unistd.h>
@@ -26,6 +34,12 @@ const std::string MenuUtils::CYAN = "\033[36m";
 const std::string MenuUtils::WHITE = "\033[37m";
 const std::string MenuUtils::BOLD = "\033[1m";
 
+const size_t MenuUtils::PAGE_SIZE = 25;
+
+// SCOREME_RENDERER=tabulate switches back to the tabulate tables
+bool MenuUtils::fastRendering = !(std::getenv("SCOREME_RENDERER") &&
+                                  std::string(std::getenv("SCOREME_RENDERER")) == "tabulate");
+
 // ADDED: Helper function to get grade color
 Color MenuUtils::getGradeColor(const std::string& grade) {
     if (grade == "A" || grade == "B" || grade == "C") {
@@ -42,15 +56,110 @@ Color MenuUtils::getGradeColor(const std::string& grade) {
 
 // Display methods
 void MenuUtils::displayTable(const std::vector<Student>& students) {
+    displayTable(StudentView(students));
+}
+
+void MenuUtils::displayTable(const StudentView& students) {
+    MemoryStats::Scope memoryScope(MemoryStats::RENDER);
     if (students.empty()) {
         printWarning("No students to display!");
         return;
     }
     
+    if (students.size() > PAGE_SIZE) {
+        displayPagedTable(students);
+        return;
+    }
+    
+    renderStudentRows(students, 0, students.size(), {});
+    
+    // ADDED: Display color legend
+    printColorLegend();
+}
+
+void MenuUtils::displayPagedTable(const StudentView& students) {
+    MemoryStats::Scope memoryScope(MemoryStats::RENDER);
+    size_t total = students.size();
+    size_t pageCount = (total + PAGE_SIZE - 1) / PAGE_SIZE;
+    size_t page = 0;
+    
+    // Widths come from a sample of the whole roster, so columns stay put while paging
+    std::vector<size_t> widths = sampleColumnWidths(students);
+    
+    while (true) {
+        size_t first = page * PAGE_SIZE;
+        size_t last = std::min(first + PAGE_SIZE, total);
+        renderStudentRows(students, first, last, widths);
+        
+        printInfo("Page " + to_string(page + 1) + " of " + to_string(pageCount) +
+                  " (students " + to_string(first + 1) + "-" + to_string(last) + " of " + to_string(total) + ")");
+        string command = getStringInput("[n]ext, [p]rev, [f]irst, [l]ast, page number, [q]uit: ");
+        
+        if (command.empty() || command == "n" || command == "N") {
+            if (page + 1 < pageCount) page++;
+            else printWarning("Already on the last page.");
+        }
+        else if (command == "p" || command == "P") {
+            if (page > 0) page--;
+            else printWarning("Already on the first page.");
+        }
+        else if (command == "f" || command == "F") {
+            page = 0;
+        }
+        else if (command == "l" || command == "L") {
+            page = pageCount - 1;
+        }
+        else if (command == "q" || command == "Q") {
+            break;
+        }
+        else {
+            try {
+                size_t target = stoul(command);
+                if (target >= 1 && target <= pageCount) {
+                    page = target - 1;
+                } else {
+                    printError("Page must be between 1 and " + to_string(pageCount));
+                }
+            }
+            catch (...) {
+                printError("Unknown command: " + command);
+            }
+        }
+    }
+    
+    printColorLegend();
+}
+
+std::vector<size_t> MenuUtils::sampleColumnWidths(const StudentView& students) {
+    // ID, Name, Age, Gender, Average, Grade, GPA, Remark
+    std::vector<size_t> widths = {2, 4, 3, 6, 9, 5, 8, 6};
+    
+    // Every row for small rosters, about a thousand evenly spaced rows otherwise
+    size_t step = std::max<size_t>(1, students.size() / 1000);
+    for (size_t i = 0; i < students.size(); i += step) {
+        const Student& student = students[i];
+        widths[0] = std::max(widths[0], student.getStudentId().size());
+        widths[1] = std::max(widths[1], student.getName().size());
+        widths[3] = std::max(widths[3], student.getGender().size());
+        widths[7] = std::max(widths[7], student.getRemark().size());
+    }
+    
+    return widths;
+}
+
+void MenuUtils::renderStudentRows(const StudentView& students, size_t first, size_t last,
+                                  const std::vector<size_t>& sampledWidths) {
+    if (fastRendering) {
+        TableRenderer::renderStudentRows(students, first, last, sampledWidths);
+        return;
+    }
+    
     Table table;
     table.add_row({"ID", "Name", "Age", "Gender", "Average", "Grade", "GPA", "Remark"});
     
-    for (const auto& student : students) {
+    // Only the visible window is formatted
+    for (size_t i = first; i < last; ++i) {
+        const Student& student = students[i];
         table.add_row({
             student.getStudentId(),
             student.getName(),
@@ -67,26 +176,40 @@ void MenuUtils::displayTable(const std::vector<Student>& students) {
     
     // UPDATED: Apply color coding based on new grading system
     for (size_t i = 1; i < table.size(); ++i) {
-        std::string grade = students[i-1].getLetterGrade();
-        std::string remark = students[i-1].getRemark();
+        const Student& student = students[first + i - 1];
         
         // Color the entire row based on grade
-        Color gradeColor = getGradeColor(grade);
+        Color gradeColor = getGradeColor(student.getLetterGrade());
         table[i].format().font_color(gradeColor);
         
         // Make failing students more prominent
-        if (remark == "Fail") {
+        if (student.getRemark() == "Fail") {
             table[i].format().font_style({FontStyle::bold});
         }
     }
     
-    cout << table << endl;
+    if (!sampledWidths.empty()) {
+        // Rows on this page may still be wider than the sample
+        std::vector<size_t> widths = sampledWidths;
+        for (size_t i = first; i < last; ++i) {
+            widths[0] = std::max(widths[0], students[i].getStudentId().size());
+            widths[1] = std::max(widths[1], students[i].getName().size());
+        }
+        for (size_t c = 0; c < widths.size(); ++c) {
+            table.column(c).format().width(widths[c] + 2);  // Cell padding
+        }
+    }
     
-    // ADDED: Display color legend
-    printColorLegend();
+    cout << table << endl;
 }
 
 void MenuUtils::displayStudentDetails(const Student& student) {
+    MemoryStats::Scope memoryScope(MemoryStats::RENDER);
+    if (fastRendering) {
+        TableRenderer::renderStudentDetails(student);
+        return;
+    }
+    
     Table table;
     table.add_row({"Field", "Value"});
     
@@ -99,7 +222,7 @@ void MenuUtils::displayStudentDetails(const Student& student) {
     
     // Subject scores
     auto subjects = GradeUtil::getSubjectNames();
-    auto scores = student.getSubjectScores();
+    const auto& scores = student.getSubjectScores();
     
     for (size_t i = 0; i < subjects.size() && i < scores.size(); ++i) {
         table.add_row({subjects[i], to_string(scores[i])});
@@ -138,6 +261,7 @@ void MenuUtils::displayStudentDetails(const Student& student) {
 }
 
 void MenuUtils::displayGradeReport(const std::vector<Student>& students) {
+    MemoryStats::Scope memoryScope(MemoryStats::RENDER);
     printHeader("GRADE REPORT");
     
     if (students.empty()) {
@@ -170,51 +294,74 @@ void MenuUtils::displayGradeReport(const std::vector<Student>& students) {
     double classAverage = totalAverage / totalStudents;
     double passRate = (static_cast<double>(passingStudents) / totalStudents) * 100.0;
     
-    Table summaryTable;
-    summaryTable.add_row({"Statistic", "Value"});
-    summaryTable.add_row({"Total Students", to_string(totalStudents)});
-    summaryTable.add_row({"Passing Students (50+)", to_string(passingStudents)});
-    summaryTable.add_row({"Failing Students (<50)", to_string(totalStudents - passingStudents)});
-    summaryTable.add_row({"Pass Rate", to_string(static_cast<int>(passRate * 100) / 100.0) + "%"});
-    summaryTable.add_row({"Class Average", to_string(static_cast<int>(classAverage * 100) / 100.0)});
-    
-    // ADDED: Grade distribution
-    summaryTable.add_row({"Grade A (90-100)", to_string(gradeA)});
-    summaryTable.add_row({"Grade B (80-89)", to_string(gradeB)});
-    summaryTable.add_row({"Grade C (70-79)", to_string(gradeC)});
-    summaryTable.add_row({"Grade D (60-69)", to_string(gradeD)});
-    summaryTable.add_row({"Grade E (50-59)", to_string(gradeE)});
-    summaryTable.add_row({"Grade F (<50)", to_string(gradeF)});
-    
-    summaryTable[0].format().font_style({FontStyle::bold}).font_color(Color::magenta);
+    std::vector<std::pair<std::string, std::string>> summaryRows = {
+        {"Statistic", "Value"},
+        {"Total Students", to_string(totalStudents)},
+        {"Passing Students (50+)", to_string(passingStudents)},
+        {"Failing Students (<50)", to_string(totalStudents - passingStudents)},
+        {"Pass Rate", to_string(static_cast<int>(passRate * 100) / 100.0) + "%"},
+        {"Class Average", to_string(static_cast<int>(classAverage * 100) / 100.0)},
+        
+        // ADDED: Grade distribution
+        {"Grade A (90-100)", to_string(gradeA)},
+        {"Grade B (80-89)", to_string(gradeB)},
+        {"Grade C (70-79)", to_string(gradeC)},
+        {"Grade D (60-69)", to_string(gradeD)},
+        {"Grade E (50-59)", to_string(gradeE)},
+        {"Grade F (<50)", to_string(gradeF)}
+    };
     
     // Color the grade distribution rows
-    for (size_t i = 1; i < summaryTable.size(); ++i) {
-        std::string field = summaryTable[i][0].get_text();
+    std::vector<Color> rowColors(summaryRows.size(), Color::none);
+    rowColors[0] = Color::magenta;
+    for (size_t i = 1; i < summaryRows.size(); ++i) {
+        const std::string& field = summaryRows[i].first;
         if (field.find("Grade A") == 0 || field.find("Grade B") == 0 || field.find("Grade C") == 0) {
-            summaryTable[i].format().font_color(Color::green);
+            rowColors[i] = Color::green;
         }
         else if (field.find("Grade D") == 0 || field.find("Grade E") == 0) {
-            summaryTable[i].format().font_color(Color::yellow);
-        }
-        else if (field.find("Grade F") == 0) {
-            summaryTable[i].format().font_color(Color::red);
+            rowColors[i] = Color::yellow;
         }
-        else if (field.find("Failing") == 0) {
-            summaryTable[i].format().font_color(Color::red);
+        else if (field.find("Grade F") == 0 || field.find("Failing") == 0) {
+            rowColors[i] = Color::red;
         }
         else if (field.find("Passing") == 0) {
-            summaryTable[i].format().font_color(Color::green);
+            rowColors[i] = Color::green;
         }
     }
     
-    cout << summaryTable << endl;
+    if (fastRendering) {
+        std::vector<TableRenderer::RowStyle> styles;
+        for (size_t i = 0; i < rowColors.size(); ++i) {
+            styles.push_back({TableRenderer::colorCode(rowColors[i]), i == 0});
+        }
+        TableRenderer::renderTwoColumn(summaryRows, styles);
+    } else {
+        Table summaryTable;
+        for (const auto& row : summaryRows) {
+            summaryTable.add_row({row.first, row.second});
+        }
+        
+        summaryTable[0].format().font_style({FontStyle::bold}).font_color(Color::magenta);
+        for (size_t i = 1; i < summaryTable.size(); ++i) {
+            if (rowColors[i] != Color::none) {
+                summaryTable[i].format().font_color(rowColors[i]);
+            }
+        }
+        
+        cout << summaryTable << endl;
+    }
     
     printSeparator();
     displayTable(students);
 }
 
 void MenuUtils::displayFailingStudents(const std::vector<Student>& students) {
+    displayFailingStudents(StudentView(students));
+}
+
+void MenuUtils::displayFailingStudents(const StudentView& students) {
+    MemoryStats::Scope memoryScope(MemoryStats::RENDER);
     if (students.empty()) {
         printSuccess("No failing students found!");
         return;
@@ -224,6 +371,66 @@ void MenuUtils::displayFailingStudents(const std::vector<Student>& students) {
     displayTable(students);
 }
 
+void MenuUtils::displayQueryResult(const QueryResult& result) {
+    MemoryStats::Scope memoryScope(MemoryStats::RENDER);
+    if (result.rows.empty()) {
+        printWarning("No students matched the query.");
+        return;
+    }
+    
+    Table table;
+    Table::Row_t header(result.columns.begin(), result.columns.end());
+    table.add_row(header);
+    
+    for (const auto& row : result.rows) {
+        table.add_row(Table::Row_t(row.begin(), row.end()));
+    }
+    
+    table[0].format().font_style({FontStyle::bold}).font_color(Color::cyan);
+    cout << table << endl;
+    
+    printInfo("Showing " + to_string(result.rows.size()) + " of " + to_string(result.matched) + " matching students.");
+}
+
+void MenuUtils::displayPerformanceStats(const std::vector<Metrics::TimerStats>& timers,
+                                        const std::vector<Metrics::CounterStats>& counters) {
+    if (!Metrics::isEnabled()) {
+        printWarning("Metrics are switched off; figures below stop at the moment they were disabled.");
+    }
+    
+    bool anyTimer = false;
+    Table timerTable;
+    timerTable.add_row({"Stage", "Calls", "Total (ms)", "Mean (ms)", "Max (ms)"});
+    for (const auto& timer : timers) {
+        if (timer.count == 0) {
+            continue;
+        }
+        anyTimer = true;
+        ostringstream total, mean, longest;
+        total << fixed << setprecision(2) << timer.totalSeconds * 1000.0;
+        mean << fixed << setprecision(3) << timer.totalSeconds * 1000.0 / timer.count;
+        longest << fixed << setprecision(3) << timer.maxSeconds * 1000.0;
+        timerTable.add_row({timer.name, to_string(timer.count), total.str(), mean.str(), longest.str()});
+    }
+    
+    if (anyTimer) {
+        timerTable[0].format().font_style({FontStyle::bold}).font_color(Color::cyan);
+        cout << timerTable << endl;
+    } else {
+        printInfo("No timed operations recorded yet.");
+    }
+    
+    Table counterTable;
+    counterTable.add_row({"Counter", "Value"});
+    for (const auto& counter : counters) {
+        counterTable.add_row({counter.name, to_string(counter.value)});
+    }
+    if (!counters.empty()) {
+        counterTable[0].format().font_style({FontStyle::bold}).font_color(Color::cyan);
+        cout << counterTable << endl;
+    }
+}
+
 // ADDED: Color legend function
 void MenuUtils::printColorLegend() {
     cout << "\n" << BOLD << "Grade Color Legend:" << RESET << endl;
@@ -246,89 +453,56 @@ void MenuUtils::printMenu(const std::vector<std::string>& items) {
     cout << table << endl;
 }
 
-// Add this to your MenuUtils.cpp file - replace the existing printWelcome() function
-
-void MenuUtils::printWelcome() {
-    system("cls");
+void MenuUtils::printWelcome(bool animated) {
+    clearScreen();
     
-    // Center spacing for console (adjust if needed)
-    cout << string(10, '\n'); // Top spacing to center vertically
-    
-    // ISTAD PRE-GEN4 with character-by-character animation
-    string text = R"(  ██╗███████╗████████╗ █████╗ ██████╗     ██████╗ ██████╗ ███████╗      ██████╗ ███████╗███╗   ██╗██╗  ██╗
+    if (animated) {
+        // Center spacing for console (adjust if needed)
+        cout << string(10, '\n'); // Top spacing to center vertically
+        
+        // ISTAD PRE-GEN4 with character-by-character animation
+        string text = R"(  ██╗███████╗████████╗ █████╗ ██████╗     ██████╗ ██████╗ ███████╗      ██████╗ ███████╗███╗   ██╗██╗  ██╗
   ██║██╔════╝╚══██╔══╝██╔══██╗██╔══██╗    ██╔══██╗██╔══██╗██╔════╝     ██╔════╝ ██╔════╝████╗  ██║██║  ██║
   ██║███████╗   ██║   ███████║██║  ██║    ██████╔╝██████╔╝█████╗       ██║  ███╗█████╗  ██╔██╗ ██║███████║
   ██║╚════██║   ██║   ██╔══██║██║  ██║    ██╔═══╝ ██╔══██╗██╔══╝       ██║   ██║██╔══╝  ██║╚██╗██║╚════██║
   ██║███████║   ██║   ██║  ██║██████╔╝    ██║     ██║  ██║███████╗     ╚██████╔╝███████╗██║ ╚████║     ██║
   ╚═╝╚══════╝   ╚═╝   ╚═╝  ╚═╝╚═════╝     ╚═╝     ╚═╝  ╚═╝╚══════╝      ╚═════╝ ╚══════╝╚═╝  ╚═══╝     ╚═╝)";
 
-    // Add leading spaces to center horizontally
-    cout << "        "; // Adjust spacing as needed
-    
-    cout << "\033[94m"; // Green color like your original
-    
-    // Animate each character
-    for (int i = 0; i < text.length(); i++) {
-        if (text[i] == '\n') {
-            cout << text[i];
-            cout << "        "; // Add spacing for next line
-            #ifdef _WIN32
-                Sleep(100); // Pause at line breaks
-            #else
-                usleep(200);
-            #endif
-        } else {
+        // Add leading spaces to center horizontally
+        cout << "        "; // Adjust spacing as needed
+        
+        cout << "\033[94m"; // Green color like your original
+        
+        // Animate each character
+        for (size_t i = 0; i < text.length(); i++) {
             cout << text[i];
-            cout.flush();
-            
-            // Different speeds for different characters
-            if (text[i] == '█') {
-                #ifdef _WIN32
-                    Sleep(30); // Slower for blocks
-                #else
-                    usleep(30000);
-                #endif
+            if (text[i] == '\n') {
+                cout << "        "; // Add spacing for next line
             } else if (text[i] != ' ') {
-                #ifdef _WIN32
-                    Sleep(15); // Normal speed
-                #else
-                    usleep(15000);
-                #endif
+                cout.flush();
+                // Block glyphs are multi-byte, so pause once per visible character
+                if ((static_cast<unsigned char>(text[i]) & 0xC0) != 0x80) {
+                    sleepMilliseconds(15);
+                }
             }
         }
-    }
-    cout << "\033[0m" << endl;
-    cout << endl;
-
-    // Centered loading animation
-    cout << "                                               "; // Center the loading text
-    cout << RED << "Loading";
-    
-    for (int i = 0; i < 3; i++) {
-        #ifdef _WIN32
-            Sleep(400);  // Windows Sleep function (milliseconds)
-        #else
-            system("sleep 1");
-        #endif
-        cout << ".";
-        cout.flush();
-    }
-    cout << RESET << endl;
+        cout << "\033[0m" << endl;
+        cout << endl;
 
-    // Wait for 2 seconds
-    #ifdef _WIN32
-        Sleep(2000);
-    #else
-        system("sleep 2");
-    #endif
-
-    #ifdef _WIN32
-        Sleep(2000);
-    #else
-        usleep(2000000);
-    #endif
+        // Centered loading animation
+        cout << "                                               "; // Center the loading text
+        cout << RED << "Loading";
+        
+        for (int i = 0; i < 3; i++) {
+            sleepMilliseconds(400);
+            cout << ".";
+            cout.flush();
+        }
+        cout << RESET << endl;
 
-    system("cls");
+        sleepMilliseconds(1000);
+        clearScreen();
+    }
 
     // Simple welcome message with hash borders (no animation) - CENTERED
     cout << GREEN << endl;
@@ -341,34 +515,28 @@ void MenuUtils::printWelcome() {
     cout << "                            #############################################################################" << endl;
     cout << RESET << endl;
 
+    if (!animated) {
+        cout << YELLOW << "                                           Developed by ISTAD Pre-Gen4 GroupI" << RESET << endl << endl;
+        return;
+    }
+
     // Small delay before developer credit
-    #ifdef _WIN32
-        Sleep(1000);
-    #else
-        usleep(1000000);
-    #endif
+    sleepMilliseconds(500);
 
     // Animated developer credit - CENTERED
     cout << YELLOW << "                                           ";
     string developer = "Developed by ISTAD Pre-Gen4 GroupI";
-    for (int i = 0; i < developer.length(); i++) {
+    for (size_t i = 0; i < developer.length(); i++) {
         cout << developer[i];
         cout.flush();
-        #ifdef _WIN32
-            Sleep(40);
-        #else
-            usleep(40000);
-        #endif
+        sleepMilliseconds(40);
     }
     cout << RESET << endl;
     cout << endl;
 
-    #ifdef _WIN32
-        Sleep(2000);
-    #else
-        usleep(2000000);
-    #endif
+    sleepMilliseconds(1000);
 }
+
 void MenuUtils::printMainMenu() {
     printHeader("MAIN MENU");
     
@@ -390,6 +558,8 @@ void MenuUtils::printAdminMenu() {
         "Import Excel Data",
         "Export Grade Report",
         "Backup Data",
+        "Run Query",
+        "Performance Stats",
         "Sign Out",
         "Back to Main Menu"
     };
@@ -541,15 +711,48 @@ double MenuUtils::getDoubleInput(const std::string& prompt) {
     }
 }
 
+void MenuUtils::setFastRendering(bool enabled) {
+    fastRendering = enabled;
+}
+
+bool MenuUtils::isFastRendering() {
+    return fastRendering;
+}
+
 // Utility methods
 void MenuUtils::clearScreen() {
+    // ANSI clear + cursor home instead of forking cls/clear
+    enableAnsiOutput();
+    cout << "\033[2J\033[H" << flush;
+}
+
+void MenuUtils::enableAnsiOutput() {
 #ifdef _WIN32
-    system("cls");  // Windows clear screen command
+    // Windows 10+ consoles understand ANSI once virtual terminal processing is on
+    static bool enabled = false;
+    if (!enabled) {
+        HANDLE handle = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD mode = 0;
+        if (handle != INVALID_HANDLE_VALUE && GetConsoleMode(handle, &mode)) {
+            SetConsoleMode(handle, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+        }
+        enabled = true;
+    }
+#endif
+}
+
+bool MenuUtils::isInteractiveTerminal() {
+#ifdef _WIN32
+    return _isatty(_fileno(stdout)) != 0;
 #else
-    system("clear");  // Unix/Linux clear screen command
+    return isatty(STDOUT_FILENO) != 0;
 #endif
 }
 
+void MenuUtils::sleepMilliseconds(int milliseconds) {
+    this_thread::sleep_for(chrono::milliseconds(milliseconds));
+}
+
 void MenuUtils::pauseScreen() {
     cout << CYAN << "\nPress Enter to continue..." << RESET;
     cin.get();
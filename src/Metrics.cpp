@@ -0,0 +1,198 @@
+#include "Metrics.hpp"
+#include "JsonUtil.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+
+using namespace std;
+
+const std::array<double, Metrics::BUCKET_COUNT - 1> Metrics::BUCKET_BOUNDS = {
+    0.00001, 0.0001, 0.001, 0.01, 0.1, 1.0, 10.0
+};
+
+namespace {
+    bool enabledFromEnvironment() {
+        const char* value = getenv("SCOREME_METRICS");
+        if (!value) {
+            return true;
+        }
+        string setting = value;
+        return !(setting == "0" || setting == "off" || setting == "false");
+    }
+
+    // Node-based maps so references handed out never move
+    struct Registry {
+        mutex lock;
+        map<string, unique_ptr<Metrics::Timer>> timers;
+        map<string, unique_ptr<Metrics::Counter>> counters;
+    };
+
+    Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    string prometheusName(const string& name) {
+        string result = "scoreme_";
+        for (char c : name) {
+            result += isalnum(static_cast<unsigned char>(c)) ? c : '_';
+        }
+        return result;
+    }
+}
+
+std::atomic<bool> Metrics::enabled{enabledFromEnvironment()};
+
+void Metrics::Timer::record(uint64_t nanoseconds) {
+    count.fetch_add(1, memory_order_relaxed);
+    totalNanoseconds.fetch_add(nanoseconds, memory_order_relaxed);
+
+    uint64_t previous = maxNanoseconds.load(memory_order_relaxed);
+    while (nanoseconds > previous &&
+           !maxNanoseconds.compare_exchange_weak(previous, nanoseconds, memory_order_relaxed)) {
+    }
+
+    double seconds = static_cast<double>(nanoseconds) * 1e-9;
+    size_t bucket = 0;
+    while (bucket < BUCKET_BOUNDS.size() && seconds > BUCKET_BOUNDS[bucket]) {
+        ++bucket;
+    }
+    buckets[bucket].fetch_add(1, memory_order_relaxed);
+}
+
+Metrics::Timer& Metrics::timer(const std::string& name) {
+    Registry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    auto& slot = r.timers[name];
+    if (!slot) {
+        slot = make_unique<Timer>(name);
+    }
+    return *slot;
+}
+
+Metrics::Counter& Metrics::counter(const std::string& name) {
+    Registry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    auto& slot = r.counters[name];
+    if (!slot) {
+        slot = make_unique<Counter>(name);
+    }
+    return *slot;
+}
+
+void Metrics::setEnabled(bool on) {
+    enabled.store(on);
+}
+
+void Metrics::reset() {
+    Registry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    for (auto& entry : r.timers) {
+        Timer& t = *entry.second;
+        t.count = 0;
+        t.totalNanoseconds = 0;
+        t.maxNanoseconds = 0;
+        for (auto& bucket : t.buckets) {
+            bucket = 0;
+        }
+    }
+    for (auto& entry : r.counters) {
+        entry.second->value = 0;
+    }
+}
+
+std::vector<Metrics::TimerStats> Metrics::timerStats() {
+    Registry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    vector<TimerStats> stats;
+    for (const auto& entry : r.timers) {
+        const Timer& t = *entry.second;
+        stats.push_back({t.name, t.count.load(), t.totalNanoseconds.load() * 1e-9, t.maxNanoseconds.load() * 1e-9});
+    }
+    return stats;
+}
+
+std::vector<Metrics::CounterStats> Metrics::counterStats() {
+    Registry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    vector<CounterStats> stats;
+    for (const auto& entry : r.counters) {
+        stats.push_back({entry.second->name, entry.second->value.load()});
+    }
+    return stats;
+}
+
+// Exporters
+void Metrics::writePrometheus(std::ostream& out) {
+    Registry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    out << setprecision(9);
+
+    for (const auto& entry : r.timers) {
+        const Timer& t = *entry.second;
+        string name = prometheusName(t.name) + "_seconds";
+        out << "# TYPE " << name << " histogram\n";
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            cumulative += t.buckets[i].load();
+            out << name << "_bucket{le=\"";
+            if (i < BUCKET_BOUNDS.size()) out << BUCKET_BOUNDS[i]; else out << "+Inf";
+            out << "\"} " << cumulative << "\n";
+        }
+        out << name << "_sum " << t.totalNanoseconds.load() * 1e-9 << "\n"
+            << name << "_count " << t.count.load() << "\n";
+    }
+
+    for (const auto& entry : r.counters) {
+        string name = prometheusName(entry.second->name) + "_total";
+        out << "# TYPE " << name << " counter\n"
+            << name << " " << entry.second->value.load() << "\n";
+    }
+}
+
+void Metrics::writeJson(std::ostream& out) {
+    auto timers = timerStats();
+    auto counters = counterStats();
+    out << setprecision(9) << "{\"timers\":{";
+    for (size_t i = 0; i < timers.size(); ++i) {
+        const auto& t = timers[i];
+        if (i > 0) out << ",";
+        out << JsonUtil::quote(t.name) << ":{\"count\":" << t.count
+            << ",\"total_seconds\":" << t.totalSeconds
+            << ",\"mean_seconds\":" << (t.count > 0 ? t.totalSeconds / t.count : 0.0)
+            << ",\"max_seconds\":" << t.maxSeconds << "}";
+    }
+    out << "},\"counters\":{";
+    for (size_t i = 0; i < counters.size(); ++i) {
+        if (i > 0) out << ",";
+        out << JsonUtil::quote(counters[i].name) << ":" << counters[i].value;
+    }
+    out << "}}";
+}
+
+bool Metrics::writeFile(const std::string& filename) {
+    ofstream file(filename, ios::trunc);
+    if (!file) {
+        return false;
+    }
+    bool json = filename.size() >= 5 && filename.compare(filename.size() - 5, 5, ".json") == 0;
+    if (json) {
+        writeJson(file);
+        file << "\n";
+    } else {
+        writePrometheus(file);
+    }
+    return static_cast<bool>(file);
+}
+
+void Metrics::writeFileFromEnvironment() {
+    const char* filename = getenv("SCOREME_METRICS_FILE");
+    if (filename && *filename && !writeFile(filename)) {
+        cerr << "Could not write metrics to " << filename << endl;
+    }
+}
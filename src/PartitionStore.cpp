@@ -0,0 +1,246 @@
+#include "PartitionStore.hpp"
+#include "ExcelUtil.hpp"
+#include "JsonUtil.hpp"
+#include "MemoryStats.hpp"
+#include "Metrics.hpp"
+#include "SortUtil.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+const char* const PartitionStore::DEFAULT_DIRECTORY = "data/partitions";
+const char* const PartitionStore::MANIFEST_FILE = "manifest.jsonl";
+
+PartitionStore::PartitionStore(const std::string& directory) : directory(directory) {
+    ifstream manifest(directory + "/" + MANIFEST_FILE);
+    string line;
+    size_t lineNumber = 0;
+    while (getline(manifest, line)) {
+        ++lineNumber;
+        if (line.find_first_not_of(" \t\r") == string::npos) {
+            continue;
+        }
+        try {
+            auto fields = JsonUtil::parseFlatObject(line);
+            Partition partition;
+            partition.name = fields.at("name");
+            partition.students = stoul(fields.at("students"));
+            partition.firstId = fields.count("first_id") ? fields["first_id"] : "";
+            partition.lastId = fields.count("last_id") ? fields["last_id"] : "";
+            if (!isValidName(partition.name)) {
+                throw runtime_error("bad partition name '" + partition.name + "'");
+            }
+            entries.push_back(partition);
+        }
+        catch (const exception& e) {
+            throw runtime_error(directory + "/" + MANIFEST_FILE + " line " + to_string(lineNumber) + ": " + e.what());
+        }
+    }
+}
+
+bool PartitionStore::isValidName(const std::string& name) {
+    if (name.empty() || name == "all" || name[0] == '.') {
+        return false;
+    }
+    return all_of(name.begin(), name.end(), [](char c) {
+        return isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_' || c == '.';
+    });
+}
+
+std::string PartitionStore::pathFor(const std::string& name) const {
+    return directory + "/" + name + ".xlsx";
+}
+
+bool PartitionStore::contains(const std::string& name) const {
+    return any_of(entries.begin(), entries.end(), [&name](const Partition& p) { return p.name == name; });
+}
+
+const PartitionStore::Partition& PartitionStore::find(const std::string& name) const {
+    for (const auto& partition : entries) {
+        if (partition.name == name) {
+            return partition;
+        }
+    }
+    throw runtime_error("unknown partition '" + name + "'");
+}
+
+std::vector<std::string> PartitionStore::select(const std::string& list) const {
+    vector<string> names;
+    if (list == "all") {
+        for (const auto& partition : entries) {
+            names.push_back(partition.name);
+        }
+        return names;
+    }
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = list.find(',', start);
+        string name = list.substr(start, comma == string::npos ? string::npos : comma - start);
+        if (!name.empty()) {
+            find(name);
+            if (std::find(names.begin(), names.end(), name) == names.end()) {
+                names.push_back(name);
+            }
+        }
+        if (comma == string::npos) break;
+        start = comma + 1;
+    }
+    if (names.empty()) {
+        throw runtime_error("no partitions selected");
+    }
+    return names;
+}
+
+std::vector<std::string> PartitionStore::partitionsForIds(const std::string& firstId, const std::string& lastId) const {
+    vector<string> names;
+    for (const auto& partition : entries) {
+        if (partition.students > 0 && lastId >= partition.firstId && firstId <= partition.lastId) {
+            names.push_back(partition.name);
+        }
+    }
+    return names;
+}
+
+void PartitionStore::scan(const std::vector<std::string>& names,
+                          const std::function<void(const Partition&, std::vector<Student>&)>& visit) const {
+    vector<const Partition*> selected;
+    for (const auto& name : names) {
+        selected.push_back(&find(name));
+    }
+
+    // Workers inherit the caller's memory tag, e.g. IMPORT while staging
+    MemoryStats::Tag tag = MemoryStats::currentTag();
+    atomic<size_t> next{0};
+    mutex errorMutex;
+    exception_ptr firstError;
+
+    auto work = [&]() {
+        MemoryStats::Scope memoryScope(tag);
+        for (size_t i; (i = next++) < selected.size();) {
+            try {
+                const Partition& partition = *selected[i];
+                string path = pathFor(partition.name);
+                if (!ExcelUtils::fileExists(path)) {
+                    throw runtime_error("partition '" + partition.name + "' has no file " + path);
+                }
+                // A short or unreadable partition must never reach a caller that saves it back
+                vector<Student> students;
+                string error;
+                if (!ExcelUtils::readStudents(path, students, error)) {
+                    throw runtime_error("cannot read partition '" + partition.name + "': " + error);
+                }
+                if (students.size() != partition.students) {
+                    throw runtime_error("partition '" + partition.name + "' holds " + to_string(students.size()) +
+                                        " students but the manifest says " + to_string(partition.students));
+                }
+                visit(partition, students);
+            }
+            catch (...) {
+                lock_guard<mutex> lock(errorMutex);
+                if (!firstError) firstError = current_exception();
+                next = selected.size();
+            }
+        }
+    };
+
+    SCOREME_TIME_SCOPE("partition_scan");
+    size_t workers = min(selected.size(), SortUtil::workerCount());
+    if (workers <= 1) {
+        work();
+    } else {
+        vector<thread> threads;
+        for (size_t i = 0; i < workers; ++i) {
+            threads.emplace_back(work);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    SCOREME_COUNT("partitions_read", selected.size());
+    if (firstError) {
+        rethrow_exception(firstError);
+    }
+}
+
+std::vector<Student> PartitionStore::load(const std::vector<std::string>& names) const {
+    // Each partition lands in its own slot; they are joined in the order asked for
+    vector<vector<Student>> slots(names.size());
+    scan(names, [&names, &slots](const Partition& partition, vector<Student>& students) {
+        size_t slot = static_cast<size_t>(std::find(names.begin(), names.end(), partition.name) - names.begin());
+        slots[slot] = std::move(students);
+    });
+
+    size_t total = 0;
+    for (const auto& slot : slots) {
+        total += slot.size();
+    }
+    vector<Student> students;
+    students.reserve(total);
+    for (auto& slot : slots) {
+        move(slot.begin(), slot.end(), back_inserter(students));
+    }
+    return students;
+}
+
+bool PartitionStore::save(const std::string& name, const std::vector<Student>& students) {
+    if (!isValidName(name)) {
+        cerr << "Invalid partition name '" << name << "'" << endl;
+        return false;
+    }
+    filesystem::create_directories(directory);
+    if (!ExcelUtils::writeExcel(pathFor(name), students)) {
+        return false;
+    }
+
+    Partition updated;
+    updated.name = name;
+    updated.students = students.size();
+    for (const auto& student : students) {
+        const string& id = student.getStudentId();
+        if (updated.firstId.empty() || id < updated.firstId) updated.firstId = id;
+        if (updated.lastId.empty() || id > updated.lastId) updated.lastId = id;
+    }
+
+    auto existing = find_if(entries.begin(), entries.end(), [&name](const Partition& p) { return p.name == name; });
+    if (existing != entries.end()) {
+        *existing = updated;
+    } else {
+        entries.push_back(updated);
+    }
+    return writeManifest();
+}
+
+bool PartitionStore::writeManifest() const {
+    // Replaced in one rename, so readers never see half a manifest
+    string path = directory + "/" + MANIFEST_FILE;
+    string tempPath = path + ".tmp";
+    {
+        ofstream out(tempPath, ios::trunc);
+        for (const auto& partition : entries) {
+            out << "{\"name\":" << JsonUtil::quote(partition.name)
+                << ",\"students\":" << partition.students
+                << ",\"first_id\":" << JsonUtil::quote(partition.firstId)
+                << ",\"last_id\":" << JsonUtil::quote(partition.lastId) << "}\n";
+        }
+        if (!out) {
+            cerr << "Error writing " << tempPath << endl;
+            return false;
+        }
+    }
+    error_code error;
+    filesystem::rename(tempPath, path, error);
+    if (error) {
+        cerr << "Error replacing " << path << ": " << error.message() << endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,178 @@
+#include "PasswordHash.hpp"
+#include "CredentialIndex.hpp"
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+using namespace std;
+
+const unsigned PasswordHash::ITERATIONS = 1000;
+const unsigned PasswordHash::FIXTURE_ITERATIONS = 1;
+
+namespace {
+    const string PREFIX = "$sha256$";
+
+    const uint32_t ROUND_CONSTANTS[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    uint32_t rotateRight(uint32_t value, int bits) {
+        return (value >> bits) | (value << (32 - bits));
+    }
+
+    void compress(uint32_t state[8], const unsigned char block[64]) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = (uint32_t(block[4 * i]) << 24) | (uint32_t(block[4 * i + 1]) << 16) |
+                   (uint32_t(block[4 * i + 2]) << 8) | uint32_t(block[4 * i + 3]);
+        }
+        for (int i = 16; i < 64; ++i) {
+            uint32_t s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t s1 = rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25);
+            uint32_t choice = (e & f) ^ (~e & g);
+            uint32_t t1 = h + s1 + choice + ROUND_CONSTANTS[i] + w[i];
+            uint32_t s0 = rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22);
+            uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+            uint32_t t2 = s0 + majority;
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+
+    string toHex(const string& bytes) {
+        static const char digits[] = "0123456789abcdef";
+        string hex;
+        hex.reserve(bytes.size() * 2);
+        for (unsigned char c : bytes) {
+            hex += digits[c >> 4];
+            hex += digits[c & 0x0F];
+        }
+        return hex;
+    }
+
+    bool fromHex(const string& hex, string& bytes) {
+        if (hex.size() % 2 != 0) {
+            return false;
+        }
+        auto nibble = [](char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            return -1;
+        };
+        bytes.clear();
+        for (size_t i = 0; i < hex.size(); i += 2) {
+            int high = nibble(hex[i]);
+            int low = nibble(hex[i + 1]);
+            if (high < 0 || low < 0) {
+                return false;
+            }
+            bytes += static_cast<char>((high << 4) | low);
+        }
+        return true;
+    }
+}
+
+std::string PasswordHash::sha256(const std::string& data) {
+    uint32_t state[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                         0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+    size_t full = data.size() / 64 * 64;
+    for (size_t offset = 0; offset < full; offset += 64) {
+        compress(state, reinterpret_cast<const unsigned char*>(data.data() + offset));
+    }
+
+    // Final block(s): the tail, a 1 bit, zeros, then the length in bits
+    unsigned char tail[128] = {};
+    size_t rest = data.size() - full;
+    for (size_t i = 0; i < rest; ++i) {
+        tail[i] = static_cast<unsigned char>(data[full + i]);
+    }
+    tail[rest] = 0x80;
+    size_t tailSize = rest + 9 <= 64 ? 64 : 128;
+    uint64_t bits = static_cast<uint64_t>(data.size()) * 8;
+    for (int i = 0; i < 8; ++i) {
+        tail[tailSize - 1 - i] = static_cast<unsigned char>(bits >> (8 * i));
+    }
+    compress(state, tail);
+    if (tailSize == 128) {
+        compress(state, tail + 64);
+    }
+
+    string digest(32, '\0');
+    for (int i = 0; i < 8; ++i) {
+        digest[4 * i] = static_cast<char>(state[i] >> 24);
+        digest[4 * i + 1] = static_cast<char>(state[i] >> 16);
+        digest[4 * i + 2] = static_cast<char>(state[i] >> 8);
+        digest[4 * i + 3] = static_cast<char>(state[i]);
+    }
+    return digest;
+}
+
+std::string PasswordHash::derive(const std::string& password, const std::string& salt, unsigned iterations) {
+    string digest = sha256(salt + password);
+    for (unsigned i = 1; i < iterations; ++i) {
+        digest = sha256(digest + salt + password);
+    }
+    return digest;
+}
+
+std::string PasswordHash::hash(const std::string& password, unsigned iterations) {
+    // Every salt comes straight from the OS entropy source
+    thread_local random_device device;
+    string salt(16, '\0');
+    for (size_t i = 0; i < salt.size(); i += 4) {
+        uint32_t bits = device();
+        for (size_t j = 0; j < 4; ++j) {
+            salt[i + j] = static_cast<char>(bits >> (8 * j));
+        }
+    }
+    return PREFIX + to_string(iterations) + "$" + toHex(salt) + "$" + toHex(derive(password, salt, iterations));
+}
+
+bool PasswordHash::isHash(const std::string& stored) {
+    return stored.compare(0, PREFIX.size(), PREFIX) == 0;
+}
+
+bool PasswordHash::verify(const std::string& password, const std::string& stored) {
+    if (!isHash(stored)) {
+        return CredentialIndex::constantTimeEquals(stored, password);
+    }
+
+    size_t saltStart = stored.find('$', PREFIX.size());
+    size_t digestStart = saltStart == string::npos ? string::npos : stored.find('$', saltStart + 1);
+    if (digestStart == string::npos) {
+        return false;
+    }
+
+    string salt;
+    string expected;
+    unsigned long iterations = 0;
+    try {
+        iterations = stoul(stored.substr(PREFIX.size(), saltStart - PREFIX.size()));
+    }
+    catch (const exception&) {
+        return false;
+    }
+    if (iterations == 0 || iterations > 1000000 ||
+        !fromHex(stored.substr(saltStart + 1, digestStart - saltStart - 1), salt) ||
+        !fromHex(stored.substr(digestStart + 1), expected)) {
+        return false;
+    }
+    return CredentialIndex::constantTimeEquals(derive(password, salt, static_cast<unsigned>(iterations)), expected);
+}
@@ -1,19 +1,21 @@
 #include "Person.hpp"
 #include "MenuUtils.hpp"
+#include "CredentialIndex.hpp"
+#include "PasswordHash.hpp"
 #include <iostream>
 
 Person::Person(const std::string& username, const std::string& password, const std::string& name)
     : username(username), password(password), name(name) {}
 
-std::string Person::getUsername() const {
+const std::string& Person::getUsername() const {
     return username;
 }
 
-std::string Person::getPassword() const {
+const std::string& Person::getPassword() const {
     return password;
 }
 
-std::string Person::getName() const {
+const std::string& Person::getName() const {
     return name;
 }
 
@@ -34,5 +36,7 @@ std::string Person::getHiddenPassword() const {
 }
 
 bool Person::validateCredentials(const std::string& inputUsername, const std::string& inputPassword) const {
-    return (username == inputUsername && password == inputPassword);
+    bool usernameMatches = CredentialIndex::constantTimeEquals(username, inputUsername);
+    bool passwordMatches = PasswordHash::verify(inputPassword, password);
+    return usernameMatches && passwordMatches;
 }
\ No newline at end of file
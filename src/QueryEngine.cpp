@@ -0,0 +1,655 @@
+#include "QueryEngine.hpp"
+#include "GradeUtil.hpp"
+#include "SortUtil.hpp"
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    // Column layout; subjects follow FIRST_SUBJECT in getSubjectNames() order
+    enum Column {
+        COL_ID, COL_NAME, COL_AGE, COL_GENDER, COL_DOB, COL_EMAIL,
+        COL_AVERAGE, COL_GRADE, COL_GPA, COL_REMARK, COL_UPDATED,
+        FIRST_SUBJECT
+    };
+
+    enum class Op { EQ, NE, LT, LE, GT, GE, CONTAINS };
+
+    std::string toLower(const std::string& text) {
+        std::string result = text;
+        for (char& c : result) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return result;
+    }
+
+    // Lowercase with spaces and underscores dropped, so "Computer Science" == computer_science
+    std::string columnKey(const std::string& text) {
+        std::string result;
+        for (char c : text) {
+            if (c != ' ' && c != '_') {
+                result += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+        }
+        return result;
+    }
+
+    int columnCount() {
+        return FIRST_SUBJECT + static_cast<int>(GradeUtil::getSubjectNames().size());
+    }
+
+    // Tokenizer
+    struct Token {
+        enum Type { IDENT, NUMBER, STRING, OP, LPAREN, RPAREN, COMMA, STAR, END } type;
+        std::string text;
+        double number = 0.0;
+    };
+
+    std::vector<Token> tokenize(const std::string& text) {
+        std::vector<Token> tokens;
+        size_t i = 0;
+
+        while (i < text.size()) {
+            char c = text[i];
+            if (std::isspace(static_cast<unsigned char>(c))) {
+                ++i;
+            }
+            else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                size_t start = i;
+                while (i < text.size() && (std::isalnum(static_cast<unsigned char>(text[i])) ||
+                                           text[i] == '_' || text[i] == '.' || text[i] == '@' || text[i] == '-')) {
+                    ++i;
+                }
+                tokens.push_back({Token::IDENT, text.substr(start, i - start)});
+            }
+            else if (std::isdigit(static_cast<unsigned char>(c)) ||
+                     (c == '.' && i + 1 < text.size() && std::isdigit(static_cast<unsigned char>(text[i + 1]))) ||
+                     (c == '-' && i + 1 < text.size() && std::isdigit(static_cast<unsigned char>(text[i + 1])))) {
+                size_t start = i++;
+                while (i < text.size() && (std::isdigit(static_cast<unsigned char>(text[i])) || text[i] == '.')) {
+                    ++i;
+                }
+                Token token{Token::NUMBER, text.substr(start, i - start)};
+                try {
+                    token.number = std::stod(token.text);
+                }
+                catch (...) {
+                    throw std::runtime_error("Invalid number '" + token.text + "'");
+                }
+                tokens.push_back(token);
+            }
+            else if (c == '\'' || c == '"') {
+                size_t end = text.find(c, i + 1);
+                if (end == std::string::npos) {
+                    throw std::runtime_error("Unterminated string starting at position " + std::to_string(i + 1));
+                }
+                tokens.push_back({Token::STRING, text.substr(i + 1, end - i - 1)});
+                i = end + 1;
+            }
+            else if (c == '(') { tokens.push_back({Token::LPAREN, "("}); ++i; }
+            else if (c == ')') { tokens.push_back({Token::RPAREN, ")"}); ++i; }
+            else if (c == ',') { tokens.push_back({Token::COMMA, ","}); ++i; }
+            else if (c == '*') { tokens.push_back({Token::STAR, "*"}); ++i; }
+            else if (c == '=' || c == '!' || c == '<' || c == '>') {
+                std::string op(1, c);
+                if (i + 1 < text.size() && (text[i + 1] == '=' || (c == '<' && text[i + 1] == '>'))) {
+                    op += text[i + 1];
+                }
+                if (op == "!") {
+                    throw std::runtime_error("Unexpected '!' (did you mean '!=')");
+                }
+                tokens.push_back({Token::OP, op});
+                i += op.size();
+            }
+            else {
+                throw std::runtime_error(std::string("Unexpected character '") + c + "'");
+            }
+        }
+
+        tokens.push_back({Token::END, "end of query"});
+        return tokens;
+    }
+
+    // Column-wise copy of the fields a query touches
+    struct ColumnStore {
+        std::vector<std::vector<double>> numeric;
+        std::vector<std::vector<std::string>> text;
+    };
+
+    double numericValue(const Student& student, const std::vector<double>& scores, int column) {
+        switch (column) {
+            case COL_AGE: return student.getAge();
+            case COL_AVERAGE: return student.getAverageScore();
+            case COL_GRADE: return GradeUtil::gradeRank(student.getLetterGrade());
+            case COL_GPA: return student.getGpa();
+            default: {
+                size_t subject = static_cast<size_t>(column - FIRST_SUBJECT);
+                return subject < scores.size() ? scores[subject] : 0.0;
+            }
+        }
+    }
+
+    std::string textValue(const Student& student, int column) {
+        switch (column) {
+            case COL_ID: return student.getStudentId();
+            case COL_NAME: return student.getName();
+            case COL_GENDER: return student.getGender();
+            case COL_DOB: return student.getDateOfBirth();
+            case COL_EMAIL: return student.getEmail();
+            case COL_REMARK: return student.getRemark();
+            case COL_UPDATED: return student.getFormattedTimestamp();
+            default: return "";
+        }
+    }
+
+    std::string formatNumber(double value, int decimals) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(decimals) << value;
+        return oss.str();
+    }
+
+    std::string formatCell(const Student& student, int column) {
+        switch (column) {
+            case COL_AGE: return std::to_string(student.getAge());
+            case COL_AVERAGE: return formatNumber(student.getAverageScore(), 2);
+            case COL_GRADE: return student.getLetterGrade();
+            case COL_GPA: return formatNumber(student.getGpa(), 1);
+            default:
+                if (column >= FIRST_SUBJECT) {
+                    const auto& scores = student.getSubjectScores();
+                    size_t subject = static_cast<size_t>(column - FIRST_SUBJECT);
+                    return subject < scores.size() ? formatNumber(scores[subject], 1) : "";
+                }
+                return textValue(student, column);
+        }
+    }
+}
+
+// Expression tree node
+struct CompiledQuery::Node {
+    enum Kind { COMPARE, AND, OR, NOT } kind = COMPARE;
+    int column = -1;
+    Op op = Op::EQ;
+    double number = 0.0;
+    std::string text;       // Lowercased for text comparisons
+    std::unique_ptr<Node> left;
+    std::unique_ptr<Node> right;
+};
+
+CompiledQuery::CompiledQuery() : limit(std::numeric_limits<size_t>::max()) {}
+CompiledQuery::~CompiledQuery() = default;
+CompiledQuery::CompiledQuery(CompiledQuery&&) noexcept = default;
+CompiledQuery& CompiledQuery::operator=(CompiledQuery&&) noexcept = default;
+
+namespace {
+    using Node = CompiledQuery::Node;
+
+    // Recursive-descent parser
+    class Parser {
+    public:
+        explicit Parser(const std::string& text) : tokens(tokenize(text)) {}
+
+        CompiledQuery parse() {
+            CompiledQuery query;
+            bool seenWhere = false, seenOrder = false, seenLimit = false, seenSelect = false;
+
+            while (peek().type != Token::END) {
+                if (acceptKeyword("where")) {
+                    once(seenWhere, "where");
+                    query.filter = parseOr();
+                }
+                else if (acceptKeyword("order")) {
+                    once(seenOrder, "order by");
+                    expectKeyword("by");
+                    do {
+                        CompiledQuery::SortKey key{expectColumn(), false};
+                        if (acceptKeyword("desc")) key.descending = true;
+                        else acceptKeyword("asc");
+                        query.orderBy.push_back(key);
+                    } while (accept(Token::COMMA));
+                }
+                else if (acceptKeyword("limit")) {
+                    once(seenLimit, "limit");
+                    const Token& token = next();
+                    if (token.type != Token::NUMBER || token.number < 0) {
+                        throw std::runtime_error("limit expects a non-negative number");
+                    }
+                    query.limit = static_cast<size_t>(token.number);
+                }
+                else if (acceptKeyword("select")) {
+                    once(seenSelect, "select");
+                    if (accept(Token::STAR)) {
+                        for (int c = 0; c < columnCount(); ++c) {
+                            query.projection.push_back(c);
+                        }
+                    } else {
+                        do {
+                            query.projection.push_back(expectColumn());
+                        } while (accept(Token::COMMA));
+                    }
+                }
+                else {
+                    throw std::runtime_error("Expected where, order by, limit or select but found '" + peek().text + "'");
+                }
+            }
+
+            if (query.projection.empty()) {
+                query.projection = {COL_ID, COL_NAME, COL_AVERAGE, COL_GRADE, COL_GPA, COL_REMARK};
+            }
+            return query;
+        }
+
+    private:
+        std::vector<Token> tokens;
+        size_t current = 0;
+
+        const Token& peek() const { return tokens[current]; }
+        const Token& next() { return tokens[current < tokens.size() - 1 ? current++ : current]; }
+
+        bool isKeyword(const Token& token, const char* keyword) const {
+            return token.type == Token::IDENT && toLower(token.text) == keyword;
+        }
+
+        bool accept(Token::Type type) {
+            if (peek().type == type) {
+                ++current;
+                return true;
+            }
+            return false;
+        }
+
+        bool acceptKeyword(const char* keyword) {
+            if (isKeyword(peek(), keyword)) {
+                ++current;
+                return true;
+            }
+            return false;
+        }
+
+        void expectKeyword(const char* keyword) {
+            if (!acceptKeyword(keyword)) {
+                throw std::runtime_error(std::string("Expected '") + keyword + "' but found '" + peek().text + "'");
+            }
+        }
+
+        void once(bool& seen, const char* clause) {
+            if (seen) {
+                throw std::runtime_error(std::string("Clause '") + clause + "' given more than once");
+            }
+            seen = true;
+        }
+
+        int expectColumn() {
+            const Token& token = next();
+            int column = (token.type == Token::IDENT || token.type == Token::STRING)
+                       ? QueryEngine::columnForName(token.text) : -1;
+            if (column < 0) {
+                throw std::runtime_error("Unknown column '" + token.text + "'");
+            }
+            return column;
+        }
+
+        std::unique_ptr<Node> parseOr() {
+            auto node = parseAnd();
+            while (acceptKeyword("or")) {
+                auto parent = std::make_unique<Node>();
+                parent->kind = Node::OR;
+                parent->left = std::move(node);
+                parent->right = parseAnd();
+                node = std::move(parent);
+            }
+            return node;
+        }
+
+        std::unique_ptr<Node> parseAnd() {
+            auto node = parseUnary();
+            while (acceptKeyword("and")) {
+                auto parent = std::make_unique<Node>();
+                parent->kind = Node::AND;
+                parent->left = std::move(node);
+                parent->right = parseUnary();
+                node = std::move(parent);
+            }
+            return node;
+        }
+
+        std::unique_ptr<Node> parseUnary() {
+            if (acceptKeyword("not")) {
+                auto node = std::make_unique<Node>();
+                node->kind = Node::NOT;
+                node->left = parseUnary();
+                return node;
+            }
+            if (accept(Token::LPAREN)) {
+                auto node = parseOr();
+                if (!accept(Token::RPAREN)) {
+                    throw std::runtime_error("Missing ')'");
+                }
+                return node;
+            }
+            return parseComparison();
+        }
+
+        std::unique_ptr<Node> parseComparison() {
+            auto node = std::make_unique<Node>();
+            node->column = expectColumn();
+
+            const Token& opToken = next();
+            if (opToken.type == Token::OP) {
+                const std::string& op = opToken.text;
+                if (op == "=" || op == "==") node->op = Op::EQ;
+                else if (op == "!=" || op == "<>") node->op = Op::NE;
+                else if (op == "<") node->op = Op::LT;
+                else if (op == "<=") node->op = Op::LE;
+                else if (op == ">") node->op = Op::GT;
+                else node->op = Op::GE;
+            } else if (isKeyword(opToken, "contains")) {
+                node->op = Op::CONTAINS;
+            } else {
+                throw std::runtime_error("Expected a comparison operator but found '" + opToken.text + "'");
+            }
+
+            const Token& value = next();
+            if (value.type != Token::NUMBER && value.type != Token::STRING && value.type != Token::IDENT) {
+                throw std::runtime_error("Expected a value but found '" + value.text + "'");
+            }
+
+            if (QueryEngine::isNumericColumn(node->column)) {
+                if (node->op == Op::CONTAINS) {
+                    throw std::runtime_error("'contains' only works on text columns");
+                }
+                if (value.type == Token::NUMBER) {
+                    node->number = value.number;
+                } else if (node->column == COL_GRADE && value.text.size() == 1 &&
+                           std::string("ABCDEFabcdef").find(value.text[0]) != std::string::npos) {
+                    std::string grade(1, static_cast<char>(std::toupper(static_cast<unsigned char>(value.text[0]))));
+                    node->number = GradeUtil::gradeRank(grade);
+                } else {
+                    throw std::runtime_error("Column '" + QueryEngine::getColumnNames()[node->column] +
+                                             "' expects a number but got '" + value.text + "'");
+                }
+            } else {
+                node->text = toLower(value.text);
+            }
+
+            return node;
+        }
+    };
+
+    // Works on a roster vector or on RosterPages
+    template <typename Roster>
+    void fillColumns(ColumnStore& store, const Roster& students, const std::vector<bool>& needed) {
+        int count = columnCount();
+        store.numeric.assign(count, {});
+        store.text.assign(count, {});
+
+        for (int c = 0; c < count; ++c) {
+            if (!needed[c]) continue;
+            if (QueryEngine::isNumericColumn(c)) {
+                store.numeric[c].resize(students.size());
+            } else {
+                store.text[c].resize(students.size());
+            }
+        }
+
+        for (size_t row = 0; row < students.size(); ++row) {
+            const Student& student = students[row];
+            const std::vector<double>& scores = student.getSubjectScores();
+            for (int c = 0; c < count; ++c) {
+                if (!needed[c]) continue;
+                if (QueryEngine::isNumericColumn(c)) {
+                    store.numeric[c][row] = numericValue(student, scores, c);
+                } else {
+                    store.text[c][row] = toLower(textValue(student, c));
+                }
+            }
+        }
+    }
+
+    // Order positions by the sort keys, keeping only the first limit when it is smaller
+    void orderPositions(std::vector<uint32_t>& positions, const ColumnStore& store,
+                        const std::vector<CompiledQuery::SortKey>& keys, size_t limit) {
+        if (keys.empty()) {
+            return;
+        }
+
+        auto before = [&store, &keys](uint32_t a, uint32_t b) {
+            for (const auto& key : keys) {
+                int cmp;
+                if (QueryEngine::isNumericColumn(key.column)) {
+                    double x = store.numeric[key.column][a];
+                    double y = store.numeric[key.column][b];
+                    cmp = (x < y) ? -1 : (x > y ? 1 : 0);
+                } else {
+                    cmp = store.text[key.column][a].compare(store.text[key.column][b]);
+                }
+                if (cmp != 0) {
+                    return key.descending ? cmp > 0 : cmp < 0;
+                }
+            }
+            return false;
+        };
+
+        SortUtil::sortIndices(positions, before, limit < positions.size() ? limit : 0);
+    }
+
+    void markColumns(const Node* node, std::vector<bool>& needed) {
+        if (!node) return;
+        if (node->kind == Node::COMPARE) {
+            needed[node->column] = true;
+        }
+        markColumns(node->left.get(), needed);
+        markColumns(node->right.get(), needed);
+    }
+
+    // Numeric comparisons run as one tight loop per column so the compiler can vectorize them
+    template <typename Compare>
+    void compareColumn(const double* values, size_t count, double operand, uint8_t* out, Compare compare) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = compare(values[i], operand) ? 1 : 0;
+        }
+    }
+
+    std::vector<uint8_t> evaluate(const Node& node, const ColumnStore& store, size_t count) {
+        std::vector<uint8_t> mask(count, 0);
+
+        switch (node.kind) {
+            case Node::AND: {
+                mask = evaluate(*node.left, store, count);
+                std::vector<uint8_t> right = evaluate(*node.right, store, count);
+                for (size_t i = 0; i < count; ++i) mask[i] &= right[i];
+                break;
+            }
+            case Node::OR: {
+                mask = evaluate(*node.left, store, count);
+                std::vector<uint8_t> right = evaluate(*node.right, store, count);
+                for (size_t i = 0; i < count; ++i) mask[i] |= right[i];
+                break;
+            }
+            case Node::NOT: {
+                mask = evaluate(*node.left, store, count);
+                for (size_t i = 0; i < count; ++i) mask[i] ^= 1;
+                break;
+            }
+            case Node::COMPARE: {
+                if (QueryEngine::isNumericColumn(node.column)) {
+                    const double* values = store.numeric[node.column].data();
+                    uint8_t* out = mask.data();
+                    double x = node.number;
+                    switch (node.op) {
+                        case Op::EQ: compareColumn(values, count, x, out, [](double a, double b) { return a == b; }); break;
+                        case Op::NE: compareColumn(values, count, x, out, [](double a, double b) { return a != b; }); break;
+                        case Op::LT: compareColumn(values, count, x, out, [](double a, double b) { return a < b; }); break;
+                        case Op::LE: compareColumn(values, count, x, out, [](double a, double b) { return a <= b; }); break;
+                        case Op::GT: compareColumn(values, count, x, out, [](double a, double b) { return a > b; }); break;
+                        case Op::GE: compareColumn(values, count, x, out, [](double a, double b) { return a >= b; }); break;
+                        case Op::CONTAINS: break;
+                    }
+                } else {
+                    const auto& values = store.text[node.column];
+                    for (size_t i = 0; i < count; ++i) {
+                        int cmp = values[i].compare(node.text);
+                        bool hit = false;
+                        switch (node.op) {
+                            case Op::EQ: hit = cmp == 0; break;
+                            case Op::NE: hit = cmp != 0; break;
+                            case Op::LT: hit = cmp < 0; break;
+                            case Op::LE: hit = cmp <= 0; break;
+                            case Op::GT: hit = cmp > 0; break;
+                            case Op::GE: hit = cmp >= 0; break;
+                            case Op::CONTAINS: hit = values[i].find(node.text) != std::string::npos; break;
+                        }
+                        mask[i] = hit ? 1 : 0;
+                    }
+                }
+                break;
+            }
+        }
+
+        return mask;
+    }
+}
+
+// Compilation and execution
+CompiledQuery QueryEngine::compile(const std::string& text) {
+    Parser parser(text);
+    CompiledQuery query = parser.parse();
+    query.text = text;
+    return query;
+}
+
+namespace {
+    template <typename Roster>
+    QueryResult executeOn(const CompiledQuery& query, const Roster& students) {
+        QueryResult result;
+        size_t count = students.size();
+
+        // Pull only the columns the filter and sort need
+        std::vector<bool> needed(columnCount(), false);
+        markColumns(query.filter.get(), needed);
+        for (const auto& key : query.orderBy) {
+            needed[key.column] = true;
+        }
+
+        ColumnStore store;
+        fillColumns(store, students, needed);
+
+        std::vector<uint32_t> selected;
+        if (query.filter) {
+            std::vector<uint8_t> mask = evaluate(*query.filter, store, count);
+            selected.reserve(std::count(mask.begin(), mask.end(), 1));
+            for (size_t i = 0; i < count; ++i) {
+                if (mask[i]) selected.push_back(static_cast<uint32_t>(i));
+            }
+        } else {
+            selected.resize(count);
+            for (size_t i = 0; i < count; ++i) selected[i] = static_cast<uint32_t>(i);
+        }
+        result.matched = selected.size();
+
+        orderPositions(selected, store, query.orderBy, query.limit);
+
+        if (query.limit < selected.size()) {
+            selected.resize(query.limit);
+        }
+
+        // Projection
+        auto names = QueryEngine::getColumnNames();
+        for (int column : query.projection) {
+            result.columns.push_back(names[column]);
+        }
+
+        result.rows.reserve(selected.size());
+        for (uint32_t position : selected) {
+            std::vector<std::string> row;
+            row.reserve(query.projection.size());
+            for (int column : query.projection) {
+                row.push_back(formatCell(students[position], column));
+            }
+            result.rows.push_back(std::move(row));
+        }
+        result.positions = std::move(selected);
+
+        return result;
+    }
+}
+
+QueryResult QueryEngine::execute(const CompiledQuery& query, const std::vector<Student>& students) {
+    return executeOn(query, students);
+}
+
+QueryResult QueryEngine::execute(const CompiledQuery& query, const RosterPages& students) {
+    return executeOn(query, students);
+}
+
+QueryResult QueryEngine::run(const std::string& text, const std::vector<Student>& students) {
+    return execute(compile(text), students);
+}
+
+std::vector<CompiledQuery::SortKey> QueryEngine::parseSortKeys(const std::string& spec) {
+    return compile("order by " + spec).orderBy;
+}
+
+std::vector<uint32_t> QueryEngine::sortedPositions(const std::vector<Student>& students,
+                                                   const std::vector<CompiledQuery::SortKey>& keys,
+                                                   size_t topK) {
+    std::vector<bool> needed(columnCount(), false);
+    for (const auto& key : keys) {
+        needed[key.column] = true;
+    }
+
+    ColumnStore store;
+    fillColumns(store, students, needed);
+
+    std::vector<uint32_t> positions(students.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        positions[i] = static_cast<uint32_t>(i);
+    }
+
+    orderPositions(positions, store, keys, topK == 0 ? positions.size() : topK);
+    return positions;
+}
+
+// Column catalogue
+std::vector<std::string> QueryEngine::getColumnNames() {
+    std::vector<std::string> names = {
+        "id", "name", "age", "gender", "dob", "email",
+        "avg", "grade", "gpa", "remark", "updated"
+    };
+    for (const auto& subject : GradeUtil::getSubjectNames()) {
+        names.push_back(subject);
+    }
+    return names;
+}
+
+int QueryEngine::columnForName(const std::string& name) {
+    std::string key = columnKey(name);
+
+    if (key == "id" || key == "studentid") return COL_ID;
+    if (key == "name") return COL_NAME;
+    if (key == "age") return COL_AGE;
+    if (key == "gender") return COL_GENDER;
+    if (key == "dob" || key == "dateofbirth") return COL_DOB;
+    if (key == "email") return COL_EMAIL;
+    if (key == "avg" || key == "average" || key == "averagescore") return COL_AVERAGE;
+    if (key == "grade" || key == "lettergrade") return COL_GRADE;
+    if (key == "gpa") return COL_GPA;
+    if (key == "remark") return COL_REMARK;
+    if (key == "updated" || key == "lastupdated") return COL_UPDATED;
+
+    auto subjects = GradeUtil::getSubjectNames();
+    for (size_t i = 0; i < subjects.size(); ++i) {
+        if (columnKey(subjects[i]) == key) {
+            return FIRST_SUBJECT + static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+bool QueryEngine::isNumericColumn(int column) {
+    return column == COL_AGE || column == COL_AVERAGE || column == COL_GRADE ||
+           column == COL_GPA || column >= FIRST_SUBJECT;
+}
@@ -0,0 +1,224 @@
+#include "RosterCache.hpp"
+#include "Metrics.hpp"
+#include "MemoryStats.hpp"
+#include "PasswordHash.hpp"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+using namespace std;
+
+const char RosterCache::MAGIC[4] = {'S', 'C', 'M', 'R'};
+const uint32_t RosterCache::VERSION = 1;
+
+namespace {
+    // Fields are written in host byte order; the cache never leaves the machine
+    template <typename T>
+    void writeValue(string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void writeString(string& out, const string& value) {
+        writeValue<uint32_t>(out, static_cast<uint32_t>(value.size()));
+        out.append(value);
+    }
+
+    class Reader {
+    public:
+        Reader(const char* data, size_t size) : data(data), size(size) {}
+
+        template <typename T>
+        T read() {
+            T value{};
+            require(sizeof(T));
+            memcpy(&value, data + offset, sizeof(T));
+            offset += sizeof(T);
+            return value;
+        }
+
+        string readString() {
+            uint32_t length = read<uint32_t>();
+            require(length);
+            string value(data + offset, length);
+            offset += length;
+            return value;
+        }
+
+    private:
+        const char* data;
+        size_t size;
+        size_t offset = 0;
+
+        void require(size_t bytes) {
+            if (offset + bytes > size) {
+                throw runtime_error("cache file is truncated");
+            }
+        }
+    };
+}
+
+bool RosterCache::save(const std::string& filename, const std::vector<Student>& students) {
+    SCOREME_TIME_SCOPE("cache_save");
+    // Write to a temporary file first so a crash never leaves a half-written cache
+    string tempFilename = filename + ".tmp";
+    ofstream file(tempFilename, ios::binary | ios::trunc);
+    if (!file) {
+        return false;
+    }
+    // Owner only, set before any credential is written
+    error_code permissionError;
+    filesystem::permissions(tempFilename, filesystem::perms::owner_read | filesystem::perms::owner_write,
+                            filesystem::perm_options::replace, permissionError);
+    if (permissionError) {
+        return false;
+    }
+
+    // Encoded in 1 MiB pieces, so huge rosters never need a second copy in memory
+    const size_t flushSize = 1 << 20;
+    string out;
+    out.reserve(flushSize + 4096);
+    auto flushOut = [&file, &out]() {
+        file.write(out.data(), static_cast<streamsize>(out.size()));
+        out.clear();
+    };
+
+    out.append(MAGIC, sizeof(MAGIC));
+    writeValue<uint32_t>(out, VERSION);
+    writeValue<uint64_t>(out, students.size());
+
+    for (const auto& student : students) {
+        writeString(out, student.getUsername());
+        // Plain passwords (new or edited this session) are hashed on the way out
+        const string& password = student.getPassword();
+        writeString(out, password.empty() || PasswordHash::isHash(password) ? password : PasswordHash::hash(password));
+        writeString(out, student.getStudentId());
+        writeString(out, student.getName());
+        writeValue<int32_t>(out, student.getAge());
+        writeString(out, student.getGender());
+        writeString(out, student.getDateOfBirth());
+        writeString(out, student.getEmail());
+
+        const auto& scores = student.getSubjectScores();
+        writeValue<uint32_t>(out, static_cast<uint32_t>(scores.size()));
+        for (double score : scores) {
+            writeValue<double>(out, score);
+        }
+        writeValue<int64_t>(out, static_cast<int64_t>(student.getLastUpdated()));
+
+        if (out.size() >= flushSize) {
+            flushOut();
+        }
+    }
+
+    flushOut();
+    file.close();
+    if (!file) {
+        return false;
+    }
+
+    error_code ec;
+    filesystem::rename(tempFilename, filename, ec);
+    return !ec;
+}
+
+bool RosterCache::load(const std::string& filename, std::vector<Student>& students) {
+    SCOREME_TIME_SCOPE("cache_load");
+    MemoryStats::Scope memoryScope(MemoryStats::ROSTER);
+    try {
+        ifstream file(filename, ios::binary | ios::ate);
+        if (!file) {
+            return false;
+        }
+
+        string data(static_cast<size_t>(file.tellg()), '\0');
+        file.seekg(0);
+        file.read(&data[0], static_cast<streamsize>(data.size()));
+
+        Reader reader(data.data(), data.size());
+        char magic[4];
+        for (char& c : magic) {
+            c = reader.read<char>();
+        }
+        if (memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || reader.read<uint32_t>() != VERSION) {
+            return false;
+        }
+
+        uint64_t count = reader.read<uint64_t>();
+        vector<Student> loaded;
+        loaded.reserve(static_cast<size_t>(count));
+
+        for (uint64_t i = 0; i < count; ++i) {
+            string username = reader.readString();
+            string password = reader.readString();
+            string studentId = reader.readString();
+            string name = reader.readString();
+            int age = reader.read<int32_t>();
+            string gender = reader.readString();
+            string dateOfBirth = reader.readString();
+            string email = reader.readString();
+
+            uint32_t scoreCount = reader.read<uint32_t>();
+            vector<double> scores(scoreCount);
+            for (auto& score : scores) {
+                score = reader.read<double>();
+            }
+            time_t lastUpdated = static_cast<time_t>(reader.read<int64_t>());
+
+            loaded.emplace_back(username, password, studentId, name, age, gender, dateOfBirth, email, scores);
+            loaded.back().setLastUpdated(lastUpdated);
+        }
+
+        students.swap(loaded);
+        return true;
+    }
+    catch (const exception& e) {
+        cerr << "Ignoring roster cache '" << filename << "': " << e.what() << endl;
+        return false;
+    }
+}
+
+bool RosterCache::isFresh(const std::string& cacheFilename, const std::string& sourceFilename) {
+    error_code ec;
+    if (!filesystem::exists(cacheFilename, ec)) {
+        return false;
+    }
+    if (!filesystem::exists(sourceFilename, ec)) {
+        return true;  // Nothing newer to compare against
+    }
+
+    auto cacheTime = filesystem::last_write_time(cacheFilename, ec);
+    if (ec) return false;
+    auto sourceTime = filesystem::last_write_time(sourceFilename, ec);
+    if (ec) return false;
+
+    return cacheTime >= sourceTime;
+}
+
+std::string RosterCache::cachePathFor(const std::string& sourceFilename) {
+    size_t dotPos = sourceFilename.find_last_of('.');
+    size_t slashPos = sourceFilename.find_last_of("/\\");
+    if (dotPos != string::npos && (slashPos == string::npos || dotPos > slashPos)) {
+        return sourceFilename.substr(0, dotPos) + ".cache";
+    }
+    return sourceFilename + ".cache";
+}
+
+void RosterCache::restoreCredentials(std::vector<Student>& students, const std::vector<Student>& cached) {
+    unordered_map<string, const Student*> byId;
+    for (const auto& student : cached) {
+        if (!student.getUsername().empty()) {
+            byId.emplace(student.getStudentId(), &student);
+        }
+    }
+
+    for (auto& student : students) {
+        auto it = byId.find(student.getStudentId());
+        if (it != byId.end() && student.getUsername().empty()) {
+            student.setUsername(it->second->getUsername());
+            student.setPassword(it->second->getPassword());
+        }
+    }
+}
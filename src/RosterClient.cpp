@@ -0,0 +1,242 @@
+#include "RosterClient.hpp"
+#include "RosterServer.hpp"
+#include "JsonUtil.hpp"
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+RosterClient::RosterClient(const std::string& socketPath) : socketPath(socketPath) {}
+
+RosterClient::~RosterClient() {
+#ifndef _WIN32
+    if (fd >= 0) {
+        ::close(fd);
+    }
+#endif
+}
+
+bool RosterClient::connect() {
+#ifdef _WIN32
+    return false;
+#else
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    return true;
+#endif
+}
+
+bool RosterClient::isConnected() const {
+    return fd >= 0;
+}
+
+std::string RosterClient::request(const std::string& line) {
+#ifdef _WIN32
+    (void)line;
+    throw runtime_error("Client mode is not available on Windows");
+#else
+    if (fd < 0) {
+        throw runtime_error("Not connected to " + socketPath);
+    }
+
+    string data = line + "\n";
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            throw runtime_error("Connection to server lost");
+        }
+        sent += static_cast<size_t>(n);
+    }
+
+    char chunk[4096];
+    size_t newline;
+    while ((newline = pending.find('\n')) == string::npos) {
+        ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            throw runtime_error("Connection to server lost");
+        }
+        pending.append(chunk, static_cast<size_t>(n));
+    }
+
+    string response = pending.substr(0, newline);
+    pending.erase(0, newline + 1);
+    return response;
+#endif
+}
+
+namespace {
+    // Parses a response line and throws with the server's message unless it succeeded
+    JsonUtil::Value checkedResponse(const string& line) {
+        JsonUtil::Value response = JsonUtil::parse(line);
+        if (!response.has("ok") || response.at("ok").text != "true") {
+            throw runtime_error(response.has("error") ? response.at("error").text : "server refused the request");
+        }
+        return response;
+    }
+}
+
+QueryResult RosterClient::query(const std::string& text) {
+    JsonUtil::Value response = checkedResponse(
+        request("{\"op\":\"query\",\"text\":" + JsonUtil::quote(text) + "}"));
+
+    QueryResult result;
+    result.matched = stoul(response.at("matched").text);
+    for (const auto& column : response.at("columns").items) {
+        result.columns.push_back(column.text);
+    }
+    for (const auto& row : response.at("rows").items) {
+        vector<string> cells;
+        cells.reserve(row.items.size());
+        for (const auto& cell : row.items) {
+            cells.push_back(cell.text);
+        }
+        result.rows.push_back(std::move(cells));
+    }
+    return result;
+}
+
+QueryResult RosterClient::search(const std::string& text, size_t limit) {
+    JsonUtil::Value response = checkedResponse(
+        request("{\"op\":\"search\",\"text\":" + JsonUtil::quote(text) +
+                ",\"limit\":\"" + to_string(limit) + "\"}"));
+
+    QueryResult result;
+    result.columns = {"id", "name", "score"};
+    for (const auto& hit : response.at("results").items) {
+        result.rows.push_back({hit.at("id").text, hit.at("name").text, hit.at("score").text});
+    }
+    result.matched = result.rows.size();
+    return result;
+}
+
+std::string RosterClient::report(const std::string& output) {
+    JsonUtil::Value response = checkedResponse(
+        request("{\"op\":\"report\",\"out\":" + JsonUtil::quote(output) + "}"));
+    return response.at("out").text;
+}
+
+std::string RosterClient::rosterFile() {
+    return checkedResponse(request("{\"op\":\"ping\"}")).at("roster").text;
+}
+
+void RosterClient::setScore(const std::string& id, const std::string& subject, double score) {
+    checkedResponse(request("{\"op\":\"set_score\",\"id\":" + JsonUtil::quote(id) +
+                            ",\"subject\":" + JsonUtil::quote(subject) +
+                            ",\"score\":\"" + to_string(score) + "\"}"));
+}
+
+void RosterClient::setField(const std::string& id, const std::string& field, const std::string& value) {
+    checkedResponse(request("{\"op\":\"set_field\",\"id\":" + JsonUtil::quote(id) +
+                            ",\"field\":" + JsonUtil::quote(field) +
+                            ",\"value\":" + JsonUtil::quote(value) + "}"));
+}
+
+std::string RosterClient::buildRequest(const std::string& commandLine) {
+    istringstream iss(commandLine);
+    string op;
+    iss >> op;
+    if (op.empty()) {
+        return "";
+    }
+
+    string json = "{\"op\":" + JsonUtil::quote(op);
+
+    // Free text operations: everything after the op is the text
+    if (op == "search" || op == "query") {
+        string text;
+        getline(iss >> ws, text);
+        return json + ",\"text\":" + JsonUtil::quote(text) + "}";
+    }
+
+    string token;
+    while (iss >> token) {
+        size_t equals = token.find('=');
+        if (equals == string::npos) {
+            throw invalid_argument("Expected key=value but got '" + token + "'");
+        }
+        json += "," + JsonUtil::quote(token.substr(0, equals)) + ":" + JsonUtil::quote(token.substr(equals + 1));
+    }
+    return json + "}";
+}
+
+// `client [--socket path] [op key=value ...]`
+int RosterClient::run(int argc, char* argv[]) {
+    string socketPath = RosterServer::defaultSocketPath();
+    vector<string> words;
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else {
+            words.push_back(arg);
+        }
+    }
+
+    RosterClient client(socketPath);
+    if (!client.connect()) {
+        cerr << "No ScoreME server is listening on " << socketPath << " (start one with `serve`)" << endl;
+        return 1;
+    }
+
+    try {
+        // One-shot: the request comes from the command line
+        if (!words.empty()) {
+            string commandLine;
+            for (const auto& word : words) {
+                commandLine += (commandLine.empty() ? "" : " ") + word;
+            }
+            string response = client.request(buildRequest(commandLine));
+            cout << response << endl;
+            return response.compare(0, 10, "{\"ok\":true") == 0 ? 0 : 1;
+        }
+
+        // Interactive: one command per line until EOF or `quit`
+        cout << "Connected to " << socketPath << ". Commands: ping, get id=.., search <text>, query <text>,\n"
+             << "set_score id=.. subject=.. score=.., set_field id=.. field=.. value=.., report, save, shutdown, quit" << endl;
+        string line;
+        while (cout << "scoreme> " << flush, getline(cin, line)) {
+            if (line == "quit" || line == "exit") {
+                break;
+            }
+            try {
+                string request = buildRequest(line);
+                if (!request.empty()) {
+                    cout << client.request(request) << endl;
+                }
+            }
+            catch (const invalid_argument& e) {
+                cerr << e.what() << endl;
+            }
+        }
+    }
+    catch (const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
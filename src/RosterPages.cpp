@@ -0,0 +1,37 @@
+#include "RosterPages.hpp"
+
+using namespace std;
+
+const size_t RosterPages::PAGE_SIZE = 256;
+
+RosterPages::RosterPages(std::vector<Student> students) : count(students.size()) {
+    pages.reserve((count + PAGE_SIZE - 1) / PAGE_SIZE);
+    for (size_t first = 0; first < count; first += PAGE_SIZE) {
+        size_t last = min(first + PAGE_SIZE, count);
+        auto page = make_shared<vector<Student>>();
+        page->reserve(last - first);
+        for (size_t i = first; i < last; ++i) {
+            page->push_back(std::move(students[i]));
+        }
+        pages.push_back(std::move(page));
+    }
+}
+
+Student& RosterPages::mutableAt(size_t position) {
+    auto& page = pages[position / PAGE_SIZE];
+    // Pages are only reachable through versions, and versions are only
+    // copied by the writer, so a count of one means no other version has it
+    if (page.use_count() > 1) {
+        page = make_shared<vector<Student>>(*page);
+    }
+    return (*page)[position % PAGE_SIZE];
+}
+
+std::vector<Student> RosterPages::toVector() const {
+    vector<Student> students;
+    students.reserve(count);
+    for (const auto& page : pages) {
+        students.insert(students.end(), page->begin(), page->end());
+    }
+    return students;
+}
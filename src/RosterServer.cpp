@@ -0,0 +1,578 @@
+#include "RosterServer.hpp"
+#include "ExcelUtil.hpp"
+#include "GradeUtil.hpp"
+#include "JsonUtil.hpp"
+#include "Metrics.hpp"
+#include "MemoryStats.hpp"
+#include "QueryEngine.hpp"
+#include "RosterCache.hpp"
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+const size_t RosterServer::MAX_LINE_LENGTH = 1 << 20;
+
+namespace {
+    volatile sig_atomic_t stopRequested = 0;
+
+    void onStopSignal(int) {
+        stopRequested = 1;
+    }
+
+    string okResponse(const string& body = "") {
+        return body.empty() ? "{\"ok\":true}" : "{\"ok\":true," + body + "}";
+    }
+
+    string formatNumber(double value) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.2f", value);
+        return buffer;
+    }
+
+    string normalizeSubject(const string& text) {
+        string result;
+        for (char c : text) {
+            result += (c == ' ') ? '_' : static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        }
+        return result;
+    }
+
+    // Reports are only written next to the roster: `out` may be a bare file
+    // name or a path whose directory is the roster's own
+    bool reportPath(const string& rosterFile, const string& requested, string& path) {
+        filesystem::path target(requested);
+        filesystem::path name = target.filename();
+        if (name.empty() || name == "." || name == "..") {
+            return false;
+        }
+        filesystem::path directory = filesystem::path(rosterFile).parent_path();
+        if (target.has_parent_path()) {
+            error_code targetError;
+            error_code directoryError;
+            filesystem::path targetDirectory = filesystem::weakly_canonical(target.parent_path(), targetError);
+            filesystem::path rosterDirectory = filesystem::weakly_canonical(
+                directory.empty() ? filesystem::path(".") : directory, directoryError);
+            if (targetError || directoryError || targetDirectory != rosterDirectory) {
+                return false;
+            }
+        }
+        path = (directory / name).string();
+        return true;
+    }
+
+#ifndef _WIN32
+    bool sendAll(int fd, const string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                return false;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool fillAddress(const string& path, sockaddr_un& address) {
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            return false;
+        }
+        memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return true;
+    }
+#endif
+}
+
+RosterServer::RosterServer(const std::string& rosterFile, const std::string& socketPath)
+    : rosterFile(rosterFile), socketPath(socketPath) {}
+
+RosterServer::~RosterServer() {
+    stop();
+    reapConnections(true);
+}
+
+std::string RosterServer::defaultSocketPath() {
+    const char* path = getenv("SCOREME_SOCKET");
+    return (path && *path) ? path : "data/scoreme.sock";
+}
+
+size_t RosterServer::size() const {
+    return store.snapshot()->students.size();
+}
+
+// Lifecycle
+bool RosterServer::start() {
+#ifdef _WIN32
+    cerr << "Server mode needs Unix domain sockets and is not available on Windows." << endl;
+    return false;
+#else
+    string cacheFile = RosterCache::cachePathFor(rosterFile);
+    vector<Student> students;
+    if (!(RosterCache::isFresh(cacheFile, rosterFile) && RosterCache::load(cacheFile, students))) {
+        if (!ExcelUtils::fileExists(rosterFile)) {
+            cerr << "Roster not found: " << rosterFile << endl;
+            return false;
+        }
+        // Serving an empty roster would let the next save wipe the workbook
+        string error;
+        if (!ExcelUtils::readStudents(rosterFile, students, error)) {
+            cerr << "Cannot load the roster, " << error << endl;
+            return false;
+        }
+
+        vector<Student> cached;
+        if (RosterCache::load(cacheFile, cached)) {
+            RosterCache::restoreCredentials(students, cached);
+        }
+    }
+    savedVersion = store.replace(std::move(students));
+
+    sockaddr_un address;
+    if (!fillAddress(socketPath, address)) {
+        cerr << "Socket path is too long: " << socketPath << endl;
+        return false;
+    }
+
+    // A socket file nobody answers on is left over from a crash
+    int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe >= 0) {
+        bool alive = ::connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        ::close(probe);
+        if (alive) {
+            cerr << "Another server is already listening on " << socketPath << endl;
+            return false;
+        }
+    }
+    ::unlink(socketPath.c_str());
+
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0 ||
+        ::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listenFd, 16) != 0) {
+        cerr << "Cannot listen on " << socketPath << ": " << strerror(errno) << endl;
+        if (listenFd >= 0) {
+            ::close(listenFd);
+            listenFd = -1;
+        }
+        return false;
+    }
+
+    running = true;
+    return true;
+#endif
+}
+
+void RosterServer::serve() {
+#ifndef _WIN32
+    signal(SIGINT, onStopSignal);
+    signal(SIGTERM, onStopSignal);
+
+    while (running && !stopRequested) {
+        // Wake up regularly so shutdown requests and signals are noticed
+        pollfd pfd{listenFd, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, 200);
+        if (ready <= 0) {
+            continue;
+        }
+
+        int clientFd = ::accept(listenFd, nullptr, nullptr);
+        if (clientFd < 0) {
+            continue;
+        }
+
+        reapConnections(false);
+        auto finished = make_shared<atomic<bool>>(false);
+        lock_guard<mutex> lock(connectionsMutex);
+        connections.push_back({thread(&RosterServer::handleConnection, this, clientFd, finished), finished});
+    }
+
+    stop();
+    reapConnections(true);
+
+    if (store.versionNumber() != savedVersion) {
+        string error;
+        if (!saveRoster(error)) {
+            cerr << "Failed to save roster on shutdown: " << error << endl;
+        }
+    }
+#endif
+}
+
+void RosterServer::stop() {
+    running = false;
+#ifndef _WIN32
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        listenFd = -1;
+        ::unlink(socketPath.c_str());
+    }
+#endif
+}
+
+void RosterServer::reapConnections(bool all) {
+    vector<thread> done;
+    {
+        lock_guard<mutex> lock(connectionsMutex);
+        auto it = connections.begin();
+        while (it != connections.end()) {
+            if (all || it->finished->load()) {
+                done.push_back(std::move(it->worker));
+                it = connections.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    for (auto& worker : done) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void RosterServer::handleConnection(int clientFd, std::shared_ptr<std::atomic<bool>> finished) {
+    Trace::setThreadName("connection " + to_string(clientFd));
+#ifndef _WIN32
+    string buffer;
+    char chunk[4096];
+
+    while (running && !stopRequested) {
+        pollfd pfd{clientFd, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, 200);
+        if (ready == 0) {
+            continue;
+        }
+        if (ready < 0) {
+            break;
+        }
+
+        ssize_t n = ::recv(clientFd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            break;
+        }
+        buffer.append(chunk, static_cast<size_t>(n));
+
+        size_t newline;
+        bool ok = true;
+        while (ok && (newline = buffer.find('\n')) != string::npos) {
+            string line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (!line.empty()) {
+                SCOREME_TIME_SCOPE("server_request");
+                ok = sendAll(clientFd, handleRequest(line) + "\n");
+            }
+        }
+        if (!ok) {
+            break;
+        }
+        if (buffer.size() > MAX_LINE_LENGTH) {
+            sendAll(clientFd, errorResponse("request line too long") + "\n");
+            break;
+        }
+    }
+
+    ::close(clientFd);
+#else
+    (void)clientFd;
+#endif
+    finished->store(true);
+}
+
+// Request dispatch
+std::string RosterServer::handleRequest(const std::string& line) {
+    SCOREME_COUNT("server_requests", 1);
+    try {
+        auto request = JsonUtil::parseFlatObject(line);
+        const string& op = requireField(request, "op");
+
+        if (op == "ping") return opPing();
+        if (op == "get") return opGet(request);
+        if (op == "search") return opSearch(request);
+        if (op == "query") return opQuery(request);
+        if (op == "set_score") return opSetScore(request);
+        if (op == "set_field") return opSetField(request);
+        if (op == "report") return opReport(request);
+        if (op == "save") return opSave();
+        if (op == "memory") {
+            ostringstream report;
+            // Measures a contiguous copy of the current version
+            vector<Student> students = store.snapshot()->students.toVector();
+            MemoryStats::printReport(report, &students);
+            return okResponse("\"report\":" + JsonUtil::quote(report.str()));
+        }
+        if (op == "metrics") {
+            ostringstream metrics;
+            Metrics::writeJson(metrics);
+            return okResponse("\"metrics\":" + metrics.str());
+        }
+        if (op == "shutdown") {
+            running = false;
+            return okResponse();
+        }
+        return errorResponse("unknown op: " + op);
+    }
+    catch (const exception& e) {
+        return errorResponse(e.what());
+    }
+}
+
+std::string RosterServer::errorResponse(const std::string& message) {
+    return "{\"ok\":false,\"error\":" + JsonUtil::quote(message) + "}";
+}
+
+const std::string& RosterServer::requireField(const std::map<std::string, std::string>& request,
+                                              const std::string& name) {
+    auto it = request.find(name);
+    if (it == request.end()) {
+        throw runtime_error("missing field: " + name);
+    }
+    return it->second;
+}
+
+std::string RosterServer::studentToJson(const Student& student) {
+    string json = "{\"id\":" + JsonUtil::quote(student.getStudentId()) +
+                  ",\"name\":" + JsonUtil::quote(student.getName()) +
+                  ",\"age\":" + to_string(student.getAge()) +
+                  ",\"gender\":" + JsonUtil::quote(student.getGender()) +
+                  ",\"dob\":" + JsonUtil::quote(student.getDateOfBirth()) +
+                  ",\"email\":" + JsonUtil::quote(student.getEmail()) +
+                  ",\"average\":" + formatNumber(student.getAverageScore()) +
+                  ",\"grade\":" + JsonUtil::quote(student.getLetterGrade()) +
+                  ",\"gpa\":" + formatNumber(student.getGpa()) +
+                  ",\"remark\":" + JsonUtil::quote(student.getRemark()) +
+                  ",\"scores\":{";
+
+    const auto subjects = GradeUtil::getSubjectNames();
+    const auto& scores = student.getSubjectScores();
+    for (size_t i = 0; i < scores.size() && i < subjects.size(); ++i) {
+        if (i > 0) json += ",";
+        json += JsonUtil::quote(subjects[i]) + ":" + formatNumber(scores[i]);
+    }
+    return json + "}}";
+}
+
+// Read operations (on a snapshot)
+std::string RosterServer::opPing() const {
+    auto snapshot = store.snapshot();
+    error_code ec;
+    filesystem::path roster = filesystem::absolute(rosterFile, ec);
+    return okResponse("\"students\":" + to_string(snapshot->students.size()) +
+                      ",\"version\":" + to_string(snapshot->number) +
+                      ",\"roster\":" + JsonUtil::quote(ec ? rosterFile : roster.string()));
+}
+
+std::string RosterServer::opGet(const std::map<std::string, std::string>& request) const {
+    const string& id = requireField(request, "id");
+    auto snapshot = store.snapshot();
+    long position = snapshot->find(id);
+    if (position < 0) {
+        return errorResponse("student not found: " + id);
+    }
+    return okResponse("\"student\":" + studentToJson(snapshot->students[position]));
+}
+
+std::string RosterServer::opSearch(const std::map<std::string, std::string>& request) const {
+    const string& text = requireField(request, "text");
+    auto limitIt = request.find("limit");
+    size_t limit = (limitIt != request.end()) ? stoul(limitIt->second) : 10;
+
+    auto snapshot = store.snapshot();
+    auto results = snapshot->search(text, limit);
+
+    string json = "\"results\":[";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Student& student = snapshot->students[results[i].position];
+        if (i > 0) json += ",";
+        json += "{\"id\":" + JsonUtil::quote(student.getStudentId()) +
+                ",\"name\":" + JsonUtil::quote(student.getName()) +
+                ",\"score\":" + to_string(results[i].score) + "}";
+    }
+    return okResponse(json + "]");
+}
+
+std::string RosterServer::opQuery(const std::map<std::string, std::string>& request) const {
+    SCOREME_TIME_SCOPE("server_query");
+    CompiledQuery query = QueryEngine::compile(requireField(request, "text"));
+    QueryResult result = QueryEngine::execute(query, store.snapshot()->students);
+
+    string json = "\"matched\":" + to_string(result.matched) + ",\"columns\":[";
+    for (size_t c = 0; c < result.columns.size(); ++c) {
+        if (c > 0) json += ",";
+        json += JsonUtil::quote(result.columns[c]);
+    }
+    json += "],\"rows\":[";
+    for (size_t r = 0; r < result.rows.size(); ++r) {
+        json += (r > 0) ? ",[" : "[";
+        for (size_t c = 0; c < result.rows[r].size(); ++c) {
+            if (c > 0) json += ",";
+            json += JsonUtil::quote(result.rows[r][c]);
+        }
+        json += "]";
+    }
+    return okResponse(json + "]");
+}
+
+std::string RosterServer::opReport(const std::map<std::string, std::string>& request) {
+    auto outIt = request.find("out");
+    string output;
+    if (!reportPath(rosterFile, (outIt != request.end()) ? outIt->second : "grade_report.xlsx", output)) {
+        return errorResponse("report must be written to the roster directory");
+    }
+
+    // Edits made while the workbook is being written land in later versions
+    auto snapshot = store.snapshot();
+    if (!ExcelUtils::exportGradeReport(output, snapshot->students.toVector())) {
+        return errorResponse("failed to write " + output);
+    }
+    return okResponse("\"out\":" + JsonUtil::quote(output) + ",\"version\":" + to_string(snapshot->number));
+}
+
+// Write operations (copy-on-write, serialized by the store)
+std::string RosterServer::opSetScore(const std::map<std::string, std::string>& request) {
+    const string& id = requireField(request, "id");
+    string subject = normalizeSubject(requireField(request, "subject"));
+    double score = stod(requireField(request, "score"));
+    if (!(score >= 0.0 && score <= 100.0)) {   // also rejects NaN
+        return errorResponse("score must be between 0 and 100");
+    }
+
+    const auto subjects = GradeUtil::getSubjectNames();
+    size_t subjectIndex = subjects.size();
+    for (size_t i = 0; i < subjects.size(); ++i) {
+        if (normalizeSubject(subjects[i]) == subject) {
+            subjectIndex = i;
+            break;
+        }
+    }
+    if (subjectIndex == subjects.size()) {
+        return errorResponse("unknown subject: " + requireField(request, "subject"));
+    }
+
+    string updated;
+    bool found = store.update([&](RosterStore::Version& version) {
+        long position = version.find(id);
+        if (position < 0) {
+            return false;
+        }
+        Student& student = version.students.mutableAt(position);
+        vector<double> scores = student.getSubjectScores();
+        if (subjectIndex >= scores.size()) {
+            scores.resize(subjects.size(), 0.0);
+        }
+        scores[subjectIndex] = score;
+        student.setSubjectScores(scores);
+        updated = studentToJson(student);
+        return true;
+    });
+
+    if (!found) {
+        return errorResponse("student not found: " + id);
+    }
+    return okResponse("\"student\":" + updated);
+}
+
+std::string RosterServer::opSetField(const std::map<std::string, std::string>& request) {
+    const string& id = requireField(request, "id");
+    const string& field = requireField(request, "field");
+    const string& value = requireField(request, "value");
+
+    if (field != "name" && field != "age" && field != "gender" && field != "dob" && field != "email") {
+        return errorResponse("unknown field: " + field);
+    }
+    int age = (field == "age") ? stoi(value) : 0;
+
+    string updated;
+    bool found = store.update([&](RosterStore::Version& version) {
+        long position = version.find(id);
+        if (position < 0) {
+            return false;
+        }
+        Student& student = version.students.mutableAt(position);
+        if (field == "name") student.setName(value);
+        else if (field == "age") student.setAge(age);
+        else if (field == "gender") student.setGender(value);
+        else if (field == "dob") student.setDateOfBirth(value);
+        else student.setEmail(value);
+        student.updateTimestamp();
+
+        // Only searchable fields touch the index, and only through the small delta
+        if (field == "name" || field == "email") {
+            version.reindex(position);
+        }
+        updated = studentToJson(student);
+        return true;
+    });
+
+    if (!found) {
+        return errorResponse("student not found: " + id);
+    }
+    return okResponse("\"student\":" + updated);
+}
+
+std::string RosterServer::opSave() {
+    string error;
+    if (!saveRoster(error)) {
+        return errorResponse(error);
+    }
+    return okResponse();
+}
+
+bool RosterServer::saveRoster(std::string& error) {
+    lock_guard<mutex> saveLock(saveMutex);
+    auto snapshot = store.snapshot();
+
+    // The workbook and cache writers take a vector; one copy per save, not per edit
+    vector<Student> students = snapshot->students.toVector();
+    if (!ExcelUtils::writeExcel(rosterFile, students)) {
+        error = "failed to write " + rosterFile;
+        return false;
+    }
+    RosterCache::save(RosterCache::cachePathFor(rosterFile), students);
+    savedVersion = snapshot->number;
+    return true;
+}
+
+// `serve [workbook] [--socket path]`
+int RosterServer::run(int argc, char* argv[]) {
+    string rosterFile = "data/students.xlsx";
+    string socketPath = defaultSocketPath();
+
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else {
+            rosterFile = arg;
+        }
+    }
+
+    RosterServer server(rosterFile, socketPath);
+    if (!server.start()) {
+        return 1;
+    }
+
+    cout << "Serving " << server.size() << " students from " << rosterFile
+         << " on " << socketPath << " (Ctrl+C to stop)" << endl;
+    server.serve();
+    cout << "Server stopped." << endl;
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include "RosterStore.hpp"
+#include <algorithm>
+
+using namespace std;
+
+const size_t RosterStore::SEARCH_DELTA_LIMIT = 256;
+
+long RosterStore::Version::find(const std::string& id) const {
+    auto it = positionById->find(id);
+    return it != positionById->end() ? static_cast<long>(it->second) : -1;
+}
+
+std::vector<SearchResult> RosterStore::Version::search(const std::string& text, size_t limit) const {
+    if (!searchDelta) {
+        return searchIndex->search(text, limit);
+    }
+
+    // Stale hits from the full index are dropped, so ask it for enough spare
+    vector<SearchResult> results;
+    for (const auto& hit : searchIndex->search(text, limit + searchDelta->edited.size())) {
+        if (searchDelta->edited.count(hit.position) == 0) {
+            results.push_back(hit);
+        }
+    }
+    for (auto hit : searchDelta->index.search(text, limit)) {
+        hit.position = searchDelta->positions[hit.position];
+        results.push_back(hit);
+    }
+
+    // Same ranking as a single index: score, then roster order
+    auto ranking = [](const SearchResult& a, const SearchResult& b) {
+        if (a.score != b.score) return a.score > b.score;
+        return a.position < b.position;
+    };
+    sort(results.begin(), results.end(), ranking);
+    if (results.size() > limit) {
+        results.resize(limit);
+    }
+    return results;
+}
+
+void RosterStore::Version::reindex(size_t position) {
+    bool known = searchDelta && searchDelta->edited.count(position) > 0;
+    size_t editedCount = (searchDelta ? searchDelta->edited.size() : 0) + (known ? 0 : 1);
+
+    // Too many edits: fold them into a private copy of the full index
+    if (editedCount > SEARCH_DELTA_LIMIT) {
+        auto index = make_shared<SearchIndex>(*searchIndex);
+        for (size_t edited : searchDelta->positions) {
+            index->updateStudent(students[edited], edited);
+        }
+        index->updateStudent(students[position], position);
+        searchIndex = std::move(index);
+        searchDelta.reset();
+        return;
+    }
+
+    auto delta = make_shared<SearchDelta>();
+    if (known) {
+        // Re-edit: rebuild the small delta so the old text drops out
+        delta->positions = searchDelta->positions;
+        delta->edited = searchDelta->edited;
+        for (size_t slot = 0; slot < delta->positions.size(); ++slot) {
+            delta->index.addStudent(students[delta->positions[slot]], slot);
+        }
+    } else {
+        if (searchDelta) {
+            *delta = *searchDelta;
+        }
+        delta->index.addStudent(students[position], delta->positions.size());
+        delta->positions.push_back(position);
+        delta->edited.insert(position);
+    }
+    searchDelta = std::move(delta);
+}
+
+RosterStore::RosterStore(std::vector<Student> students) {
+    replace(std::move(students));
+}
+
+RosterStore::Snapshot RosterStore::snapshot() const {
+    return atomic_load(&current);
+}
+
+uint64_t RosterStore::versionNumber() const {
+    return latestNumber.load();
+}
+
+uint64_t RosterStore::replace(std::vector<Student> students) {
+    lock_guard<mutex> lock(writerMutex);
+
+    auto next = make_shared<Version>();
+    auto index = make_shared<SearchIndex>();
+    index->rebuild(students);
+    next->searchIndex = std::move(index);
+    auto positions = make_shared<unordered_map<string, size_t>>();
+    positions->reserve(students.size());
+    for (size_t i = 0; i < students.size(); ++i) {
+        positions->emplace(students[i].getStudentId(), i);
+    }
+    next->students = RosterPages(std::move(students));
+    next->positionById = std::move(positions);
+    next->number = latestNumber.load() + 1;
+
+    uint64_t number = next->number;
+    publish(std::move(next));
+    return number;
+}
+
+bool RosterStore::update(const std::function<bool(Version&)>& edit) {
+    lock_guard<mutex> lock(writerMutex);
+
+    // Readers of the old version keep it alive until they let go. The copy
+    // shares every page and index with it until the edit writes to them.
+    auto next = make_shared<Version>(*atomic_load(&current));
+    if (!edit(*next)) {
+        return false;
+    }
+    next->number = latestNumber.load() + 1;
+    publish(std::move(next));
+    return true;
+}
+
+void RosterStore::publish(std::shared_ptr<Version> next) {
+    uint64_t number = next->number;
+    atomic_store(&current, Snapshot(std::move(next)));
+    latestNumber.store(number);
+}
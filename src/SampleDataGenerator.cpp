@@ -0,0 +1,255 @@
+#include "SampleDataGenerator.hpp"
+#include "ExcelUtil.hpp"
+#include "GradeUtil.hpp"
+#include "Metrics.hpp"
+#include "MemoryStats.hpp"
+#include "PasswordHash.hpp"
+#include "RosterCache.hpp"
+#include "SortUtil.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+const size_t SampleDataGenerator::PARALLEL_THRESHOLD = 20000;
+
+namespace {
+    const char* const MALE_NAMES[] = {
+        "John", "Michael", "David", "James", "Robert", "Daniel", "Kevin", "Thomas", "Brian", "Samuel",
+        "Joseph", "Andrew", "Ryan", "Ethan", "Lucas", "Omar", "Hiroshi", "Mateo", "Arjun", "Kwame"};
+    const char* const FEMALE_NAMES[] = {
+        "Emily", "Sarah", "Lisa", "Jennifer", "Jessica", "Laura", "Anna", "Maria", "Olivia", "Sophia",
+        "Grace", "Chloe", "Hannah", "Amara", "Yuki", "Priya", "Fatima", "Elena", "Zoe", "Ines"};
+    const char* const LAST_NAMES[] = {
+        "Smith", "Johnson", "Brown", "Davis", "Wilson", "Miller", "Taylor", "Anderson", "Thomas", "Martinez",
+        "Clark", "Lewis", "Walker", "Young", "Garcia", "Nguyen", "Patel", "Kim", "Okafor", "Rossi",
+        "Schmidt", "Silva", "Tanaka", "Kowalski", "Haddad", "Mensah", "Novak", "Larsen", "Dubois", "Costa"};
+
+    template <typename T, size_t N>
+    constexpr size_t countOf(const T (&)[N]) { return N; }
+
+    // splitmix64: tiny state, so every student can have its own stream
+    class Random {
+    public:
+        explicit Random(uint64_t seed) : state(seed) {}
+
+        uint64_t next() {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        double uniform() {
+            return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        size_t below(size_t bound) {
+            return static_cast<size_t>(next() % bound);
+        }
+
+        // Box-Muller
+        double normal(double mean, double stddev) {
+            double u1 = max(uniform(), 1e-12);
+            double u2 = uniform();
+            return mean + stddev * sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+        }
+
+    private:
+        uint64_t state;
+    };
+
+    double roundToTenth(double value) {
+        return round(value * 10.0) / 10.0;
+    }
+
+    string lowercase(string text) {
+        transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return tolower(c); });
+        return text;
+    }
+
+    // Calendar year of a UTC timestamp (days-to-civil, no thread-unsafe gmtime)
+    int yearOf(std::time_t timestamp) {
+        long long days = static_cast<long long>(timestamp) / 86400;
+        if (static_cast<long long>(timestamp) % 86400 < 0) --days;
+        days += 719468;
+        long long era = (days >= 0 ? days : days - 146096) / 146097;
+        long long dayOfEra = days - era * 146097;
+        long long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        long long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        long long monthIndex = (5 * dayOfYear + 2) / 153;
+        return static_cast<int>(yearOfEra + era * 400 + (monthIndex >= 10 ? 1 : 0));
+    }
+
+    int idWidth(size_t count) {
+        int digits = 1;
+        for (size_t n = count; n >= 10; n /= 10) {
+            ++digits;
+        }
+        return max(3, digits);
+    }
+}
+
+Student SampleDataGenerator::generateStudent(size_t index, const Options& options) {
+    Random random(options.seed * 0x100000001B3ULL ^ (index + 1) * 0x9E3779B97F4A7C15ULL);
+
+    bool male = (random.next() & 1) != 0;
+    string firstName = male ? MALE_NAMES[random.below(countOf(MALE_NAMES))]
+                            : FEMALE_NAMES[random.below(countOf(FEMALE_NAMES))];
+    string lastName = LAST_NAMES[random.below(countOf(LAST_NAMES))];
+
+    char id[32];
+    snprintf(id, sizeof(id), "STU%0*zu", idWidth(options.count), index + 1);
+
+    // Date of birth consistent with the age at the reference timestamp
+    int age = 17 + static_cast<int>(random.below(8));
+    char dob[32];
+    snprintf(dob, sizeof(dob), "%04d-%02d-%02d", yearOf(options.timestamp) - age,
+             1 + static_cast<int>(random.below(12)), 1 + static_cast<int>(random.below(28)));
+
+    string handle = lowercase(firstName + "." + lastName) + to_string(index + 1);
+    string email = handle + "@school.edu";
+
+    // One underlying ability per student, then per-subject spread around it
+    bool failing = random.uniform() < options.failureRate;
+    double ability = failing ? clamp(random.normal(40.0, 6.0), 20.0, 48.0)
+                             : clamp(random.normal(75.0, 11.0), 52.0, 98.0);
+
+    static const size_t subjectCount = GradeUtil::getSubjectNames().size();
+    vector<double> scores(subjectCount);
+    double total = 0.0;
+    for (double& score : scores) {
+        score = roundToTenth(clamp(random.normal(ability, 6.0), GradeUtil::MIN_SCORE, GradeUtil::MAX_SCORE));
+        total += score;
+    }
+
+    // Nudge the rare student whose spread crossed the pass line back to their side of it
+    double average = total / static_cast<double>(subjectCount);
+    double shift = 0.0;
+    if (failing && average >= GradeUtil::PASSING_THRESHOLD) {
+        shift = GradeUtil::PASSING_THRESHOLD - 1.0 - average;
+    } else if (!failing && average < GradeUtil::PASSING_THRESHOLD) {
+        shift = GradeUtil::PASSING_THRESHOLD + 1.0 - average;
+    }
+    if (shift != 0.0) {
+        for (double& score : scores) {
+            score = roundToTenth(clamp(score + shift, GradeUtil::MIN_SCORE, GradeUtil::MAX_SCORE));
+        }
+    }
+
+    Student student(id, firstName + " " + lastName, age, male ? "Male" : "Female", dob, email, scores);
+    if (options.withCredentials) {
+        student.setUsername(handle);
+        string password = "pass" + to_string(index + 1);
+        student.setPassword(options.passwordIterations > 0 ? PasswordHash::hash(password, options.passwordIterations) : password);
+    }
+    student.setLastUpdated(options.timestamp);
+    return student;
+}
+
+std::vector<Student> SampleDataGenerator::generate(const Options& options) {
+    SCOREME_TIME_SCOPE("generate_roster");
+    MemoryStats::Scope memoryScope(MemoryStats::ROSTER);
+    vector<Student> students(options.count);
+
+    size_t workers = options.threads > 0 ? options.threads : SortUtil::workerCount();
+    if (options.count < PARALLEL_THRESHOLD || workers < 2) {
+        for (size_t i = 0; i < options.count; ++i) {
+            students[i] = generateStudent(i, options);
+        }
+        return students;
+    }
+
+    // Each worker fills its own contiguous block
+    size_t blockLength = (options.count + workers - 1) / workers;
+    vector<thread> threads;
+    for (size_t start = 0; start < options.count; start += blockLength) {
+        size_t end = min(start + blockLength, options.count);
+        threads.emplace_back([&students, &options, start, end]() {
+            SCOREME_TIME_SCOPE("generate_block");
+            MemoryStats::Scope memoryScope(MemoryStats::ROSTER);
+            for (size_t i = start; i < end; ++i) {
+                students[i] = generateStudent(i, options);
+            }
+        });
+    }
+    for (auto& worker : threads) {
+        worker.join();
+    }
+    return students;
+}
+
+int SampleDataGenerator::run(int argc, char* argv[]) {
+    Options options;
+    string output = "data/students.xlsx";
+    string format;
+
+    try {
+        if (argc < 3) {
+            throw invalid_argument("missing student count");
+        }
+        options.count = stoul(argv[2]);
+
+        for (int i = 3; i < argc; ++i) {
+            string arg = argv[i];
+            if (i + 1 >= argc) {
+                throw invalid_argument("missing value for " + arg);
+            }
+            string value = argv[++i];
+            if (arg == "--out") output = value;
+            else if (arg == "--format") format = value;
+            else if (arg == "--seed") options.seed = stoull(value);
+            else if (arg == "--failure-rate") options.failureRate = clamp(stod(value), 0.0, 1.0);
+            else if (arg == "--threads") options.threads = stoul(value);
+            else throw invalid_argument("unknown option " + arg);
+        }
+    }
+    catch (const exception& e) {
+        cerr << "Invalid arguments (" << e.what() << ")\n"
+             << "Usage: --create-sample-data N [--out data/students.xlsx] [--format xlsx|csv|bin]\n"
+             << "                              [--seed 42] [--failure-rate 0.1] [--threads 0]" << endl;
+        return 2;
+    }
+
+    // Format follows the extension unless given
+    if (format.empty()) {
+        string extension = output.size() >= 4 ? lowercase(output.substr(output.size() - 4)) : "";
+        format = (extension == ".csv") ? "csv" : (extension == "xlsx") ? "xlsx" : "bin";
+    }
+    if (format != "xlsx" && format != "csv" && format != "bin") {
+        cerr << "Unknown format: " << format << endl;
+        return 2;
+    }
+    options.withCredentials = (format == "bin");   // only the binary roster keeps credentials
+    // Hash on the generator threads so the cache save never runs the full
+    // per-row key stretching; the fixture still logs in with pass<N>
+    options.passwordIterations = options.withCredentials ? PasswordHash::FIXTURE_ITERATIONS : 0;
+
+    auto start = chrono::steady_clock::now();
+    vector<Student> students = generate(options);
+    chrono::duration<double> generated = chrono::steady_clock::now() - start;
+
+    size_t failing = count_if(students.begin(), students.end(),
+                              [](const Student& s) { return !s.hasPassingGrade(); });
+
+    start = chrono::steady_clock::now();
+    bool written = false;
+    if (format == "csv") written = ExcelUtils::writeCsv(output, students);
+    else if (format == "bin") written = RosterCache::save(output, students);
+    else written = ExcelUtils::writeExcel(output, students);
+    chrono::duration<double> wrote = chrono::steady_clock::now() - start;
+
+    if (!written) {
+        cerr << "Failed to write " << output << endl;
+        return 1;
+    }
+
+    cout << fixed << setprecision(2)
+         << "Generated " << students.size() << " students (" << failing << " failing) in "
+         << generated.count() << "s; wrote " << output << " (" << format << ") in " << wrote.count() << "s" << endl;
+    return 0;
+}
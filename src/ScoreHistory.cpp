@@ -0,0 +1,491 @@
+#include "ScoreHistory.hpp"
+#include "GradeUtil.hpp"
+#include "Metrics.hpp"
+#include "ScoreIndex.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+const int ScoreHistory::AVERAGE = 0;
+const uint32_t ScoreHistory::BLOCK_POINTS = 64;
+const char ScoreHistory::MAGIC[4] = {'S', 'C', 'M', 'H'};
+const uint32_t ScoreHistory::VERSION = 1;
+
+namespace {
+    // A subject the student has no score for
+    const int32_t MISSING = numeric_limits<int32_t>::min();
+
+    int32_t toHundredths(double score) {
+        return static_cast<int32_t>(lround(score * 100.0));
+    }
+
+    double fromHundredths(int32_t score) {
+        return score / 100.0;
+    }
+
+    void writeVarint(string& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    uint64_t readVarint(const char*& p) {
+        uint64_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            uint8_t byte = static_cast<uint8_t>(*p++);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+    }
+
+    // Small rises and falls both encode to one byte
+    uint64_t zigzag(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    int64_t unzigzag(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    // Fields are written in host byte order, like the roster cache
+    template <typename T>
+    void writeValue(string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void writeString(string& out, const string& value) {
+        writeValue<uint32_t>(out, static_cast<uint32_t>(value.size()));
+        out.append(value);
+    }
+
+    class Reader {
+    public:
+        Reader(const char* data, size_t size) : data(data), size(size) {}
+
+        template <typename T>
+        T read() {
+            T value{};
+            require(sizeof(T));
+            memcpy(&value, data + offset, sizeof(T));
+            offset += sizeof(T);
+            return value;
+        }
+
+        string readString() {
+            uint32_t length = read<uint32_t>();
+            require(length);
+            string value(data + offset, length);
+            offset += length;
+            return value;
+        }
+
+        size_t remaining() const { return size - offset; }
+
+    private:
+        const char* data;
+        size_t size;
+        size_t offset = 0;
+
+        void require(size_t bytes) {
+            if (offset + bytes > size) {
+                throw runtime_error("history file is truncated");
+            }
+        }
+    };
+}
+
+// Series encoding
+void ScoreHistory::Series::append(int64_t time, int32_t score) {
+    if (blocks.empty() || blocks.back().count == BLOCK_POINTS) {
+        blocks.push_back({time, score, 1, static_cast<uint32_t>(bytes.size())});
+    } else {
+        writeVarint(bytes, static_cast<uint64_t>(time - lastTime));
+        writeVarint(bytes, zigzag(static_cast<int64_t>(score) - lastScore));
+        blocks.back().count++;
+    }
+    lastTime = time;
+    lastScore = score;
+    points++;
+}
+
+// Calls visit(time, score) for each point from the start of `block` on,
+// until it returns false
+template <typename Visit>
+void ScoreHistory::Series::decodeFrom(size_t block, Visit visit) const {
+    for (; block < blocks.size(); ++block) {
+        const Block& header = blocks[block];
+        int64_t time = header.firstTime;
+        int64_t score = header.firstScore;
+        if (!visit(time, static_cast<int32_t>(score))) {
+            return;
+        }
+        const char* p = bytes.data() + header.offset;
+        for (uint32_t i = 1; i < header.count; ++i) {
+            time += static_cast<int64_t>(readVarint(p));
+            score += unzigzag(readVarint(p));
+            if (!visit(time, static_cast<int32_t>(score))) {
+                return;
+            }
+        }
+    }
+}
+
+// The score in force at `time`: the last point at or before it
+bool ScoreHistory::Series::valueAt(int64_t time, int32_t& score) const {
+    if (points == 0 || time < blocks.front().firstTime) {
+        return false;
+    }
+    if (time >= lastTime) {
+        score = lastScore;
+        return true;
+    }
+    auto after = upper_bound(blocks.begin(), blocks.end(), time,
+                             [](int64_t t, const Block& block) { return t < block.firstTime; });
+    decodeFrom(static_cast<size_t>(after - blocks.begin()) - 1, [&](int64_t pointTime, int32_t pointScore) {
+        if (pointTime > time) {
+            return false;
+        }
+        score = pointScore;
+        return true;
+    });
+    return true;
+}
+
+// Series names
+int ScoreHistory::seriesCount() {
+    return 1 + static_cast<int>(GradeUtil::getSubjectNames().size());
+}
+
+int ScoreHistory::seriesForName(const std::string& name) {
+    // Query-style names work too, e.g. computer_science
+    string spaced = name;
+    replace(spaced.begin(), spaced.end(), '_', ' ');
+    int column = ScoreIndex::columnForName(spaced);
+    if (column == ScoreIndex::AVERAGE) return AVERAGE;
+    if (column >= ScoreIndex::FIRST_SUBJECT) return 1 + column - ScoreIndex::FIRST_SUBJECT;
+    return -1;
+}
+
+std::string ScoreHistory::seriesName(int series) {
+    if (series == AVERAGE) return "Average";
+    auto subjects = GradeUtil::getSubjectNames();
+    size_t subject = static_cast<size_t>(series - 1);
+    return subject < subjects.size() ? subjects[subject] : "";
+}
+
+std::string ScoreHistory::historyPathFor(const std::string& sourceFilename) {
+    size_t dotPos = sourceFilename.find_last_of('.');
+    size_t slashPos = sourceFilename.find_last_of("/\\");
+    if (dotPos != string::npos && (slashPos == string::npos || dotPos > slashPos)) {
+        return sourceFilename.substr(0, dotPos) + ".history";
+    }
+    return sourceFilename + ".history";
+}
+
+// Recording
+std::vector<int32_t> ScoreHistory::valuesOf(const Student& student) {
+    vector<int32_t> values(static_cast<size_t>(seriesCount()), MISSING);
+    values[AVERAGE] = toHundredths(student.getAverageScore());
+    const auto& scores = student.getSubjectScores();
+    for (size_t i = 0; i < scores.size() && i + 1 < values.size(); ++i) {
+        values[i + 1] = toHundredths(scores[i]);
+    }
+    return values;
+}
+
+void ScoreHistory::checkOrder(const Student& student, int64_t time) const {
+    auto it = indexById.find(student.getStudentId());
+    if (it == indexById.end()) {
+        return;
+    }
+    vector<int32_t> values = valuesOf(student);
+    const Series* own = &series[it->second * values.size()];
+    for (size_t s = 0; s < values.size(); ++s) {
+        if (values[s] != MISSING && own[s].points > 0 && own[s].lastScore != values[s] && time < own[s].lastTime) {
+            throw invalid_argument("history of " + student.getStudentId() + " already has points after the given time");
+        }
+    }
+}
+
+size_t ScoreHistory::append(const Student& student, int64_t time) {
+    vector<int32_t> values = valuesOf(student);
+    auto inserted = indexById.emplace(student.getStudentId(), ids.size());
+    if (inserted.second) {
+        ids.push_back(student.getStudentId());
+        series.resize(series.size() + values.size());
+    }
+
+    Series* own = &series[inserted.first->second * values.size()];
+    size_t added = 0;
+    for (size_t s = 0; s < values.size(); ++s) {
+        if (values[s] != MISSING && (own[s].points == 0 || own[s].lastScore != values[s])) {
+            own[s].append(time, values[s]);
+            added++;
+        }
+    }
+    return added;
+}
+
+size_t ScoreHistory::record(const Student& student, std::time_t time) {
+    checkOrder(student, time);
+    return append(student, time);
+}
+
+size_t ScoreHistory::record(const std::vector<Student>& students, std::time_t time) {
+    SCOREME_TIME_SCOPE("history_record");
+    // Validate everything first, so a rejected roster leaves no partial term behind
+    for (const auto& student : students) {
+        checkOrder(student, time);
+    }
+    size_t added = 0;
+    for (const auto& student : students) {
+        added += append(student, time);
+    }
+    SCOREME_COUNT("history_points_added", added);
+    return added;
+}
+
+// Reads
+std::vector<ScoreHistory::Point> ScoreHistory::range(const std::string& studentId, int seriesNumber,
+                                                     std::time_t from, std::time_t to) const {
+    vector<Point> points;
+    auto it = indexById.find(studentId);
+    if (it == indexById.end() || seriesNumber < 0 || seriesNumber >= seriesCount()) {
+        return points;
+    }
+    const Series& own = series[it->second * seriesCount() + seriesNumber];
+    if (own.points == 0) {
+        return points;
+    }
+
+    // Start in the last block that begins before `from`; it may hold the first point in range
+    auto first = lower_bound(own.blocks.begin(), own.blocks.end(), static_cast<int64_t>(from),
+                             [](const Block& block, int64_t t) { return block.firstTime < t; });
+    size_t block = first == own.blocks.begin() ? 0 : static_cast<size_t>(first - own.blocks.begin()) - 1;
+    own.decodeFrom(block, [&](int64_t time, int32_t score) {
+        if (time > to) {
+            return false;
+        }
+        if (time >= from) {
+            points.push_back({static_cast<time_t>(time), fromHundredths(score)});
+        }
+        return true;
+    });
+    return points;
+}
+
+std::vector<ScoreHistory::Change> ScoreHistory::mostImproved(int seriesNumber, std::time_t from, std::time_t to,
+                                                             size_t limit) const {
+    SCOREME_TIME_SCOPE("history_most_improved");
+    vector<Change> changes;
+    int count = seriesCount();
+    if (seriesNumber < 0 || seriesNumber >= count) {
+        return changes;
+    }
+
+    // Keep hundredths while ranking; only the survivors become doubles
+    struct Candidate {
+        size_t student;
+        int32_t from;
+        int32_t to;
+    };
+    vector<Candidate> candidates;
+    candidates.reserve(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        const Series& own = series[i * count + seriesNumber];
+        int32_t end;
+        if (!own.valueAt(to, end)) {
+            continue;
+        }
+        int32_t start;
+        if (!own.valueAt(from, start)) {
+            start = own.blocks.front().firstScore;   // First scored inside the period
+        }
+        candidates.push_back({i, start, end});
+    }
+
+    auto better = [this](const Candidate& a, const Candidate& b) {
+        int64_t riseA = static_cast<int64_t>(a.to) - a.from;
+        int64_t riseB = static_cast<int64_t>(b.to) - b.from;
+        return riseA != riseB ? riseA > riseB : ids[a.student] < ids[b.student];
+    };
+    size_t keep = min(limit, candidates.size());
+    partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(), better);
+
+    changes.reserve(keep);
+    for (size_t i = 0; i < keep; ++i) {
+        const Candidate& c = candidates[i];
+        changes.push_back({ids[c.student], fromHundredths(c.from), fromHundredths(c.to)});
+    }
+    SCOREME_COUNT("history_series_scanned", ids.size());
+    return changes;
+}
+
+bool ScoreHistory::contains(const std::string& studentId) const {
+    return indexById.count(studentId) > 0;
+}
+
+size_t ScoreHistory::pointCount() const {
+    size_t total = 0;
+    for (const auto& own : series) {
+        total += own.points;
+    }
+    return total;
+}
+
+size_t ScoreHistory::encodedBytes() const {
+    size_t total = 0;
+    for (const auto& own : series) {
+        total += own.bytes.size() + own.blocks.size() * sizeof(Block);
+    }
+    return total;
+}
+
+// Persistence: the encoded series are written as they are
+bool ScoreHistory::save(const std::string& filename) const {
+    SCOREME_TIME_SCOPE("history_save");
+    // Write to a temporary file first so a crash never loses the history
+    string tempFilename = filename + ".tmp";
+    ofstream file(tempFilename, ios::binary | ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    const size_t flushSize = 1 << 20;
+    string out;
+    out.reserve(flushSize + 4096);
+    auto flushOut = [&file, &out]() {
+        file.write(out.data(), static_cast<streamsize>(out.size()));
+        out.clear();
+    };
+
+    int count = seriesCount();
+    out.append(MAGIC, sizeof(MAGIC));
+    writeValue<uint32_t>(out, VERSION);
+    writeValue<uint32_t>(out, static_cast<uint32_t>(count));
+    writeValue<uint64_t>(out, ids.size());
+
+    for (size_t i = 0; i < ids.size(); ++i) {
+        writeString(out, ids[i]);
+        for (int s = 0; s < count; ++s) {
+            const Series& own = series[i * count + s];
+            writeValue<uint32_t>(out, own.points);
+            writeValue<int64_t>(out, own.lastTime);
+            writeValue<int32_t>(out, own.lastScore);
+            writeValue<uint32_t>(out, static_cast<uint32_t>(own.blocks.size()));
+            for (const auto& block : own.blocks) {
+                writeValue<int64_t>(out, block.firstTime);
+                writeValue<int32_t>(out, block.firstScore);
+                writeValue<uint32_t>(out, block.count);
+                writeValue<uint32_t>(out, block.offset);
+            }
+            writeString(out, own.bytes);
+        }
+        if (out.size() >= flushSize) {
+            flushOut();
+        }
+    }
+
+    flushOut();
+    file.close();
+    if (!file) {
+        return false;
+    }
+
+    error_code ec;
+    filesystem::rename(tempFilename, filename, ec);
+    return !ec;
+}
+
+bool ScoreHistory::load(const std::string& filename) {
+    SCOREME_TIME_SCOPE("history_load");
+    ifstream file(filename, ios::binary | ios::ate);
+    if (!file) {
+        return false;
+    }
+
+    string data(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(&data[0], static_cast<streamsize>(data.size()));
+
+    Reader reader(data.data(), data.size());
+    char magic[4];
+    for (char& c : magic) {
+        c = reader.read<char>();
+    }
+    if (memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || reader.read<uint32_t>() != VERSION) {
+        throw runtime_error(filename + " is not a score history file");
+    }
+    int count = seriesCount();
+    if (reader.read<uint32_t>() != static_cast<uint32_t>(count)) {
+        throw runtime_error(filename + " was written for a different subject list");
+    }
+
+    // Counts are checked against the bytes left before anything is sized by
+    // them, so a damaged count is reported rather than allocated
+    uint64_t students = reader.read<uint64_t>();
+    const size_t seriesHeaderBytes = 4 + 8 + 4 + 4 + 4;   // points, last time and score, block count, byte length
+    const size_t blockHeaderBytes = 8 + 4 + 4 + 4;
+    if (students > reader.remaining() / (4 + seriesHeaderBytes * count)) {
+        throw runtime_error(filename + " is damaged: it claims " + to_string(students) + " students");
+    }
+    vector<string> loadedIds;
+    vector<Series> loadedSeries;
+    unordered_map<string, size_t> loadedIndex;
+    loadedIds.reserve(static_cast<size_t>(students));
+    loadedSeries.resize(static_cast<size_t>(students) * count);
+    loadedIndex.reserve(static_cast<size_t>(students));
+
+    for (uint64_t i = 0; i < students; ++i) {
+        loadedIds.push_back(reader.readString());
+        loadedIndex.emplace(loadedIds.back(), loadedIds.size() - 1);
+        for (int s = 0; s < count; ++s) {
+            Series& own = loadedSeries[i * count + s];
+            own.points = reader.read<uint32_t>();
+            own.lastTime = reader.read<int64_t>();
+            own.lastScore = reader.read<int32_t>();
+            uint32_t blocks = reader.read<uint32_t>();
+            if (blocks > reader.remaining() / blockHeaderBytes) {
+                throw runtime_error(filename + " has a damaged series for " + loadedIds.back());
+            }
+            own.blocks.resize(blocks);
+            uint32_t points = 0;
+            for (auto& block : own.blocks) {
+                block.firstTime = reader.read<int64_t>();
+                block.firstScore = reader.read<int32_t>();
+                block.count = reader.read<uint32_t>();
+                block.offset = reader.read<uint32_t>();
+                points += block.count;
+            }
+            own.bytes = reader.readString();
+            // Decoding trusts the headers, so check they agree with the bytes they describe
+            for (size_t b = 0; b < own.blocks.size(); ++b) {
+                uint32_t end = b + 1 < own.blocks.size() ? own.blocks[b + 1].offset
+                                                         : static_cast<uint32_t>(own.bytes.size());
+                if (own.blocks[b].count == 0 || own.blocks[b].count > BLOCK_POINTS ||
+                    own.blocks[b].offset > end || end > own.bytes.size() ||
+                    end - own.blocks[b].offset < 2 * (own.blocks[b].count - 1)) {
+                    throw runtime_error(filename + " has a damaged series for " + loadedIds.back());
+                }
+            }
+            if (points != own.points || (!own.bytes.empty() && (own.bytes.back() & 0x80))) {
+                throw runtime_error(filename + " has a damaged series for " + loadedIds.back());
+            }
+        }
+    }
+
+    ids.swap(loadedIds);
+    series.swap(loadedSeries);
+    indexById.swap(loadedIndex);
+    return true;
+}
@@ -0,0 +1,219 @@
+#include "ScoreIndex.hpp"
+#include "MemoryStats.hpp"
+#include "GradeUtil.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
+
+// Column layout
+const int ScoreIndex::AVERAGE = 0;
+const int ScoreIndex::GPA = 1;
+const int ScoreIndex::GRADE = 2;
+const int ScoreIndex::FIRST_SUBJECT = 3;
+
+namespace {
+    std::string toLower(const std::string& text) {
+        std::string result = text;
+        for (char& c : result) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return result;
+    }
+}
+
+// Sorted column helpers
+void ScoreIndex::SortedColumn::insert(double key, uint32_t position) {
+    size_t i = std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+    while (i < keys.size() && keys[i] == key && positions[i] < position) {
+        ++i;
+    }
+    keys.insert(keys.begin() + i, key);
+    positions.insert(positions.begin() + i, position);
+}
+
+void ScoreIndex::SortedColumn::erase(double key, uint32_t position) {
+    size_t i = std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+    while (i < keys.size() && keys[i] == key) {
+        if (positions[i] == position) {
+            keys.erase(keys.begin() + i);
+            positions.erase(positions.begin() + i);
+            return;
+        }
+        ++i;
+    }
+}
+
+void ScoreIndex::SortedColumn::shiftFrom(uint32_t position, int delta) {
+    for (auto& p : positions) {
+        if (p >= position) {
+            p = static_cast<uint32_t>(static_cast<int64_t>(p) + delta);
+        }
+    }
+}
+
+// Build and maintenance
+void ScoreIndex::rebuild(const std::vector<Student>& students) {
+    MemoryStats::Scope memoryScope(MemoryStats::INDEX);
+    columns.assign(columnCount(), SortedColumn());
+    keysAtPosition.clear();
+    keysAtPosition.reserve(students.size());
+
+    for (const auto& student : students) {
+        keysAtPosition.push_back(extractKeys(student));
+    }
+
+    std::vector<std::pair<double, uint32_t>> entries(students.size());
+    for (int c = 0; c < columnCount(); ++c) {
+        for (size_t i = 0; i < students.size(); ++i) {
+            entries[i] = {keysAtPosition[i][c], static_cast<uint32_t>(i)};
+        }
+        std::sort(entries.begin(), entries.end());
+
+        SortedColumn& column = columns[c];
+        column.keys.resize(entries.size());
+        column.positions.resize(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            column.keys[i] = entries[i].first;
+            column.positions[i] = entries[i].second;
+        }
+    }
+}
+
+void ScoreIndex::addStudent(const Student& student, size_t position) {
+    if (columns.empty()) {
+        columns.assign(columnCount(), SortedColumn());
+    }
+
+    std::vector<double> keys = extractKeys(student);
+    uint32_t pos = static_cast<uint32_t>(position);
+
+    for (int c = 0; c < columnCount(); ++c) {
+        if (position < keysAtPosition.size()) {
+            columns[c].shiftFrom(pos, +1);
+        }
+        columns[c].insert(keys[c], pos);
+    }
+    keysAtPosition.insert(keysAtPosition.begin() + std::min(position, keysAtPosition.size()), keys);
+}
+
+void ScoreIndex::removeStudent(size_t position) {
+    if (position >= keysAtPosition.size()) {
+        return;
+    }
+
+    uint32_t pos = static_cast<uint32_t>(position);
+    for (int c = 0; c < columnCount(); ++c) {
+        columns[c].erase(keysAtPosition[position][c], pos);
+        columns[c].shiftFrom(pos + 1, -1);
+    }
+    keysAtPosition.erase(keysAtPosition.begin() + position);
+}
+
+void ScoreIndex::updateStudent(const Student& student, size_t position) {
+    if (position >= keysAtPosition.size()) {
+        return;
+    }
+
+    std::vector<double> keys = extractKeys(student);
+    uint32_t pos = static_cast<uint32_t>(position);
+
+    for (int c = 0; c < columnCount(); ++c) {
+        if (keys[c] != keysAtPosition[position][c]) {
+            columns[c].erase(keysAtPosition[position][c], pos);
+            columns[c].insert(keys[c], pos);
+        }
+    }
+    keysAtPosition[position] = keys;
+}
+
+// Queries
+StudentView ScoreIndex::range(const std::vector<Student>& students, int column, double low, double high) const {
+    if (column < 0 || column >= static_cast<int>(columns.size()) || !(low < high)) {
+        return StudentView(students, std::vector<uint32_t>());
+    }
+
+    const SortedColumn& sorted = columns[column];
+    size_t from = std::lower_bound(sorted.keys.begin(), sorted.keys.end(), low) - sorted.keys.begin();
+    size_t to = std::lower_bound(sorted.keys.begin(), sorted.keys.end(), high) - sorted.keys.begin();
+
+    const uint32_t* base = sorted.positions.data();
+    return StudentView(students, base + from, base + to);
+}
+
+StudentView ScoreIndex::below(const std::vector<Student>& students, int column, double threshold) const {
+    return range(students, column, -std::numeric_limits<double>::infinity(), threshold);
+}
+
+StudentView ScoreIndex::atLeast(const std::vector<Student>& students, int column, double threshold) const {
+    return range(students, column, threshold, std::numeric_limits<double>::infinity());
+}
+
+StudentView ScoreIndex::failing(const std::vector<Student>& students) const {
+    return below(students, AVERAGE, GradeUtil::PASSING_THRESHOLD);
+}
+
+StudentView ScoreIndex::gradeOrWorse(const std::vector<Student>& students, int column, const std::string& grade) const {
+    if (column == GRADE) {
+        return below(students, GRADE, GradeUtil::gradeRank(grade) + 1);
+    }
+    if (column == GPA) {
+        double gpa = GradeUtil::calculateGpa(GradeUtil::getGradeLowerBound(grade));
+        return below(students, GPA, std::nextafter(gpa, std::numeric_limits<double>::infinity()));
+    }
+    return below(students, column, GradeUtil::getGradeUpperBound(grade));
+}
+
+// Column helpers
+int ScoreIndex::columnCount() {
+    return FIRST_SUBJECT + static_cast<int>(GradeUtil::getSubjectNames().size());
+}
+
+int ScoreIndex::columnForName(const std::string& name) {
+    std::string key = toLower(name);
+    if (key == "average" || key == "avg" || key == "average score") return AVERAGE;
+    if (key == "gpa") return GPA;
+    if (key == "grade" || key == "letter grade") return GRADE;
+
+    auto subjects = GradeUtil::getSubjectNames();
+    for (size_t i = 0; i < subjects.size(); ++i) {
+        if (toLower(subjects[i]) == key) {
+            return FIRST_SUBJECT + static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+std::vector<std::string> ScoreIndex::getColumnNames() {
+    std::vector<std::string> names = {"Average", "GPA", "Grade"};
+    auto subjects = GradeUtil::getSubjectNames();
+    names.insert(names.end(), subjects.begin(), subjects.end());
+    return names;
+}
+
+double ScoreIndex::keyFor(const Student& student, int column) {
+    if (column == AVERAGE) return student.getAverageScore();
+    if (column == GPA) return student.getGpa();
+    if (column == GRADE) return GradeUtil::gradeRank(student.getLetterGrade());
+
+    const auto& scores = student.getSubjectScores();
+    size_t subject = static_cast<size_t>(column - FIRST_SUBJECT);
+    return subject < scores.size() ? scores[subject] : 0.0;
+}
+
+size_t ScoreIndex::size() const {
+    return keysAtPosition.size();
+}
+
+std::vector<double> ScoreIndex::extractKeys(const Student& student) {
+    std::vector<double> keys(columnCount(), 0.0);
+    keys[AVERAGE] = student.getAverageScore();
+    keys[GPA] = student.getGpa();
+    keys[GRADE] = GradeUtil::gradeRank(student.getLetterGrade());
+
+    const auto& scores = student.getSubjectScores();
+    for (size_t i = 0; i < scores.size() && FIRST_SUBJECT + i < keys.size(); ++i) {
+        keys[FIRST_SUBJECT + i] = scores[i];
+    }
+    return keys;
+}
@@ -0,0 +1,460 @@
+#include "SearchIndex.hpp"
+#include "MemoryStats.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+
+// Ranking scores
+const int SearchIndex::EXACT_SCORE = 1000;
+const int SearchIndex::PREFIX_SCORE = 800;
+const int SearchIndex::SUBSTRING_SCORE = 600;
+const int SearchIndex::FUZZY_SCORE = 400;
+
+namespace {
+    // Keeps a one-letter prefix query from walking the whole dictionary
+    const size_t MAX_PREFIX_TERMS = 20000;
+
+    // Posting lists longer than this are "frequent" in the fuzzy pass
+    const size_t FREQUENT_TRIGRAM_MIN = 4096;
+    const size_t FREQUENT_TRIGRAM_SHARE = 32;   // ... or than this fraction of the documents
+
+    // Word boundary marker, so short typos still share the leading trigrams
+    const char BOUNDARY = '\x02';
+
+    uint32_t packTrigram(const std::string& text, size_t i) {
+        return (static_cast<uint32_t>(static_cast<unsigned char>(text[i])) << 16) |
+               (static_cast<uint32_t>(static_cast<unsigned char>(text[i + 1])) << 8) |
+                static_cast<uint32_t>(static_cast<unsigned char>(text[i + 2]));
+    }
+
+    bool startsWith(const std::string& text, const std::string& prefix) {
+        return text.size() >= prefix.size() && text.compare(0, prefix.size(), prefix) == 0;
+    }
+
+    void eraseSorted(std::vector<uint32_t>& postings, uint32_t docId) {
+        auto it = std::lower_bound(postings.begin(), postings.end(), docId);
+        if (it != postings.end() && *it == docId) {
+            postings.erase(it);
+        }
+    }
+}
+
+// Build and maintenance
+void SearchIndex::rebuild(const std::vector<Student>& students) {
+    MemoryStats::Scope memoryScope(MemoryStats::INDEX);
+    documents.clear();
+    documentAtPosition.clear();
+    termPostings.clear();
+    trigramPostings.clear();
+
+    documents.reserve(students.size());
+    documentAtPosition.reserve(students.size());
+    for (size_t i = 0; i < students.size(); ++i) {
+        addStudent(students[i], i);
+    }
+}
+
+void SearchIndex::addStudent(const Student& student, size_t position) {
+    uint32_t docId = static_cast<uint32_t>(documents.size());
+
+    Document doc;
+    doc.position = position;
+    doc.terms = extractTerms(student);
+    doc.trigrams = extractTrigrams(doc.terms, true);
+    doc.alive = true;
+    documents.push_back(std::move(doc));
+
+    // Inserting in the middle shifts every later student down one slot
+    if (position < documentAtPosition.size()) {
+        for (uint32_t i = 0; i < docId; ++i) {
+            if (documents[i].alive && documents[i].position >= position) {
+                documents[i].position++;
+            }
+        }
+        documentAtPosition.insert(documentAtPosition.begin() + position, docId);
+    } else {
+        documentAtPosition.push_back(docId);
+    }
+
+    indexDocument(docId);
+}
+
+void SearchIndex::removeStudent(size_t position) {
+    if (position >= documentAtPosition.size()) {
+        return;
+    }
+
+    uint32_t docId = documentAtPosition[position];
+    unindexDocument(docId);
+    documents[docId].alive = false;
+    documentAtPosition.erase(documentAtPosition.begin() + position);
+
+    for (auto& doc : documents) {
+        if (doc.alive && doc.position > position) {
+            doc.position--;
+        }
+    }
+}
+
+void SearchIndex::updateStudent(const Student& student, size_t position) {
+    if (position >= documentAtPosition.size()) {
+        return;
+    }
+
+    uint32_t docId = documentAtPosition[position];
+    unindexDocument(docId);
+    documents[docId].terms = extractTerms(student);
+    documents[docId].trigrams = extractTrigrams(documents[docId].terms, true);
+    indexDocument(docId);
+}
+
+// Queries
+std::vector<SearchResult> SearchIndex::search(const std::string& query, size_t limit) const {
+    std::vector<SearchResult> results;
+    std::string q = normalize(query);
+    if (q.empty() || limit == 0) {
+        return results;
+    }
+
+    // Best score seen per document
+    std::unordered_map<uint32_t, SearchResult> best;
+    auto consider = [&](uint32_t docId, int score, int distance) {
+        const Document& doc = documents[docId];
+        auto it = best.find(docId);
+        if (it == best.end()) {
+            best.emplace(docId, SearchResult{doc.position, score, distance});
+        } else if (score > it->second.score) {
+            it->second.score = score;
+            it->second.distance = distance;
+        }
+    };
+
+    // Exact and prefix hits from the ordered term dictionary
+    size_t scanned = 0;
+    for (auto it = termPostings.lower_bound(q);
+         it != termPostings.end() && startsWith(it->first, q) && scanned < MAX_PREFIX_TERMS;
+         ++it, ++scanned) {
+        int extra = static_cast<int>(it->first.size() - q.size());
+        int score = (extra == 0) ? EXACT_SCORE : PREFIX_SCORE - std::min(extra, 100);
+        for (uint32_t docId : it->second) {
+            consider(docId, score, 0);
+        }
+    }
+
+    // Substring hits need at least one whole trigram inside the query, and
+    // cannot displace exact or prefix hits that already fill `limit`
+    if (q.size() >= 3 && best.size() < limit) {
+        std::vector<uint32_t> queryTrigrams = extractTrigrams({q}, false);
+
+        // Substring hits: documents holding every query trigram, then verified
+        std::vector<const std::vector<uint32_t>*> lists;
+        bool missing = false;
+        for (uint32_t trigram : queryTrigrams) {
+            auto it = trigramPostings.find(trigram);
+            if (it == trigramPostings.end()) {
+                missing = true;
+                break;
+            }
+            lists.push_back(&it->second);
+        }
+
+        if (!missing && !lists.empty()) {
+            std::sort(lists.begin(), lists.end(),
+                [](const std::vector<uint32_t>* a, const std::vector<uint32_t>* b) {
+                    return a->size() < b->size();
+                });
+
+            std::vector<uint32_t> candidates = *lists[0];
+            for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+                std::vector<uint32_t> narrowed;
+                std::set_intersection(candidates.begin(), candidates.end(),
+                                      lists[i]->begin(), lists[i]->end(),
+                                      std::back_inserter(narrowed));
+                candidates.swap(narrowed);
+            }
+
+            for (uint32_t docId : candidates) {
+                for (const auto& term : documents[docId].terms) {
+                    if (term.find(q) != std::string::npos) {
+                        consider(docId, SUBSTRING_SCORE, 0);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // Fuzzy hits score below every hit above, so they only fill places those
+    // left open, nearest first: once a distance fills `limit`, further ones
+    // could not make the cut
+    if (best.size() < limit) {
+        std::vector<uint32_t> queryTrigrams = extractTrigrams({q}, true);
+
+        // Trigrams shared by a large part of the roster ("stu" in every ID)
+        // are not walked while the count can be reached without them; they
+        // only add to the counts of candidates found through the rarer ones
+        std::vector<const std::vector<uint32_t>*> lists;
+        for (uint32_t trigram : queryTrigrams) {
+            auto it = trigramPostings.find(trigram);
+            if (it != trigramPostings.end()) {
+                lists.push_back(&it->second);
+            }
+        }
+        std::sort(lists.begin(), lists.end(),
+            [](const std::vector<uint32_t>* a, const std::vector<uint32_t>* b) {
+                return a->size() < b->size();
+            });
+        size_t frequentSize = std::max(FREQUENT_TRIGRAM_MIN, documents.size() / FREQUENT_TRIGRAM_SHARE);
+        size_t frequentCount = static_cast<size_t>(std::count_if(lists.begin(), lists.end(),
+            [frequentSize](const std::vector<uint32_t>* postings) { return postings->size() > frequentSize; }));
+
+        // Hit counts live in a per-thread scratch buffer that is only ever
+        // grown, and only the touched slots are cleared afterwards, so a query
+        // costs its postings rather than the roster size. Per thread because
+        // server readers search one shared index concurrently.
+        thread_local std::vector<uint8_t> shared;
+        if (shared.size() < documents.size()) {
+            shared.resize(documents.size(), 0);
+        }
+        std::vector<uint32_t> touched;
+
+        int maxDistance = maxDistanceFor(q);
+        for (int distance = 1; distance <= maxDistance && best.size() < limit; ++distance) {
+            // An edit breaks at most three of the query's padded trigrams, an
+            // adjacent swap four
+            int needed = std::max(1, static_cast<int>(queryTrigrams.size()) - 4 * distance);
+
+            // Skipping fewer lists than `needed` keeps every match reachable
+            size_t probed = std::min(frequentCount, static_cast<size_t>(needed - 1));
+            size_t walked = lists.size() - probed;
+            int walkedNeeded = needed - static_cast<int>(probed);
+
+            touched.clear();
+            for (size_t l = 0; l < walked; ++l) {
+                for (uint32_t docId : *lists[l]) {
+                    if (shared[docId] == 0) {
+                        touched.push_back(docId);
+                    }
+                    if (shared[docId] < 255) {
+                        shared[docId]++;
+                    }
+                }
+            }
+
+            for (uint32_t docId : touched) {
+                int count = shared[docId];
+                if (count < walkedNeeded || best.count(docId) != 0) {
+                    continue;
+                }
+                for (size_t l = walked; l < lists.size() && count < needed; ++l) {
+                    if (std::binary_search(lists[l]->begin(), lists[l]->end(), docId)) {
+                        ++count;
+                    }
+                }
+                if (count < needed) {
+                    continue;
+                }
+
+                int closest = distance + 1;
+                for (const auto& term : documents[docId].terms) {
+                    if (std::abs(static_cast<int>(term.size()) - static_cast<int>(q.size())) > distance) {
+                        continue;
+                    }
+                    closest = std::min(closest, boundedEditDistance(q, term, distance));
+                    if (closest == 0) break;
+                }
+
+                if (closest <= distance) {
+                    consider(docId, FUZZY_SCORE - 100 * closest, closest);
+                }
+            }
+
+            for (uint32_t docId : touched) {
+                shared[docId] = 0;
+            }
+        }
+    }
+
+    // Top-k by score, then roster order
+    results.reserve(best.size());
+    for (const auto& entry : best) {
+        results.push_back(entry.second);
+    }
+
+    auto ranking = [](const SearchResult& a, const SearchResult& b) {
+        if (a.score != b.score) return a.score > b.score;
+        return a.position < b.position;
+    };
+
+    if (results.size() > limit) {
+        std::partial_sort(results.begin(), results.begin() + limit, results.end(), ranking);
+        results.resize(limit);
+    } else {
+        std::sort(results.begin(), results.end(), ranking);
+    }
+
+    return results;
+}
+
+size_t SearchIndex::size() const {
+    return documentAtPosition.size();
+}
+
+// Text helpers
+std::string SearchIndex::normalize(const std::string& text) {
+    std::string result;
+    result.reserve(text.size());
+
+    bool pendingSpace = false;
+    for (char c : text) {
+        unsigned char uc = static_cast<unsigned char>(c);
+        if (std::isspace(uc)) {
+            pendingSpace = !result.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            result += ' ';
+            pendingSpace = false;
+        }
+        result += static_cast<char>(std::tolower(uc));
+    }
+
+    return result;
+}
+
+int SearchIndex::boundedEditDistance(const std::string& a, const std::string& b, int maxDistance) {
+    int n = static_cast<int>(a.size());
+    int m = static_cast<int>(b.size());
+    if (std::abs(n - m) > maxDistance) {
+        return maxDistance + 1;
+    }
+
+    // Levenshtein with adjacent transpositions (optimal string alignment),
+    // giving up once a whole row exceeds the bound. The three rows live in a
+    // per-thread buffer, so verifying thousands of candidates allocates nothing.
+    thread_local std::vector<int> rows;
+    if (rows.size() < 3 * static_cast<size_t>(m + 1)) {
+        rows.resize(3 * static_cast<size_t>(m + 1));
+    }
+    int* beforePrevious = rows.data();
+    int* previous = beforePrevious + (m + 1);
+    int* current = previous + (m + 1);
+    for (int j = 0; j <= m; ++j) {
+        previous[j] = j;
+    }
+
+    for (int i = 1; i <= n; ++i) {
+        current[0] = i;
+        int rowBest = current[0];
+        for (int j = 1; j <= m; ++j) {
+            int cost = (a[i - 1] == b[j - 1]) ? 0 : 1;
+            current[j] = std::min({previous[j] + 1, current[j - 1] + 1, previous[j - 1] + cost});
+            if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) {
+                current[j] = std::min(current[j], beforePrevious[j - 2] + 1);
+            }
+            rowBest = std::min(rowBest, current[j]);
+        }
+        if (rowBest > maxDistance) {
+            return maxDistance + 1;
+        }
+        int* oldest = beforePrevious;
+        beforePrevious = previous;
+        previous = current;
+        current = oldest;
+    }
+
+    return std::min(previous[m], maxDistance + 1);
+}
+
+bool SearchIndex::fuzzyMatches(const std::string& query, const std::string& text) {
+    std::string q = normalize(query);
+    std::string t = normalize(text);
+    if (q.empty()) {
+        return false;
+    }
+    return boundedEditDistance(q, t, maxDistanceFor(q)) <= maxDistanceFor(q);
+}
+
+// Helper methods
+std::vector<std::string> SearchIndex::extractTerms(const Student& student) {
+    std::vector<std::string> terms;
+
+    std::string name = normalize(student.getName());
+    std::string id = normalize(student.getStudentId());
+    std::string email = normalize(student.getEmail());
+
+    if (!name.empty()) {
+        terms.push_back(name);
+        std::istringstream words(name);
+        std::string word;
+        while (words >> word) {
+            terms.push_back(word);
+        }
+    }
+    if (!id.empty()) {
+        terms.push_back(id);
+    }
+    if (!email.empty()) {
+        terms.push_back(email);
+        size_t at = email.find('@');
+        if (at != std::string::npos && at > 0) {
+            terms.push_back(email.substr(0, at));
+        }
+    }
+
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+    return terms;
+}
+
+std::vector<uint32_t> SearchIndex::extractTrigrams(const std::vector<std::string>& terms, bool padded) {
+    std::vector<uint32_t> trigrams;
+    for (const auto& term : terms) {
+        std::string text = padded ? std::string(2, BOUNDARY) + term + BOUNDARY : term;
+        for (size_t i = 0; i + 2 < text.size(); ++i) {
+            trigrams.push_back(packTrigram(text, i));
+        }
+    }
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+int SearchIndex::maxDistanceFor(const std::string& query) {
+    return query.size() <= 4 ? 1 : 2;
+}
+
+void SearchIndex::indexDocument(uint32_t docId) {
+    // Re-indexed documents keep their id, so insert at the sorted slot
+    const Document& doc = documents[docId];
+    for (const auto& term : doc.terms) {
+        auto& postings = termPostings[term];
+        postings.insert(std::upper_bound(postings.begin(), postings.end(), docId), docId);
+    }
+    for (uint32_t trigram : doc.trigrams) {
+        auto& postings = trigramPostings[trigram];
+        postings.insert(std::upper_bound(postings.begin(), postings.end(), docId), docId);
+    }
+}
+
+void SearchIndex::unindexDocument(uint32_t docId) {
+    const Document& doc = documents[docId];
+    for (const auto& term : doc.terms) {
+        auto it = termPostings.find(term);
+        if (it == termPostings.end()) continue;
+        eraseSorted(it->second, docId);
+        if (it->second.empty()) {
+            termPostings.erase(it);
+        }
+    }
+    for (uint32_t trigram : doc.trigrams) {
+        auto it = trigramPostings.find(trigram);
+        if (it == trigramPostings.end()) continue;
+        eraseSorted(it->second, docId);
+        if (it->second.empty()) {
+            trigramPostings.erase(it);
+        }
+    }
+}
@@ -0,0 +1,8 @@
+#include "SortUtil.hpp"
+
+const size_t SortUtil::PARALLEL_THRESHOLD = 50000;
+
+size_t SortUtil::workerCount() {
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores == 0 ? 1 : cores;
+}
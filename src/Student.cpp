@@ -1,7 +1,9 @@
 #include "Student.hpp"
+#include "Metrics.hpp"
 #include "GradeUtil.hpp"
 #include "MenuUtils.hpp"
 #include "ExcelUtil.hpp"
+#include "SearchIndex.hpp"
 #include <iostream>
 #include <algorithm>
 #include <ctime>
@@ -32,16 +34,16 @@ Student::Student(const std::string& username, const std::string& password,
 }
 
 // Getters
-std::string Student::getStudentId() const { return studentId; }
+const std::string& Student::getStudentId() const { return studentId; }
 int Student::getAge() const { return age; }
-std::string Student::getGender() const { return gender; }
-std::string Student::getDateOfBirth() const { return dateOfBirth; }
-std::string Student::getEmail() const { return email; }
-std::vector<double> Student::getSubjectScores() const { return subjectScores; }
+const std::string& Student::getGender() const { return gender; }
+const std::string& Student::getDateOfBirth() const { return dateOfBirth; }
+const std::string& Student::getEmail() const { return email; }
+const std::vector<double>& Student::getSubjectScores() const { return subjectScores; }
 double Student::getAverageScore() const { return averageScore; }
-std::string Student::getLetterGrade() const { return letterGrade; }
+const std::string& Student::getLetterGrade() const { return letterGrade; }
 double Student::getGpa() const { return gpa; }
-std::string Student::getRemark() const { return remark; }
+const std::string& Student::getRemark() const { return remark; }
 std::time_t Student::getLastUpdated() const { return lastUpdated; }
 
 // Setters
@@ -76,6 +78,10 @@ void Student::setSubjectScores(const std::vector<double>& scores) {
     updateTimestamp();
 }
 
+void Student::setLastUpdated(std::time_t timestamp) {
+    lastUpdated = timestamp;
+}
+
 // Calculation methods
 void Student::calculateAverageScore() {
     averageScore = GradeUtil::calculateAverage(subjectScores);
@@ -94,6 +100,7 @@ void Student::assignRemark() {
 }
 
 void Student::updateAllGrades() {
+    SCOREME_COUNT("grading_recalculations", 1);
     calculateAverageScore();
     assignLetterGrade();
     calculateGpa();
@@ -128,7 +135,8 @@ void Student::showMenu() {
                 MenuUtils::printHeader("SEARCH YOUR DATA");
                 std::string searchTerm = MenuUtils::getStringInput("Enter your Student ID or Name: ");
                 
-                if (searchTerm == studentId || searchTerm == name) {
+                // Tolerate case differences and small typos in the student's own ID or name
+                if (SearchIndex::fuzzyMatches(searchTerm, studentId) || SearchIndex::fuzzyMatches(searchTerm, name)) {
                     MenuUtils::displayStudentDetails(*this);
                 } else {
                     MenuUtils::printError("No matching record found!");
@@ -0,0 +1,254 @@
+#include "TableRenderer.hpp"
+#include "MenuUtils.hpp"
+#include "GradeUtil.hpp"
+#include <tabulate/table.hpp>
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <iostream>
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+const TableRenderer::RowStyle TableRenderer::PLAIN = {nullptr, false};
+
+namespace {
+    const char* const BOLD_CODE = "\033[1m";
+    const char* const RESET_CODE = "\033[0m";
+    const char* const CYAN_CODE = "\033[36m";
+    const char* const GREEN_CODE = "\033[32m";
+    const char* const RED_CODE = "\033[31m";
+
+    // Matches std::to_string(double), i.e. printf("%f")
+    std::string_view formatFixed(char* buf, size_t size, double value, int precision = 6) {
+        auto result = std::to_chars(buf, buf + size, value, std::chars_format::fixed, precision);
+        return std::string_view(buf, result.ptr - buf);
+    }
+
+    std::string_view formatInt(char* buf, size_t size, int value) {
+        auto result = std::to_chars(buf, buf + size, value);
+        return std::string_view(buf, result.ptr - buf);
+    }
+
+    // Number cells of one student row, formatted into stack buffers
+    struct NumberCells {
+        char age[16];
+        char average[48];
+        char gpa[48];
+        std::string_view ageText, averageText, gpaText;
+
+        explicit NumberCells(const Student& student) {
+            ageText = formatInt(age, sizeof(age), student.getAge());
+            averageText = formatFixed(average, sizeof(average),
+                                      static_cast<int>(student.getAverageScore() * 100) / 100.0);
+            gpaText = formatFixed(gpa, sizeof(gpa), student.getGpa());
+        }
+    };
+
+    const size_t STUDENT_COLUMNS = 8;
+    const std::string_view STUDENT_HEADER[STUDENT_COLUMNS] = {
+        "ID", "Name", "Age", "Gender", "Average", "Grade", "GPA", "Remark"
+    };
+}
+
+// Student list
+void TableRenderer::renderStudentRows(const StudentView& students, size_t first, size_t last,
+                                      const std::vector<size_t>& minWidths) {
+    last = std::min(last, students.size());
+
+    size_t widths[STUDENT_COLUMNS];
+    for (size_t c = 0; c < STUDENT_COLUMNS; ++c) {
+        widths[c] = STUDENT_HEADER[c].size();
+        if (c < minWidths.size()) {
+            widths[c] = std::max(widths[c], minWidths[c]);
+        }
+    }
+
+    // First pass: measure the visible rows
+    for (size_t i = first; i < last; ++i) {
+        const Student& student = students[i];
+        NumberCells numbers(student);
+        widths[0] = std::max(widths[0], displayWidth(student.getStudentId()));
+        widths[1] = std::max(widths[1], displayWidth(student.getName()));
+        widths[2] = std::max(widths[2], numbers.ageText.size());
+        widths[3] = std::max(widths[3], displayWidth(student.getGender()));
+        widths[4] = std::max(widths[4], numbers.averageText.size());
+        widths[5] = std::max(widths[5], displayWidth(student.getLetterGrade()));
+        widths[6] = std::max(widths[6], numbers.gpaText.size());
+        widths[7] = std::max(widths[7], displayWidth(student.getRemark()));
+    }
+
+    // Second pass: format straight into the shared buffer
+    std::string& out = buffer();
+    appendBorder(out, widths, STUDENT_COLUMNS);
+    appendRow(out, STUDENT_HEADER, widths, STUDENT_COLUMNS, RowStyle{CYAN_CODE, true});
+    appendBorder(out, widths, STUDENT_COLUMNS);
+
+    for (size_t i = first; i < last; ++i) {
+        const Student& student = students[i];
+        NumberCells numbers(student);
+        std::string_view cells[STUDENT_COLUMNS] = {
+            student.getStudentId(), student.getName(), numbers.ageText, student.getGender(),
+            numbers.averageText, student.getLetterGrade(), numbers.gpaText, student.getRemark()
+        };
+
+        RowStyle style{colorCode(MenuUtils::getGradeColor(student.getLetterGrade())),
+                       student.getRemark() == "Fail"};
+        appendRow(out, cells, widths, STUDENT_COLUMNS, style);
+        appendBorder(out, widths, STUDENT_COLUMNS);
+    }
+
+    flush(out);
+}
+
+// Two-column tables
+void TableRenderer::renderTwoColumn(const std::vector<std::pair<std::string, std::string>>& rows,
+                                    const std::vector<RowStyle>& styles) {
+    if (rows.empty()) {
+        return;
+    }
+
+    size_t widths[2] = {0, 0};
+    for (const auto& row : rows) {
+        widths[0] = std::max(widths[0], displayWidth(row.first));
+        widths[1] = std::max(widths[1], displayWidth(row.second));
+    }
+
+    std::string& out = buffer();
+    appendBorder(out, widths, 2);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        std::string_view cells[2] = {rows[i].first, rows[i].second};
+        appendRow(out, cells, widths, 2, i < styles.size() ? styles[i] : PLAIN);
+        appendBorder(out, widths, 2);
+    }
+
+    flush(out);
+}
+
+void TableRenderer::renderStudentDetails(const Student& student) {
+    static const std::vector<std::string> subjects = GradeUtil::getSubjectNames();
+    const std::string timestamp = student.getFormattedTimestamp();
+    const auto& scores = student.getSubjectScores();
+    const char* gradeColor = colorCode(MenuUtils::getGradeColor(student.getLetterGrade()));
+    const RowStyle remarkStyle{student.getRemark() == "Pass" ? GREEN_CODE : RED_CODE, true};
+
+    // Rows are produced twice, to measure and then to format (same
+    // highlighting as the tabulate version); numbers live in a stack buffer
+    auto visitRows = [&](auto&& row) {
+        char buf[48];
+        row("Field", "Value", RowStyle{CYAN_CODE, true});
+        row("Student ID", student.getStudentId(), PLAIN);
+        row("Name", student.getName(), PLAIN);
+        row("Age", formatInt(buf, sizeof(buf), student.getAge()), PLAIN);
+        row("Gender", student.getGender(), PLAIN);
+        row("Date of Birth", student.getDateOfBirth(), PLAIN);
+        row("Email", student.getEmail(), PLAIN);
+        for (size_t i = 0; i < subjects.size() && i < scores.size(); ++i) {
+            row(subjects[i], formatFixed(buf, sizeof(buf), scores[i]), PLAIN);
+        }
+        row("Average Score", formatFixed(buf, sizeof(buf), student.getAverageScore()), RowStyle{gradeColor, false});
+        row("Letter Grade", student.getLetterGrade(), RowStyle{gradeColor, true});
+        row("GPA", formatFixed(buf, sizeof(buf), student.getGpa()), PLAIN);
+        row("Remark", student.getRemark(), remarkStyle);
+        row("Last Updated", timestamp, PLAIN);
+    };
+
+    size_t widths[2] = {0, 0};
+    visitRows([&](std::string_view label, std::string_view value, RowStyle) {
+        widths[0] = std::max(widths[0], displayWidth(label));
+        widths[1] = std::max(widths[1], displayWidth(value));
+    });
+
+    std::string& out = buffer();
+    appendBorder(out, widths, 2);
+    visitRows([&](std::string_view label, std::string_view value, RowStyle style) {
+        std::string_view cells[2] = {label, value};
+        appendRow(out, cells, widths, 2, style);
+        appendBorder(out, widths, 2);
+    });
+
+    flush(out);
+}
+
+const char* TableRenderer::colorCode(tabulate::Color color) {
+    switch (color) {
+        case tabulate::Color::grey: return "\033[30m";
+        case tabulate::Color::red: return "\033[31m";
+        case tabulate::Color::green: return "\033[32m";
+        case tabulate::Color::yellow: return "\033[33m";
+        case tabulate::Color::blue: return "\033[34m";
+        case tabulate::Color::magenta: return "\033[35m";
+        case tabulate::Color::cyan: return "\033[36m";
+        case tabulate::Color::white: return "\033[37m";
+        default: return nullptr;
+    }
+}
+
+// Helper methods
+std::string& TableRenderer::buffer() {
+    // Reused between tables so steady-state rendering does not allocate
+    static std::string out;
+    out.clear();
+    return out;
+}
+
+void TableRenderer::flush(std::string& out) {
+    // Anything already queued on cout/stdio has to land first
+    std::cout.flush();
+    std::fflush(stdout);
+
+#ifdef _WIN32
+    std::fwrite(out.data(), 1, out.size(), stdout);
+    std::fflush(stdout);
+#else
+    const char* data = out.data();
+    size_t remaining = out.size();
+    while (remaining > 0) {
+        ssize_t written = ::write(STDOUT_FILENO, data, remaining);
+        if (written <= 0) {
+            break;
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+#endif
+}
+
+size_t TableRenderer::displayWidth(std::string_view text) {
+    // Count UTF-8 code points rather than bytes
+    size_t width = 0;
+    for (char c : text) {
+        if ((static_cast<unsigned char>(c) & 0xC0) != 0x80) {
+            width++;
+        }
+    }
+    return width;
+}
+
+void TableRenderer::appendBorder(std::string& out, const size_t* widths, size_t columns) {
+    out += '+';
+    for (size_t c = 0; c < columns; ++c) {
+        out.append(widths[c] + 2, '-');
+        out += '+';
+    }
+    out += '\n';
+}
+
+void TableRenderer::appendRow(std::string& out, const std::string_view* cells, const size_t* widths,
+                              size_t columns, RowStyle style) {
+    out += '|';
+    for (size_t c = 0; c < columns; ++c) {
+        if (style.bold) out += BOLD_CODE;
+        if (style.color) out += style.color;
+
+        out += ' ';
+        out.append(cells[c].data(), cells[c].size());
+        out.append(widths[c] - displayWidth(cells[c]) + 1, ' ');
+
+        if (style.bold || style.color) out += RESET_CODE;
+        out += '|';
+    }
+    out += '\n';
+}
@@ -0,0 +1,143 @@
+#include "Trace.hpp"
+#include "JsonUtil.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+std::atomic<bool> Trace::enabled{false};
+
+namespace {
+    struct Event {
+        string name;
+        Trace::TimePoint begin;
+        Trace::TimePoint end;
+    };
+
+    // Each thread appends to its own buffer; the registry keeps buffers alive after the thread exits
+    struct ThreadBuffer {
+        mutex lock;
+        uint32_t threadId = 0;
+        string threadName;
+        vector<Event> events;
+    };
+
+    struct Registry {
+        mutex lock;
+        vector<shared_ptr<ThreadBuffer>> buffers;
+        Trace::TimePoint origin = chrono::steady_clock::now();
+        string environmentFile;
+    };
+
+    Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    ThreadBuffer& threadBuffer() {
+        thread_local shared_ptr<ThreadBuffer> buffer = [] {
+            auto created = make_shared<ThreadBuffer>();
+            Registry& r = registry();
+            lock_guard<mutex> guard(r.lock);
+            created->threadId = static_cast<uint32_t>(r.buffers.size() + 1);
+            created->threadName = created->threadId == 1 ? "main" : "worker " + to_string(created->threadId - 1);
+            r.buffers.push_back(created);
+            return created;
+        }();
+        return *buffer;
+    }
+
+    double microsecondsSince(Trace::TimePoint origin, Trace::TimePoint point) {
+        return chrono::duration<double, micro>(point - origin).count();
+    }
+}
+
+void Trace::start() {
+    Registry& r = registry();
+    {
+        lock_guard<mutex> guard(r.lock);
+        for (auto& buffer : r.buffers) {
+            lock_guard<mutex> bufferGuard(buffer->lock);
+            buffer->events.clear();
+        }
+        r.origin = chrono::steady_clock::now();
+    }
+    threadBuffer();   // the starting thread gets id 1
+    enabled = true;
+}
+
+void Trace::stop() {
+    enabled = false;
+}
+
+void Trace::record(const std::string& name, TimePoint begin, TimePoint end) {
+    ThreadBuffer& buffer = threadBuffer();
+    lock_guard<mutex> guard(buffer.lock);
+    buffer.events.push_back({name, begin, end});
+}
+
+void Trace::setThreadName(const std::string& name) {
+    ThreadBuffer& buffer = threadBuffer();
+    lock_guard<mutex> guard(buffer.lock);
+    buffer.threadName = name;
+}
+
+bool Trace::writeFile(const std::string& filename) {
+    ofstream file(filename, ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    Registry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+
+    string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out += "{\"ph\":\"M\",\"pid\":1,\"tid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"ScoreME\"}}";
+
+    char number[64];
+    for (auto& buffer : r.buffers) {
+        lock_guard<mutex> bufferGuard(buffer->lock);
+        string tid = to_string(buffer->threadId);
+        out += ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":" + tid +
+               ",\"name\":\"thread_name\",\"args\":{\"name\":" + JsonUtil::quote(buffer->threadName) + "}}";
+
+        for (const auto& event : buffer->events) {
+            string category = event.name.substr(0, event.name.find('_'));
+            out += ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" + tid +
+                   ",\"name\":" + JsonUtil::quote(event.name) +
+                   ",\"cat\":" + JsonUtil::quote(category);
+            snprintf(number, sizeof(number), ",\"ts\":%.3f", microsecondsSince(r.origin, event.begin));
+            out += number;
+            snprintf(number, sizeof(number), ",\"dur\":%.3f}", microsecondsSince(event.begin, event.end));
+            out += number;
+        }
+    }
+    out += "\n]}\n";
+
+    file << out;
+    return static_cast<bool>(file);
+}
+
+void Trace::startFromEnvironment() {
+    const char* filename = getenv("SCOREME_TRACE");
+    if (filename && *filename) {
+        registry().environmentFile = filename;
+        start();
+    }
+}
+
+void Trace::finishFromEnvironment() {
+    const string& filename = registry().environmentFile;
+    if (filename.empty()) {
+        return;
+    }
+    stop();
+    if (!writeFile(filename)) {
+        cerr << "Could not write trace to " << filename << endl;
+    }
+}
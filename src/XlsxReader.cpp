@@ -0,0 +1,592 @@
+#include "XlsxReader.hpp"
+#include "ZipArchive.hpp"
+#include "GradeUtil.hpp"
+#include "ExcelUtil.hpp"
+#include "Metrics.hpp"
+#include "MemoryStats.hpp"
+#include <charconv>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+    const size_t READ_CHUNK = 1 << 16;
+    const size_t STUDENT_COLUMNS = 6;   // ID, name, age, gender, date of birth, email
+    const size_t DERIVED_COLUMNS = 5;   // average, grade, GPA, remark (recomputed), last updated
+
+    // Layout the fast path does not handle; caught by readRoster
+    struct Unsupported : runtime_error {
+        using runtime_error::runtime_error;
+    };
+
+    // Forward-only XML tokenizer over a chunked byte source. Element and
+    // attribute names are reported without their namespace prefix.
+    class XmlPullParser {
+    public:
+        enum Event { START, END, TEXT, END_OF_DOCUMENT };
+
+        explicit XmlPullParser(function<size_t(char*, size_t)> source) : source(std::move(source)) {
+            buffer.resize(READ_CHUNK * 2);
+        }
+
+        Event next() {
+            if (pendingEnd) {
+                pendingEnd = false;
+                return END;
+            }
+            if (available() == 0 && !fill()) {
+                return END_OF_DOCUMENT;
+            }
+
+            if (buffer[pos] != '<') {
+                size_t lt = find('<');
+                size_t length = lt == NOT_FOUND ? available() : lt;
+                decode(&buffer[pos], &buffer[pos] + length, textValue);
+                pos += length;
+                return TEXT;
+            }
+
+            if (available() < 2 && !fill()) {
+                throw runtime_error("unterminated tag");
+            }
+            if (buffer[pos + 1] == '?') {
+                skipPast("?>");
+                return next();
+            }
+            if (buffer[pos + 1] == '!') {
+                if (startsWith("<!--")) {
+                    skipPast("-->");
+                    return next();
+                }
+                if (startsWith("<![CDATA[")) {
+                    pos += 9;
+                    size_t end = findSequence("]]>");
+                    if (end == NOT_FOUND) throw runtime_error("unterminated CDATA section");
+                    textValue.assign(&buffer[pos], end);
+                    pos += end + 3;
+                    return TEXT;
+                }
+                skipPast(">");
+                return next();
+            }
+
+            size_t close = findTagEnd();
+            if (close == NOT_FOUND) throw runtime_error("unterminated tag");
+            const char* begin = &buffer[pos + 1];
+            const char* end = &buffer[pos + close];
+            pos += close + 1;
+
+            if (*begin == '/') {
+                readName(begin + 1, end, nameValue);
+                return END;
+            }
+            if (end > begin && end[-1] == '/') {
+                --end;
+                pendingEnd = true;
+            }
+            const char* cursor = readName(begin, end, nameValue);
+            readAttributes(cursor, end);
+            return START;
+        }
+
+        const string& name() const { return nameValue; }
+        const string& text() const { return textValue; }
+
+        const string* attribute(const char* local) const {
+            for (size_t i = 0; i < attributeCount; ++i) {
+                if (attributes[i].first == local) {
+                    return &attributes[i].second;
+                }
+            }
+            return nullptr;
+        }
+
+        // Concatenated text up to the end of the current element
+        void readElementText(string& out) {
+            out.clear();
+            for (int depth = 1; depth > 0;) {
+                switch (next()) {
+                    case START: ++depth; break;
+                    case END: --depth; break;
+                    case TEXT: out += textValue; break;
+                    case END_OF_DOCUMENT: throw runtime_error("unexpected end of document");
+                }
+            }
+        }
+
+        void skipElement() {
+            for (int depth = 1; depth > 0;) {
+                Event event = next();
+                if (event == START) ++depth;
+                else if (event == END) --depth;
+                else if (event == END_OF_DOCUMENT) throw runtime_error("unexpected end of document");
+            }
+        }
+
+    private:
+        static const size_t NOT_FOUND = static_cast<size_t>(-1);
+
+        function<size_t(char*, size_t)> source;
+        vector<char> buffer;
+        size_t pos = 0;
+        size_t end = 0;
+        bool exhausted = false;
+        bool pendingEnd = false;
+        string nameValue;
+        string textValue;
+        vector<pair<string, string>> attributes;   // Reused; only the first attributeCount are live
+        size_t attributeCount = 0;
+
+        size_t available() const { return end - pos; }
+
+        // Moves the unread bytes to the front and appends the next chunk
+        bool fill() {
+            if (exhausted) {
+                return false;
+            }
+            if (pos > 0) {
+                memmove(buffer.data(), buffer.data() + pos, end - pos);
+                end -= pos;
+                pos = 0;
+            }
+            if (buffer.size() - end < READ_CHUNK) {
+                buffer.resize(buffer.size() * 2);
+            }
+            size_t got = source(buffer.data() + end, buffer.size() - end);
+            if (got == 0) {
+                exhausted = true;
+                return false;
+            }
+            end += got;
+            return true;
+        }
+
+        bool startsWith(const char* prefix) {
+            size_t length = strlen(prefix);
+            while (available() < length) {
+                if (!fill()) return false;
+            }
+            return memcmp(&buffer[pos], prefix, length) == 0;
+        }
+
+        // Offset from pos of the next `c`, reading more input as needed
+        size_t find(char c) {
+            size_t scanned = 0;
+            for (;;) {
+                const void* hit = memchr(&buffer[pos] + scanned, c, available() - scanned);
+                if (hit) {
+                    return static_cast<size_t>(static_cast<const char*>(hit) - &buffer[pos]);
+                }
+                scanned = available();
+                if (!fill()) return NOT_FOUND;
+            }
+        }
+
+        size_t findSequence(const char* sequence) {
+            size_t length = strlen(sequence);
+            size_t scanned = 0;
+            for (;;) {
+                for (; scanned + length <= available(); ++scanned) {
+                    if (memcmp(&buffer[pos + scanned], sequence, length) == 0) {
+                        return scanned;
+                    }
+                }
+                if (!fill()) return NOT_FOUND;
+            }
+        }
+
+        void skipPast(const char* sequence) {
+            size_t at = findSequence(sequence);
+            if (at == NOT_FOUND) throw runtime_error("unterminated markup");
+            pos += at + strlen(sequence);
+        }
+
+        // Offset of the '>' closing the tag at pos; '>' may appear inside quoted values
+        size_t findTagEnd() {
+            size_t scanned = 1;
+            for (;;) {
+                // Jump quote to quote: a '>' before the next opening quote ends the tag
+                const char* base = &buffer[pos];
+                const char* limit = base + available();
+                const char* cursor = base + scanned;
+                while (cursor < limit) {
+                    const char* c = cursor;
+                    while (c < limit && *c != '>' && *c != '"' && *c != '\'') ++c;
+                    if (c == limit) break;
+                    if (*c == '>') return static_cast<size_t>(c - base);
+                    const char* close = static_cast<const char*>(memchr(c + 1, *c, static_cast<size_t>(limit - c - 1)));
+                    if (!close) break;
+                    cursor = close + 1;
+                    scanned = static_cast<size_t>(cursor - base);
+                }
+                if (!fill()) return NOT_FOUND;
+            }
+        }
+
+        static bool isSpace(char c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        static const char* readName(const char* cursor, const char* end, string& out) {
+            const char* local = cursor;
+            while (cursor < end && !isSpace(*cursor) && *cursor != '=' && *cursor != '/') {
+                if (*cursor == ':') local = cursor + 1;
+                ++cursor;
+            }
+            out.assign(local, cursor);
+            return cursor;
+        }
+
+        void readAttributes(const char* cursor, const char* end) {
+            attributeCount = 0;
+            for (;;) {
+                while (cursor < end && isSpace(*cursor)) ++cursor;
+                if (cursor >= end) return;
+                if (attributeCount == attributes.size()) {
+                    attributes.emplace_back();
+                }
+                auto& attribute = attributes[attributeCount++];
+                cursor = readName(cursor, end, attribute.first);
+                while (cursor < end && isSpace(*cursor)) ++cursor;
+                if (cursor >= end || *cursor != '=') throw runtime_error("malformed attribute");
+                ++cursor;
+                while (cursor < end && isSpace(*cursor)) ++cursor;
+                if (cursor >= end || (*cursor != '"' && *cursor != '\'')) throw runtime_error("malformed attribute");
+                char quote = *cursor++;
+                const char* valueEnd = static_cast<const char*>(memchr(cursor, quote, static_cast<size_t>(end - cursor)));
+                if (!valueEnd) throw runtime_error("malformed attribute");
+                decode(cursor, valueEnd, attribute.second);
+                cursor = valueEnd + 1;
+            }
+        }
+
+        static void appendUtf8(string& out, unsigned long code) {
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xC0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                out += static_cast<char>(0xE0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+
+        // Copies [begin, end) into out with entity and character references resolved
+        static void decode(const char* begin, const char* end, string& out) {
+            out.clear();
+            for (;;) {
+                const char* amp = static_cast<const char*>(memchr(begin, '&', static_cast<size_t>(end - begin)));
+                if (!amp) {
+                    out.append(begin, end);
+                    return;
+                }
+                out.append(begin, amp);
+                const char* semicolon = static_cast<const char*>(memchr(amp, ';', static_cast<size_t>(end - amp)));
+                if (!semicolon) throw runtime_error("malformed entity");
+                string_view entity(amp + 1, static_cast<size_t>(semicolon - amp - 1));
+                if (entity == "amp") out += '&';
+                else if (entity == "lt") out += '<';
+                else if (entity == "gt") out += '>';
+                else if (entity == "quot") out += '"';
+                else if (entity == "apos") out += '\'';
+                else if (entity.size() > 1 && entity[0] == '#') {
+                    bool hex = entity[1] == 'x' || entity[1] == 'X';
+                    unsigned long code = 0;
+                    const char* digits = entity.data() + (hex ? 2 : 1);
+                    auto result = from_chars(digits, entity.data() + entity.size(), code, hex ? 16 : 10);
+                    if (result.ec != errc()) throw runtime_error("malformed character reference");
+                    appendUtf8(out, code);
+                }
+                else throw runtime_error("unknown entity &" + string(entity) + ";");
+                begin = semicolon + 1;
+            }
+        }
+    };
+
+    unique_ptr<XmlPullParser> parserFor(ZipReader::EntryReader& entry) {
+        return make_unique<XmlPullParser>([&entry](char* out, size_t size) { return entry.read(out, size); });
+    }
+
+    // "xl/" + "worksheets/sheet1.xml", or an absolute "/xl/..." target
+    string resolvePart(const string& target) {
+        if (!target.empty() && target[0] == '/') {
+            return target.substr(1);
+        }
+        string path = "xl/" + target;
+        for (size_t dots; (dots = path.find("/../")) != string::npos;) {
+            size_t parent = path.rfind('/', dots - 1);
+            path.erase(parent == string::npos ? 0 : parent + 1, dots + 4 - (parent == string::npos ? 0 : parent + 1));
+        }
+        return path;
+    }
+
+    // Worksheet and shared strings parts of the workbook's active sheet
+    void locateParts(const ZipReader& zip, string& sheetPart, string& sharedStringsPart) {
+        size_t activeTab = 0;
+        vector<string> sheetIds;
+        {
+            auto entry = zip.open("xl/workbook.xml");
+            auto parser = parserFor(*entry);
+            for (XmlPullParser::Event event; (event = parser->next()) != XmlPullParser::END_OF_DOCUMENT;) {
+                if (event != XmlPullParser::START) continue;
+                if (parser->name() == "workbookView") {
+                    if (const string* tab = parser->attribute("activeTab")) {
+                        activeTab = stoul(*tab);
+                    }
+                } else if (parser->name() == "sheet") {
+                    const string* id = parser->attribute("id");
+                    const string* state = parser->attribute("state");
+                    if (state && *state != "visible") throw Unsupported("hidden sheets");
+                    sheetIds.push_back(id ? *id : "");
+                }
+            }
+        }
+        if (activeTab >= sheetIds.size()) throw Unsupported("no active sheet");
+
+        auto entry = zip.open("xl/_rels/workbook.xml.rels");
+        auto parser = parserFor(*entry);
+        for (XmlPullParser::Event event; (event = parser->next()) != XmlPullParser::END_OF_DOCUMENT;) {
+            if (event != XmlPullParser::START || parser->name() != "Relationship") continue;
+            const string* id = parser->attribute("Id");
+            const string* type = parser->attribute("Type");
+            const string* target = parser->attribute("Target");
+            if (!id || !type || !target) continue;
+            if (*id == sheetIds[activeTab]) {
+                sheetPart = resolvePart(*target);
+            } else if (type->size() >= 14 && type->compare(type->size() - 14, 14, "/sharedStrings") == 0) {
+                sharedStringsPart = resolvePart(*target);
+            }
+        }
+        if (sheetPart.empty()) throw Unsupported("active sheet not found");
+    }
+
+    // <si> items; rich text runs are concatenated, phonetic runs skipped
+    vector<string> readSharedStrings(const ZipReader& zip, const string& part) {
+        vector<string> strings;
+        if (part.empty() || !zip.contains(part)) {
+            return strings;
+        }
+        auto entry = zip.open(part);
+        auto parser = parserFor(*entry);
+        string run;
+        for (XmlPullParser::Event event; (event = parser->next()) != XmlPullParser::END_OF_DOCUMENT;) {
+            if (event != XmlPullParser::START) continue;
+            if (parser->name() == "sst") {
+                if (const string* unique = parser->attribute("uniqueCount")) {
+                    strings.reserve(stoul(*unique));
+                }
+            } else if (parser->name() == "si") {
+                strings.emplace_back();
+            } else if (parser->name() == "t" && !strings.empty()) {
+                parser->readElementText(run);
+                strings.back() += run;
+            } else if (parser->name() == "rPh") {
+                parser->skipElement();
+            }
+        }
+        return strings;
+    }
+
+    // "BC12" -> column 54 (zero-based); digits are ignored
+    size_t columnIndex(const string& reference) {
+        size_t column = 0;
+        for (char c : reference) {
+            if (c < 'A' || c > 'Z') break;
+            column = column * 26 + static_cast<size_t>(c - 'A' + 1);
+        }
+        if (column == 0) throw Unsupported("bad cell reference " + reference);
+        return column - 1;
+    }
+
+    double parseNumber(const string& text) {
+        double value = 0.0;
+        auto result = from_chars(text.data(), text.data() + text.size(), value);
+        if (result.ec != errc() || result.ptr != text.data() + text.size()) {
+            throw Unsupported("bad number '" + text + "'");
+        }
+        return value;
+    }
+
+    struct Cell {
+        enum Kind { EMPTY, TEXT, NUMBER } kind = EMPTY;
+        string value;
+    };
+
+    // Cells of the <row> the parser has just entered, up to row.size()
+    // columns (later ones are read and dropped); false for a row with no cells
+    bool readRowCells(XmlPullParser& parser, const vector<string>& sharedStrings, vector<Cell>& row) {
+        for (auto& cell : row) {
+            cell.kind = Cell::EMPTY;
+        }
+        string type, text;
+        size_t nextColumn = 0;
+        bool anyCell = false;
+        for (;;) {
+            XmlPullParser::Event event = parser.next();
+            if (event == XmlPullParser::END) break;
+            if (event == XmlPullParser::END_OF_DOCUMENT) throw runtime_error("unexpected end of sheet");
+            if (event != XmlPullParser::START) continue;
+            if (parser.name() != "c") {
+                parser.skipElement();
+                continue;
+            }
+            anyCell = true;
+            const string* reference = parser.attribute("r");
+            size_t column = reference ? columnIndex(*reference) : nextColumn;
+            nextColumn = column + 1;
+            const string* typeAttribute = parser.attribute("t");
+            type = typeAttribute ? *typeAttribute : "n";
+
+            // <v> or <is> child; formulas and anything else are not ours to interpret
+            Cell scratch;
+            Cell& cell = column < row.size() ? row[column] : scratch;
+            for (;;) {
+                event = parser.next();
+                if (event == XmlPullParser::END) break;
+                if (event == XmlPullParser::END_OF_DOCUMENT) throw runtime_error("unexpected end of sheet");
+                if (event != XmlPullParser::START) continue;
+                if (parser.name() == "v") {
+                    parser.readElementText(text);
+                    if (type == "s") {
+                        size_t index = 0;
+                        auto result = from_chars(text.data(), text.data() + text.size(), index);
+                        if (result.ec != errc() || index >= sharedStrings.size()) throw Unsupported("bad shared string index");
+                        cell.kind = Cell::TEXT;
+                        cell.value = sharedStrings[index];
+                    } else if (type == "n") {
+                        cell.kind = Cell::NUMBER;
+                        cell.value = text;
+                    } else {
+                        throw Unsupported("cell type '" + type + "'");
+                    }
+                } else if (parser.name() == "is" && type == "inlineStr") {
+                    parser.readElementText(text);
+                    cell.kind = Cell::TEXT;
+                    cell.value = text;
+                } else {
+                    throw Unsupported("<" + parser.name() + "> in a cell");
+                }
+            }
+        }
+        return anyCell;
+    }
+}
+
+bool XlsxReader::readRoster(const std::string& filename, std::vector<Student>& students, std::string& reason) {
+    try {
+        ZipReader zip(filename);
+        string sheetPart, sharedStringsPart;
+        vector<string> sharedStrings;
+        {
+            SCOREME_TIME_SCOPE("excel_read_shared_strings");
+            MemoryStats::Scope workbookMemory(MemoryStats::WORKBOOK);
+            locateParts(zip, sheetPart, sharedStringsPart);
+            sharedStrings = readSharedStrings(zip, sharedStringsPart);
+        }
+
+        SCOREME_TIME_SCOPE("excel_read_rows");
+        MemoryStats::Scope rowMemory(MemoryStats::currentTag() == MemoryStats::OTHER ?
+                                     MemoryStats::ROSTER : MemoryStats::currentTag());
+        const size_t subjects = GradeUtil::getSubjectNames().size();
+        const size_t columns = STUDENT_COLUMNS + subjects;
+        const size_t lastUpdatedColumn = columns + DERIVED_COLUMNS - 1;
+        vector<Cell> row(columns + DERIVED_COLUMNS);
+        vector<double> scores(subjects);
+        size_t expectedRow = 1;
+
+        // Rows written together share a timestamp; convert each serial once
+        string lastSerial;
+        time_t lastUpdated = 0;
+
+        auto entry = zip.open(sheetPart);
+        auto parser = parserFor(*entry);
+        for (XmlPullParser::Event event; (event = parser->next()) != XmlPullParser::END_OF_DOCUMENT;) {
+            if (event != XmlPullParser::START) continue;
+            if (parser->name() == "mergeCells") throw Unsupported("merged cells");
+            if (parser->name() != "row") continue;
+
+            const string* rowNumber = parser->attribute("r");
+            if (rowNumber && stoul(*rowNumber) != expectedRow) throw Unsupported("gap before row " + *rowNumber);
+            if (!readRowCells(*parser, sharedStrings, row)) throw Unsupported("empty row");
+
+            // Row 1 is the header, as in readExcelToVector
+            if (expectedRow++ == 1) {
+                continue;
+            }
+
+            // Text columns must hold text (or nothing), number columns numbers
+            for (size_t column = 0; column < columns; ++column) {
+                bool numeric = column == 2 || column >= STUDENT_COLUMNS;
+                Cell::Kind kind = row[column].kind;
+                if (numeric ? kind != Cell::NUMBER : kind == Cell::NUMBER) {
+                    throw Unsupported("unexpected value type in row " + to_string(expectedRow - 1));
+                }
+                if (kind == Cell::EMPTY) {
+                    row[column].value.clear();
+                }
+            }
+            for (size_t i = 0; i < subjects; ++i) {
+                scores[i] = parseNumber(row[STUDENT_COLUMNS + i].value);
+            }
+            students.emplace_back(row[0].value, row[1].value, static_cast<int>(parseNumber(row[2].value)),
+                                  row[3].value, row[4].value, row[5].value, scores);
+
+            // A date-time "Last Updated" survives the reload; anything else keeps the load time
+            const Cell& timestamp = row[lastUpdatedColumn];
+            if (timestamp.kind == Cell::NUMBER) {
+                if (timestamp.value != lastSerial) {
+                    lastSerial = timestamp.value;
+                    lastUpdated = ExcelUtils::fromExcelDateTime(parseNumber(lastSerial));
+                }
+                students.back().setLastUpdated(lastUpdated);
+            }
+        }
+        return true;
+    }
+    catch (const exception& e) {
+        // Unsupported layout, or damage that xlnt may report better
+        reason = e.what();
+    }
+    students.clear();
+    return false;
+}
+
+bool XlsxReader::readHeaders(const std::string& filename, std::vector<std::string>& headers, std::string& reason) {
+    try {
+        ZipReader zip(filename);
+        string sheetPart, sharedStringsPart;
+        locateParts(zip, sheetPart, sharedStringsPart);
+        vector<string> sharedStrings = readSharedStrings(zip, sharedStringsPart);
+
+        // Only the start of the sheet is inflated: parsing stops after row 1
+        vector<Cell> row(ExcelUtils::getExcelHeaders().size());
+        auto entry = zip.open(sheetPart);
+        auto parser = parserFor(*entry);
+        for (XmlPullParser::Event event; (event = parser->next()) != XmlPullParser::END_OF_DOCUMENT;) {
+            if (event != XmlPullParser::START || parser->name() != "row") continue;
+            const string* rowNumber = parser->attribute("r");
+            if (rowNumber && *rowNumber != "1") throw Unsupported("no header row");
+            readRowCells(*parser, sharedStrings, row);
+            headers.clear();
+            for (const auto& cell : row) {
+                headers.push_back(cell.kind == Cell::TEXT ? cell.value : "");
+            }
+            return true;
+        }
+        throw Unsupported("no header row");
+    }
+    catch (const exception& e) {
+        reason = e.what();
+    }
+    headers.clear();
+    return false;
+}
@@ -0,0 +1,388 @@
+#include "XlsxWriter.hpp"
+#include "ZipArchive.hpp"
+#include "ExcelUtil.hpp"
+#include "GradeUtil.hpp"
+#include "Metrics.hpp"
+#include <charconv>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace std;
+
+const char* const XlsxWriter::SHEET_NAME = "Student Grades";
+const char* const XlsxWriter::REPORT_SHEET_NAME = "Grade Report";
+
+namespace {
+    const size_t FLUSH_SIZE = 1 << 20;
+
+    const char* const CONTENT_TYPES =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+        "<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">"
+        "<Default Extension=\"rels\" ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>"
+        "<Default Extension=\"xml\" ContentType=\"application/xml\"/>"
+        "<Override PartName=\"/xl/workbook.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml\"/>"
+        "<Override PartName=\"/xl/worksheets/sheet1.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.worksheet+xml\"/>"
+        "<Override PartName=\"/xl/styles.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.styles+xml\"/>"
+        "<Override PartName=\"/xl/sharedStrings.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.sharedStrings+xml\"/>"
+        "</Types>";
+
+    const char* const PACKAGE_RELATIONSHIPS =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+        "<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+        "<Relationship Id=\"rId1\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/officeDocument\" Target=\"xl/workbook.xml\"/>"
+        "</Relationships>";
+
+    const char* const WORKBOOK_RELATIONSHIPS =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+        "<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+        "<Relationship Id=\"rId1\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/worksheet\" Target=\"worksheets/sheet1.xml\"/>"
+        "<Relationship Id=\"rId2\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/styles\" Target=\"styles.xml\"/>"
+        "<Relationship Id=\"rId3\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/sharedStrings\" Target=\"sharedStrings.xml\"/>"
+        "</Relationships>";
+
+    // Style 0 is the default, style 1 the bold header font, style 2 the
+    // "Last Updated" date-time format (the same text getFormattedTimestamp gives)
+    const char* const STYLES =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+        "<styleSheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\">"
+        "<numFmts count=\"1\"><numFmt numFmtId=\"164\" formatCode=\"yyyy-mm-dd hh:mm:ss\"/></numFmts>"
+        "<fonts count=\"2\">"
+        "<font><sz val=\"11\"/><name val=\"Calibri\"/><family val=\"2\"/></font>"
+        "<font><b/><sz val=\"11\"/><name val=\"Calibri\"/><family val=\"2\"/></font>"
+        "</fonts>"
+        "<fills count=\"2\"><fill><patternFill patternType=\"none\"/></fill><fill><patternFill patternType=\"gray125\"/></fill></fills>"
+        "<borders count=\"1\"><border><left/><right/><top/><bottom/><diagonal/></border></borders>"
+        "<cellStyleXfs count=\"1\"><xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" borderId=\"0\"/></cellStyleXfs>"
+        "<cellXfs count=\"3\">"
+        "<xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" borderId=\"0\" xfId=\"0\"/>"
+        "<xf numFmtId=\"0\" fontId=\"1\" fillId=\"0\" borderId=\"0\" xfId=\"0\" applyFont=\"1\"/>"
+        "<xf numFmtId=\"164\" fontId=\"0\" fillId=\"0\" borderId=\"0\" xfId=\"0\" applyNumberFormat=\"1\"/>"
+        "</cellXfs>"
+        "<cellStyles count=\"1\"><cellStyle name=\"Normal\" xfId=\"0\" builtinId=\"0\"/></cellStyles>"
+        "</styleSheet>";
+
+    const char* const SHEET_START =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+        "<worksheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\" "
+        "xmlns:r=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships\">";
+
+    string columnName(size_t index) {
+        string name;
+        for (size_t n = index + 1; n > 0; n = (n - 1) / 26) {
+            name.insert(name.begin(), static_cast<char>('A' + (n - 1) % 26));
+        }
+        return name;
+    }
+
+    // Appends text with the five XML entities escaped; control characters
+    // other than tab/newline are not allowed in XML 1.0 and are dropped
+    void appendEscaped(string& out, const string& text) {
+        size_t start = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            const char* entity = nullptr;
+            switch (c) {
+                case '&': entity = "&amp;"; break;
+                case '<': entity = "&lt;"; break;
+                case '>': entity = "&gt;"; break;
+                case '"': entity = "&quot;"; break;
+                case '\'': entity = "&apos;"; break;
+                default:
+                    if (c >= 0x20 || c == '\t' || c == '\n' || c == '\r') continue;
+                    entity = "";
+            }
+            out.append(text, start, i - start);
+            out += entity;
+            start = i + 1;
+        }
+        out.append(text, start, string::npos);
+    }
+
+    // Strings that repeat down a column (headers, Gender, Letter Grade,
+    // Remark) go into the shared strings table; each keeps its index as text
+    // so a cell is a lookup and a copy. Unique values stay inline.
+    class SharedStrings {
+    public:
+        // Reserves an index without counting a reference
+        void seed(const string& value) {
+            if (indices.count(value)) return;
+            auto added = indices.emplace(value, to_string(values.size())).first;
+            values.push_back(&added->first);
+        }
+
+        const string& index(const string& value) {
+            ++references;
+            auto found = indices.find(value);
+            if (found != indices.end()) return found->second;
+            auto added = indices.emplace(value, to_string(values.size())).first;
+            values.push_back(&added->first);
+            return added->second;
+        }
+
+        string xml() const {
+            string out = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+                         "<sst xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\" count=\"" +
+                         to_string(references) + "\" uniqueCount=\"" + to_string(values.size()) + "\">";
+            for (const string* value : values) {
+                out += "<si><t";
+                if (!value->empty() && (value->front() == ' ' || value->back() == ' ')) {
+                    out += " xml:space=\"preserve\"";
+                }
+                out += '>';
+                appendEscaped(out, *value);
+                out += "</t></si>";
+            }
+            out += "</sst>";
+            return out;
+        }
+
+    private:
+        unordered_map<string, string> indices;
+        vector<const string*> values;   // Keys of indices, in index order
+        size_t references = 0;
+    };
+
+    // Cell markup up to the row number, per column ("<c r=\"B"), built once
+    class CellTemplates {
+    public:
+        const string& open(size_t column) {
+            while (prefixes.size() <= column) {
+                prefixes.push_back("<c r=\"" + columnName(prefixes.size()));
+            }
+            return prefixes[column];
+        }
+
+    private:
+        vector<string> prefixes;
+    };
+
+    class SheetBuilder {
+    public:
+        SheetBuilder(ZipWriter& zip, SharedStrings& strings) : zip(zip), strings(strings) {
+            out.reserve(FLUSH_SIZE + 4096);
+        }
+
+        void beginRow(size_t row) {
+            auto result = to_chars(rowNumber, rowNumber + sizeof(rowNumber), row);
+            rowLength = static_cast<size_t>(result.ptr - rowNumber);
+            column = 0;
+            out += "<row r=\"";
+            out.append(rowNumber, rowLength);
+            out += "\">";
+        }
+
+        void endRow() {
+            out += "</row>";
+            if (out.size() >= FLUSH_SIZE) {
+                flush();
+            }
+        }
+
+        void text(const string& value) {
+            openCell();
+            out += "\" t=\"inlineStr\"><is><t";
+            // Leading/trailing blanks are dropped by readers unless preserved
+            if (!value.empty() && (value.front() == ' ' || value.back() == ' ')) {
+                out += " xml:space=\"preserve\"";
+            }
+            out += '>';
+            appendEscaped(out, value);
+            out += "</t></is></c>";
+        }
+
+        void sharedText(const string& value, bool bold = false) {
+            const string& index = strings.index(value);
+            openCell();
+            out += bold ? "\" s=\"1\" t=\"s\"><v>" : "\" t=\"s\"><v>";
+            out += index;
+            out += "</v></c>";
+        }
+
+        void number(double value) {
+            openCell();
+            out += "\"><v>";
+            // Shortest text that reads back as the same double
+            char buffer[32];
+            auto result = to_chars(buffer, buffer + sizeof(buffer), value);
+            out.append(buffer, result.ptr);
+            out += "</v></c>";
+        }
+
+        void dateTime(const string& serial) {
+            openCell();
+            out += "\" s=\"2\"><v>";
+            out += serial;
+            out += "</v></c>";
+        }
+
+        void number(int value) {
+            openCell();
+            out += "\"><v>";
+            char buffer[16];
+            auto result = to_chars(buffer, buffer + sizeof(buffer), value);
+            out.append(buffer, result.ptr);
+            out += "</v></c>";
+        }
+
+        void raw(const char* markup) {
+            out += markup;
+        }
+
+        void flush() {
+            zip.write(out);
+            out.clear();
+        }
+
+    private:
+        ZipWriter& zip;
+        SharedStrings& strings;
+        string out;
+        CellTemplates templates;
+        char rowNumber[24];
+        size_t rowLength = 0;
+        size_t column = 0;
+
+        void openCell() {
+            out += templates.open(column++);
+            out.append(rowNumber, rowLength);
+        }
+    };
+}
+
+void XlsxWriter::writeRoster(const std::string& filename, const std::vector<Student>& students, bool fastCompression) {
+    writeWorkbook(filename, SHEET_NAME, "", {}, students, fastCompression ? ZipWriter::FAST_LEVEL : ZipWriter::DEFAULT_LEVEL);
+}
+
+void XlsxWriter::writeReport(const std::string& filename, const std::string& title,
+                             const std::vector<std::string>& summary, const std::vector<Student>& students) {
+    writeWorkbook(filename, REPORT_SHEET_NAME, title, summary, students, ZipWriter::DEFAULT_LEVEL);
+}
+
+void XlsxWriter::writeWorkbook(const std::string& filename, const char* sheetName, const std::string& title,
+                               const std::vector<std::string>& summary, const std::vector<Student>& students,
+                               int level) {
+    // Built beside the target and renamed over it, so the old workbook stays
+    // intact until the new one is complete
+    string tempFilename = filename + ".tmp";
+    try {
+        ZipWriter zip(tempFilename, level);
+        {
+            SCOREME_TIME_SCOPE("excel_write_package");
+            zip.addFile("[Content_Types].xml", CONTENT_TYPES);
+            zip.addFile("_rels/.rels", PACKAGE_RELATIONSHIPS);
+            zip.addFile("xl/workbook.xml",
+                string("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+                       "<workbook xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\" "
+                       "xmlns:r=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships\">"
+                       "<sheets><sheet name=\"") + sheetName + "\" sheetId=\"1\" r:id=\"rId1\"/></sheets></workbook>");
+            zip.addFile("xl/_rels/workbook.xml.rels", WORKBOOK_RELATIONSHIPS);
+            zip.addFile("xl/styles.xml", STYLES);
+        }
+        writeSheet(zip, title, summary, students);
+        zip.close();
+
+        error_code ec;
+        filesystem::rename(tempFilename, filename, ec);
+        if (ec) {
+            throw runtime_error("Cannot replace " + filename + ": " + ec.message());
+        }
+    }
+    catch (...) {
+        remove(tempFilename.c_str());
+        throw;
+    }
+}
+
+void XlsxWriter::writeSheet(ZipWriter& zip, const std::string& title, const std::vector<std::string>& summary,
+                            const std::vector<Student>& students) {
+    SCOREME_TIME_SCOPE("excel_write_sheet");
+    zip.beginFile("xl/worksheets/sheet1.xml");
+    SharedStrings strings;
+    // The common body values get the single-digit indices
+    for (const char* grade : {"A", "B", "C", "D", "E", "F"}) {
+        strings.seed(grade);
+        strings.seed(GradeUtil::assignRemark(GradeUtil::getGradeLowerBound(grade)));
+    }
+    strings.seed("Male");
+    strings.seed("Female");
+    SheetBuilder sheet(zip, strings);
+    sheet.raw(SHEET_START);
+
+    auto headers = ExcelUtils::getExcelHeaders();
+    size_t fixedColumns = headers.size() - GradeUtil::getSubjectNames().size();
+    size_t columns = headers.size();
+    for (const auto& student : students) {
+        columns = max(columns, fixedColumns + student.getSubjectScores().size());
+    }
+    // A report puts its title on row 1 and the summary from row 3, one blank row before the table
+    size_t headerRow = title.empty() ? 1 : summary.size() + 4;
+    string dimension = "<dimension ref=\"A1:" + columnName(columns - 1) + to_string(headerRow + students.size()) + "\"/>";
+    sheet.raw(dimension.c_str());
+    // Wide enough for the date-time, which Excel would otherwise show as ####
+    string timestampColumn = to_string(headers.size());
+    string cols = "<cols><col min=\"" + timestampColumn + "\" max=\"" + timestampColumn + "\" width=\"20\" customWidth=\"1\"/></cols>";
+    sheet.raw(cols.c_str());
+    sheet.raw("<sheetData>");
+
+    if (!title.empty()) {
+        sheet.beginRow(1);
+        sheet.text(title);
+        sheet.endRow();
+        for (size_t i = 0; i < summary.size(); ++i) {
+            sheet.beginRow(i + 3);
+            sheet.text(summary[i]);
+            sheet.endRow();
+        }
+    }
+
+    // The roster's header row is bold; the report keeps its plain one
+    sheet.beginRow(headerRow);
+    for (const auto& header : headers) {
+        sheet.sharedText(header, title.empty());
+    }
+    sheet.endRow();
+
+    // Consecutive students usually share a timestamp; convert it once
+    time_t lastTimestamp = -1;
+    string timestampSerial;
+
+    size_t row = headerRow + 1;
+    for (const auto& student : students) {
+        sheet.beginRow(row++);
+        sheet.text(student.getStudentId());
+        sheet.text(student.getName());
+        sheet.number(student.getAge());
+        sheet.sharedText(student.getGender());
+        sheet.text(student.getDateOfBirth());
+        sheet.text(student.getEmail());
+        for (double score : student.getSubjectScores()) {
+            sheet.number(score);
+        }
+        sheet.number(student.getAverageScore());
+        sheet.sharedText(student.getLetterGrade());
+        sheet.number(student.getGpa());
+        sheet.sharedText(student.getRemark());
+        if (student.getLastUpdated() != lastTimestamp) {
+            lastTimestamp = student.getLastUpdated();
+            char buffer[32];
+            auto result = to_chars(buffer, buffer + sizeof(buffer), ExcelUtils::toExcelDateTime(lastTimestamp));
+            timestampSerial.assign(buffer, result.ptr);
+        }
+        sheet.dateTime(timestampSerial);
+        sheet.endRow();
+    }
+
+    sheet.raw("</sheetData>");
+    if (!title.empty()) {
+        sheet.raw("<mergeCells count=\"1\"><mergeCell ref=\"A1:H1\"/></mergeCells>");
+    }
+    sheet.raw("</worksheet>");
+    sheet.flush();
+    zip.endFile();
+
+    // Complete only once every row has been seen
+    zip.addFile("xl/sharedStrings.xml", strings.xml());
+}
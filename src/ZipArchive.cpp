@@ -0,0 +1,674 @@
+#include "ZipArchive.hpp"
+#include <zlib.h>
+#include <ctime>
+#include <limits>
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <cstring>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+const int ZipWriter::DEFAULT_LEVEL = 6;
+const int ZipWriter::FAST_LEVEL = 1;
+const size_t ZipWriter::BLOCK_SIZE = 1 << 20;
+
+namespace {
+    const uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+    const uint32_t CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+    const uint32_t END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06054b50;
+    const uint16_t VERSION_NEEDED = 20;      // 2.0: deflate
+    const uint16_t METHOD_DEFLATE = 8;
+    const size_t WINDOW_SIZE = 1 << 15;      // Deflate looks back at most 32 KiB
+
+    void put16(string& out, uint16_t value) {
+        out += static_cast<char>(value & 0xff);
+        out += static_cast<char>(value >> 8);
+    }
+
+    void put32(string& out, uint32_t value) {
+        put16(out, static_cast<uint16_t>(value & 0xffff));
+        put16(out, static_cast<uint16_t>(value >> 16));
+    }
+
+    // One piece of an entry. Blocks are deflated independently, primed with
+    // the 32 KiB before them, and all but the last end on a byte boundary
+    // (Z_SYNC_FLUSH), so their outputs concatenate into one deflate stream.
+    struct Block {
+        string input;                 // Dictionary, then this block's data
+        size_t dictionarySize = 0;
+        bool last = false;
+        string output;
+        uLong crc = 0;
+        bool done = false;
+        string error;
+    };
+
+    unsigned defaultWorkerCount() {
+        unsigned cores = thread::hardware_concurrency();
+        return cores == 0 ? 1 : cores;
+    }
+}
+
+// Raw deflate stream reused from block to block
+class ZipWriter::BlockDeflater {
+public:
+    explicit BlockDeflater(int level) {
+        if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw runtime_error("deflateInit2 failed");
+        }
+    }
+    ~BlockDeflater() { deflateEnd(&stream); }
+    BlockDeflater(const BlockDeflater&) = delete;
+    BlockDeflater& operator=(const BlockDeflater&) = delete;
+
+    void compress(Block& block) {
+        deflateReset(&stream);
+        const Bytef* input = reinterpret_cast<const Bytef*>(block.input.data());
+        if (block.dictionarySize > 0) {
+            deflateSetDictionary(&stream, input, static_cast<uInt>(block.dictionarySize));
+        }
+        size_t size = block.input.size() - block.dictionarySize;
+        block.crc = crc32(0L, input + block.dictionarySize, static_cast<uInt>(size));
+
+        // deflateBound does not count the sync flush marker
+        block.output.resize(deflateBound(&stream, static_cast<uLong>(size)) + 16);
+        stream.next_in = const_cast<Bytef*>(input + block.dictionarySize);
+        stream.avail_in = static_cast<uInt>(size);
+        stream.next_out = reinterpret_cast<Bytef*>(&block.output[0]);
+        stream.avail_out = static_cast<uInt>(block.output.size());
+        int status = deflate(&stream, block.last ? Z_FINISH : Z_SYNC_FLUSH);
+        bool complete = block.last ? status == Z_STREAM_END : status == Z_OK && stream.avail_in == 0;
+        if (!complete || stream.avail_out == 0) {
+            throw runtime_error("deflate failed");
+        }
+        block.output.resize(block.output.size() - stream.avail_out);
+    }
+
+private:
+    z_stream stream{};
+};
+
+// Worker threads deflating blocks in any order; the writer collects them in order
+class ZipWriter::Compressor {
+public:
+    Compressor(int level, unsigned workers) {
+        for (unsigned i = 0; i < workers; ++i) {
+            threads.emplace_back([this, level]() { run(level); });
+        }
+    }
+
+    ~Compressor() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        workReady.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    void submit(const shared_ptr<Block>& block) {
+        {
+            lock_guard<mutex> lock(mtx);
+            queue.push_back(block);
+        }
+        workReady.notify_one();
+    }
+
+    void wait(const Block& block) {
+        unique_lock<mutex> lock(mtx);
+        blockDone.wait(lock, [&block]() { return block.done; });
+    }
+
+private:
+    mutex mtx;
+    condition_variable workReady;
+    condition_variable blockDone;
+    deque<shared_ptr<Block>> queue;
+    vector<thread> threads;
+    bool stopping = false;
+
+    void run(int level) {
+        unique_ptr<BlockDeflater> deflater;
+        string setupError;
+        try {
+            deflater = make_unique<BlockDeflater>(level);
+        }
+        catch (const exception& e) {
+            setupError = e.what();
+        }
+
+        for (;;) {
+            shared_ptr<Block> block;
+            {
+                unique_lock<mutex> lock(mtx);
+                workReady.wait(lock, [this]() { return stopping || !queue.empty(); });
+                if (stopping) return;
+                block = queue.front();
+                queue.pop_front();
+            }
+            string error = setupError;
+            if (deflater) {
+                try {
+                    deflater->compress(*block);
+                }
+                catch (const exception& e) {
+                    error = e.what();
+                }
+            }
+            {
+                lock_guard<mutex> lock(mtx);
+                block->error = error;
+                block->done = true;
+            }
+            blockDone.notify_all();
+        }
+    }
+};
+
+struct ZipWriter::Deflater {
+    string pending;                         // Input not yet handed to a block
+    string window;                          // Last 32 KiB handed out: the next block's dictionary
+    deque<shared_ptr<Block>> inFlight;      // Submitted blocks, in stream order
+    uLong crc = crc32(0L, Z_NULL, 0);
+    uint64_t uncompressedSize = 0;
+    uint64_t compressedSize = 0;
+};
+
+ZipWriter::ZipWriter(const std::string& filename, int level, unsigned threads)
+    : file(filename, ios::binary | ios::trunc), filename(filename), level(level),
+      workers(threads == 0 ? defaultWorkerCount() : threads) {
+    if (!file) {
+        throw runtime_error("cannot create '" + filename + "'");
+    }
+
+    // Every entry gets the time the archive was started
+    time_t now = time(nullptr);
+    tm local = *localtime(&now);
+    dosTime = static_cast<uint16_t>((local.tm_hour << 11) | (local.tm_min << 5) | (local.tm_sec / 2));
+    dosDate = static_cast<uint16_t>(((local.tm_year - 80) << 9) | ((local.tm_mon + 1) << 5) | local.tm_mday);
+}
+
+// Stops the workers before the blocks they may still be deflating go away
+ZipWriter::~ZipWriter() {
+    compressor.reset();
+}
+
+uint32_t ZipWriter::position() {
+    streamoff offset = file.tellp();
+    if (offset < 0 || static_cast<uint64_t>(offset) > numeric_limits<uint32_t>::max()) {
+        throw runtime_error("'" + filename + "' is too large for a zip without zip64");
+    }
+    return static_cast<uint32_t>(offset);
+}
+
+void ZipWriter::addFile(const std::string& name, const std::string& data) {
+    beginFile(name);
+    write(data);
+    endFile();
+}
+
+void ZipWriter::beginFile(const std::string& name) {
+    if (deflater || closed) {
+        throw logic_error("ZipWriter::beginFile called out of order");
+    }
+
+    Entry entry;
+    entry.name = name;
+    entry.localHeaderOffset = position();
+    entries.push_back(entry);
+
+    // CRC and sizes are patched in by endFile
+    string header;
+    put32(header, LOCAL_HEADER_SIGNATURE);
+    put16(header, VERSION_NEEDED);
+    put16(header, 0);
+    put16(header, METHOD_DEFLATE);
+    put16(header, dosTime);
+    put16(header, dosDate);
+    put32(header, 0);
+    put32(header, 0);
+    put32(header, 0);
+    put16(header, static_cast<uint16_t>(name.size()));
+    put16(header, 0);
+    header += name;
+    file.write(header.data(), static_cast<streamsize>(header.size()));
+
+    deflater = make_unique<Deflater>();
+}
+
+void ZipWriter::write(const char* data, size_t size) {
+    if (!deflater) {
+        throw logic_error("ZipWriter::write called outside an entry");
+    }
+    deflater->uncompressedSize += size;
+    while (size > 0) {
+        size_t taken = min(size, BLOCK_SIZE - deflater->pending.size());
+        deflater->pending.append(data, taken);
+        data += taken;
+        size -= taken;
+        if (deflater->pending.size() == BLOCK_SIZE) {
+            submitBlock(false);
+        }
+    }
+}
+
+void ZipWriter::submitBlock(bool last) {
+    auto block = make_shared<Block>();
+    block->input.reserve(deflater->window.size() + deflater->pending.size());
+    block->input = deflater->window;
+    block->input += deflater->pending;
+    block->dictionarySize = deflater->window.size();
+    block->last = last;
+
+    size_t keep = min(block->input.size(), WINDOW_SIZE);
+    deflater->window.assign(block->input, block->input.size() - keep, keep);
+    deflater->pending.clear();
+
+    // A part that fits in one block, or a single core, is not worth a hand-off
+    if (workers < 2 || (last && deflater->inFlight.empty())) {
+        if (!serialDeflater) {
+            serialDeflater = make_unique<BlockDeflater>(level);
+        }
+        serialDeflater->compress(*block);
+        block->done = true;
+        deflater->inFlight.push_back(block);
+        writeBlock();
+        return;
+    }
+
+    if (!compressor) {
+        compressor = make_unique<Compressor>(level, workers);
+    }
+    // Bounded read-ahead: at most two blocks per worker are held in memory
+    while (deflater->inFlight.size() >= 2 * static_cast<size_t>(workers)) {
+        writeBlock();
+    }
+    deflater->inFlight.push_back(block);
+    compressor->submit(block);
+}
+
+void ZipWriter::writeBlock() {
+    shared_ptr<Block> block = deflater->inFlight.front();
+    deflater->inFlight.pop_front();
+    if (compressor) {
+        compressor->wait(*block);
+    }
+    if (!block->error.empty()) {
+        throw runtime_error(block->error);
+    }
+    file.write(block->output.data(), static_cast<streamsize>(block->output.size()));
+    deflater->compressedSize += block->output.size();
+    z_off_t size = static_cast<z_off_t>(block->input.size() - block->dictionarySize);
+    deflater->crc = crc32_combine(deflater->crc, block->crc, size);
+}
+
+void ZipWriter::endFile() {
+    if (!deflater) {
+        throw logic_error("ZipWriter::endFile called outside an entry");
+    }
+    submitBlock(true);
+    while (!deflater->inFlight.empty()) {
+        writeBlock();
+    }
+
+    Entry& entry = entries.back();
+    if (deflater->uncompressedSize > numeric_limits<uint32_t>::max() ||
+        deflater->compressedSize > numeric_limits<uint32_t>::max()) {
+        throw runtime_error("'" + entry.name + "' is too large for a zip without zip64");
+    }
+    entry.crc = static_cast<uint32_t>(deflater->crc);
+    entry.compressedSize = static_cast<uint32_t>(deflater->compressedSize);
+    entry.uncompressedSize = static_cast<uint32_t>(deflater->uncompressedSize);
+    deflater.reset();
+
+    // Patch CRC and sizes into the local header
+    uint32_t end = position();
+    string sizes;
+    put32(sizes, entry.crc);
+    put32(sizes, entry.compressedSize);
+    put32(sizes, entry.uncompressedSize);
+    file.seekp(entry.localHeaderOffset + 14);
+    file.write(sizes.data(), static_cast<streamsize>(sizes.size()));
+    file.seekp(end);
+}
+
+void ZipWriter::close() {
+    if (closed) {
+        return;
+    }
+    if (deflater) {
+        endFile();
+    }
+
+    uint32_t directoryOffset = position();
+    string directory;
+    for (const auto& entry : entries) {
+        put32(directory, CENTRAL_HEADER_SIGNATURE);
+        put16(directory, VERSION_NEEDED);
+        put16(directory, VERSION_NEEDED);
+        put16(directory, 0);
+        put16(directory, METHOD_DEFLATE);
+        put16(directory, dosTime);
+        put16(directory, dosDate);
+        put32(directory, entry.crc);
+        put32(directory, entry.compressedSize);
+        put32(directory, entry.uncompressedSize);
+        put16(directory, static_cast<uint16_t>(entry.name.size()));
+        put16(directory, 0);     // extra field
+        put16(directory, 0);     // comment
+        put16(directory, 0);     // disk number
+        put16(directory, 0);     // internal attributes
+        put32(directory, 0);     // external attributes
+        put32(directory, entry.localHeaderOffset);
+        directory += entry.name;
+    }
+
+    uint32_t directorySize = static_cast<uint32_t>(directory.size());
+    put32(directory, END_OF_CENTRAL_DIRECTORY_SIGNATURE);
+    put16(directory, 0);
+    put16(directory, 0);
+    put16(directory, static_cast<uint16_t>(entries.size()));
+    put16(directory, static_cast<uint16_t>(entries.size()));
+    put32(directory, directorySize);
+    put32(directory, directoryOffset);
+    put16(directory, 0);
+    file.write(directory.data(), static_cast<streamsize>(directory.size()));
+    file.close();
+    closed = true;
+
+    if (!file) {
+        throw runtime_error("error writing '" + filename + "'");
+    }
+}
+
+namespace {
+    const uint16_t METHOD_STORED = 0;
+    const size_t END_OF_CENTRAL_DIRECTORY_SIZE = 22;
+    const size_t LOCAL_HEADER_SIZE = 30;
+    const size_t CENTRAL_HEADER_SIZE = 46;
+    const size_t MAX_COMMENT_SIZE = 0xffff;
+
+    uint16_t get16(const char* p) {
+        const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+        return static_cast<uint16_t>(u[0] | (u[1] << 8));
+    }
+
+    uint32_t get32(const char* p) {
+        return get16(p) | (static_cast<uint32_t>(get16(p + 2)) << 16);
+    }
+
+    bool equalsIgnoreCase(const string& a, const string& b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (tolower(static_cast<unsigned char>(a[i])) != tolower(static_cast<unsigned char>(b[i]))) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+ZipReader::ZipReader(const std::string& filename) : filename(filename) {
+#ifdef _WIN32
+    // No mmap: the whole file is read into an owned buffer
+    ifstream file(filename, ios::binary | ios::ate);
+    if (!file) {
+        throw runtime_error("cannot open '" + filename + "'");
+    }
+    size = static_cast<size_t>(file.tellg());
+    buffer.resize(size);
+    file.seekg(0);
+    if (!file.read(&buffer[0], static_cast<streamsize>(size))) {
+        throw runtime_error("cannot read '" + filename + "'");
+    }
+    data = size > 0 ? buffer.data() : nullptr;
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("cannot open '" + filename + "'");
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw runtime_error("cannot open '" + filename + "'");
+    }
+    size = static_cast<size_t>(info.st_size);
+    if (size > 0) {
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fd);
+            throw runtime_error("cannot map '" + filename + "'");
+        }
+        data = static_cast<const char*>(mapping);
+        // Parts are inflated front to back
+        madvise(mapping, size, MADV_SEQUENTIAL);
+    }
+    ::close(fd);
+#endif
+
+    try {
+        readDirectory();
+    }
+    catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+ZipReader::~ZipReader() {
+    unmap();
+}
+
+void ZipReader::unmap() {
+    if (data) {
+#ifdef _WIN32
+        buffer.clear();
+        buffer.shrink_to_fit();
+#else
+        munmap(const_cast<char*>(data), size);
+#endif
+        data = nullptr;
+    }
+}
+
+// The central directory is parsed where it lies in the mapping
+void ZipReader::readDirectory() {
+    // The end-of-central-directory record sits in the last 22 bytes plus an optional comment
+    size_t tailSize = min(size, END_OF_CENTRAL_DIRECTORY_SIZE + MAX_COMMENT_SIZE);
+    const char* tail = data + (size - tailSize);
+    const char* record = nullptr;
+    for (size_t i = tailSize >= END_OF_CENTRAL_DIRECTORY_SIZE ? tailSize - END_OF_CENTRAL_DIRECTORY_SIZE + 1 : 0; i-- > 0;) {
+        if (get32(tail + i) == END_OF_CENTRAL_DIRECTORY_SIGNATURE) {
+            record = tail + i;
+            break;
+        }
+    }
+    if (!record) {
+        throw runtime_error("'" + filename + "' is not a zip file");
+    }
+
+    uint16_t count = get16(record + 10);
+    uint32_t directorySize = get32(record + 12);
+    uint32_t directoryOffset = get32(record + 16);
+    if (static_cast<uint64_t>(directoryOffset) + directorySize > size) {
+        throw runtime_error("'" + filename + "' has a damaged central directory");
+    }
+
+    const char* directory = data + directoryOffset;
+    size_t offset = 0;
+    entries.reserve(count);
+    for (uint16_t i = 0; i < count; ++i) {
+        if (offset + CENTRAL_HEADER_SIZE > directorySize || get32(directory + offset) != CENTRAL_HEADER_SIGNATURE) {
+            throw runtime_error("'" + filename + "' has a damaged central directory");
+        }
+        const char* header = directory + offset;
+        if (get16(header + 8) & 1) {
+            throw runtime_error("'" + filename + "' is encrypted");
+        }
+        Entry entry;
+        entry.method = get16(header + 10);
+        entry.crc = get32(header + 16);
+        entry.compressedSize = get32(header + 20);
+        entry.uncompressedSize = get32(header + 24);
+        uint16_t nameLength = get16(header + 28);
+        uint16_t extraLength = get16(header + 30);
+        uint16_t commentLength = get16(header + 32);
+        entry.localHeaderOffset = get32(header + 42);
+        if (offset + CENTRAL_HEADER_SIZE + nameLength > directorySize) {
+            throw runtime_error("'" + filename + "' has a damaged central directory");
+        }
+        entries.emplace_back(string(header + CENTRAL_HEADER_SIZE, nameLength), entry);
+        offset += CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength;
+    }
+}
+
+const ZipReader::Entry& ZipReader::entry(const std::string& name) const {
+    for (const auto& candidate : entries) {
+        if (candidate.first == name) {
+            return candidate.second;
+        }
+    }
+    // Part names in OOXML packages are case-insensitive
+    for (const auto& candidate : entries) {
+        if (equalsIgnoreCase(candidate.first, name)) {
+            return candidate.second;
+        }
+    }
+    throw runtime_error("'" + filename + "' has no entry '" + name + "'");
+}
+
+bool ZipReader::contains(const std::string& name) const {
+    for (const auto& candidate : entries) {
+        if (equalsIgnoreCase(candidate.first, name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* ZipReader::entryData(const Entry& entry) const {
+    uint64_t offset = entry.localHeaderOffset;
+    if (offset + LOCAL_HEADER_SIZE > size || get32(data + offset) != LOCAL_HEADER_SIGNATURE) {
+        throw runtime_error("'" + filename + "' has a damaged local header");
+    }
+    offset += LOCAL_HEADER_SIZE + get16(data + offset + 26) + get16(data + offset + 28);
+    if (offset + entry.compressedSize > size) {
+        throw runtime_error("'" + filename + "' is truncated");
+    }
+    return data + offset;
+}
+
+std::unique_ptr<ZipReader::EntryReader> ZipReader::open(const std::string& name) const {
+    return unique_ptr<EntryReader>(new EntryReader(*this, name));
+}
+
+std::string ZipReader::readFile(const std::string& name) const {
+    auto reader = open(name);
+    string content;
+    content.resize(entry(name).uncompressedSize);
+    size_t filled = 0;
+    while (size_t got = reader->read(&content[filled], content.size() - filled)) {
+        filled += got;
+        if (filled == content.size()) {
+            // Confirms the end (and the CRC) of the entry
+            char probe;
+            if (reader->read(&probe, 1) != 0) {
+                throw runtime_error("'" + name + "' is longer than its directory entry");
+            }
+            break;
+        }
+    }
+    content.resize(filled);
+    return content;
+}
+
+// Compressed bytes are read straight out of the mapping; nothing is copied
+// on the way in
+struct ZipReader::EntryReader::Inflater {
+    Entry entry;
+    z_stream stream{};
+    bool initialized = false;
+    bool finished = false;
+    const char* input = nullptr;    // Next compressed byte in the mapping
+    uint64_t remaining = 0;         // Compressed bytes not yet consumed
+    uLong crc = crc32(0L, Z_NULL, 0);
+    uint64_t produced = 0;
+};
+
+ZipReader::EntryReader::EntryReader(const ZipReader& archive, const std::string& name)
+    : name(name), inflater(make_unique<Inflater>()) {
+    inflater->entry = archive.entry(name);
+    if (inflater->entry.method != METHOD_DEFLATE && inflater->entry.method != METHOD_STORED) {
+        throw runtime_error("'" + name + "' uses unsupported compression method " + to_string(inflater->entry.method));
+    }
+    inflater->input = archive.entryData(inflater->entry);
+    inflater->remaining = inflater->entry.compressedSize;
+    if (inflater->entry.method == METHOD_DEFLATE) {
+        if (inflateInit2(&inflater->stream, -MAX_WBITS) != Z_OK) {
+            throw runtime_error("inflateInit2 failed");
+        }
+        inflater->initialized = true;
+        inflater->stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(inflater->input));
+        inflater->stream.avail_in = static_cast<uInt>(inflater->remaining);
+    }
+}
+
+ZipReader::EntryReader::~EntryReader() {
+    if (inflater->initialized) {
+        inflateEnd(&inflater->stream);
+    }
+}
+
+size_t ZipReader::EntryReader::read(char* buffer, size_t size) {
+    Inflater& state = *inflater;
+    if (state.finished || size == 0) {
+        return 0;
+    }
+
+    size_t copied = 0;
+    if (state.entry.method == METHOD_STORED) {
+        copied = static_cast<size_t>(min<uint64_t>(size, state.remaining));
+        memcpy(buffer, state.input, copied);
+        state.input += copied;
+        state.remaining -= copied;
+        if (state.remaining == 0) {
+            state.finished = true;
+        }
+    } else {
+        // The whole compressed entry is already in avail_in
+        z_stream& stream = state.stream;
+        stream.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = static_cast<uInt>(min<size_t>(size, numeric_limits<uInt>::max()));
+        int status = inflate(&stream, Z_NO_FLUSH);
+        if (status == Z_STREAM_END) {
+            state.finished = true;
+        } else if (status == Z_BUF_ERROR) {
+            throw runtime_error("'" + name + "' is truncated");
+        } else if (status != Z_OK) {
+            throw runtime_error("'" + name + "' is corrupt (inflate " + to_string(status) + ")");
+        }
+        copied = size - stream.avail_out;
+    }
+
+    state.crc = crc32(state.crc, reinterpret_cast<const Bytef*>(buffer), static_cast<uInt>(copied));
+    state.produced += copied;
+    if (state.finished && (state.crc != state.entry.crc || state.produced != state.entry.uncompressedSize)) {
+        throw runtime_error("'" + name + "' failed its CRC check");
+    }
+    return copied;
+}